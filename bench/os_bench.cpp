@@ -0,0 +1,613 @@
+﻿// libos 容器微基准测试, 与同一次编译的 std:: 容器对比
+//   libos_bench [max_count] [container] [--csv]
+// max_count 默认 1e7, container 可选 slist/dlist/queue/deque/rbt
+#include "os_slist.h"
+#include "os_dlist.h"
+#include "os_queue.h"
+#include "os_deque.h"
+#include "os_rbt.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <forward_list>
+#include <list>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+const size_t OS_BENCH_MIN_OPS = 1000000;                 // 每项测试至少执行的操作数
+const size_t OS_BENCH_MAX_BYTES = (size_t)1 << 30;       // 单个容器负载上限, 超出则跳过
+const int OS_BENCH_MAX_OPS = 5;
+
+struct os_bench_row_t {
+    const char * op;
+    double ns;          // 每次操作耗时
+};
+
+struct os_bench_result_t {
+    os_bench_row_t rows[OS_BENCH_MAX_OPS];
+    int count;
+    double bytes;       // 每个元素占用的堆内存
+};
+
+volatile uint64_t g_sink = 0;
+bool g_csv = false;
+
+double os_bench_now()
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 当前进程已使用的堆内存, 无法统计时返回0
+size_t os_bench_heap_used()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#elif defined(__GLIBC__)
+    return (size_t)(unsigned)mallinfo().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// 自heap以来每个元素新增的堆内存
+double os_bench_heap_delta(size_t heap, size_t count)
+{
+    return ((double)os_bench_heap_used() - (double)heap) / (double)count;
+}
+
+uint32_t os_bench_rand(uint32_t & state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// N字节的元素, 前4字节为键
+template <size_t N>
+struct os_bench_elem_t {
+    unsigned char bytes[N];
+
+    explicit os_bench_elem_t(uint32_t key = 0)
+    {
+        std::memset(bytes, 0, N);
+        std::memcpy(bytes, &key, sizeof(key));
+    }
+
+    uint32_t key() const
+    {
+        uint32_t key;
+        std::memcpy(&key, bytes, sizeof(key));
+        return key;
+    }
+
+    bool operator<(const os_bench_elem_t & other) const
+    {
+        return key() < other.key();
+    }
+};
+
+inline uint32_t os_bench_key(const void * data)
+{
+    uint32_t key;
+    std::memcpy(&key, data, sizeof(key));
+    return key;
+}
+
+int os_bench_rbt_compare(const void * data1, const void * data2, size_t)
+{
+    uint32_t key1 = os_bench_key(data1);
+    uint32_t key2 = os_bench_key(data2);
+    return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
+}
+
+// 计时辅助: 累计多次start/stop之间的耗时
+class os_bench_timer_t {
+public:
+    os_bench_timer_t() : total_(0), start_(0) {}
+    void start() { start_ = os_bench_now(); }
+    void stop() { total_ += os_bench_now() - start_; }
+    double per_op(size_t ops) const { return total_ / (double)ops; }
+
+private:
+    double total_;
+    double start_;
+};
+
+void os_bench_add(os_bench_result_t & res, const char * op, double ns)
+{
+    res.rows[res.count].op = op;
+    res.rows[res.count].ns = ns;
+    res.count++;
+}
+
+// ---------------------------------------------------------------- slist
+template <size_t N>
+void os_bench_slist(size_t count, size_t reps, os_bench_result_t & os, os_bench_result_t & std_res)
+{
+    typedef os_bench_elem_t<N> elem_t;
+    os_bench_timer_t push, iter, pop, clear;
+
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        os_slist_t * lst = os_slist_create(N);
+        push.start();
+        for (size_t i = 0; i < count; i++) {
+            elem_t e((uint32_t)i);
+            os_slist_add(lst, &e);
+        }
+        push.stop();
+        if (0 == r)
+            os.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        iter.start();
+        for (os_slist_node_t * node = os_slist_head(lst); node; node = os_slist_next(node))
+            sum += os_bench_key(os_slist_getdata(node));
+        iter.stop();
+        g_sink += sum;
+
+        pop.start();
+        for (size_t i = 0; i < count / 2; i++)
+            os_slist_delete(lst, os_slist_head(lst));
+        pop.stop();
+
+        clear.start();
+        os_slist_clear(lst);
+        clear.stop();
+        os_slist_destroy(&lst);
+    }
+    os_bench_add(os, "push_back", push.per_op(count * reps));
+    os_bench_add(os, "iterate", iter.per_op(count * reps));
+    os_bench_add(os, "pop_front", pop.per_op(count / 2 * reps));
+    os_bench_add(os, "clear", clear.per_op((count - count / 2) * reps));
+
+    os_bench_timer_t spush, siter, spop, sclear;
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        std::forward_list<elem_t> * lst = new std::forward_list<elem_t>();
+        spush.start();
+        typename std::forward_list<elem_t>::iterator tail = lst->before_begin();
+        for (size_t i = 0; i < count; i++)
+            tail = lst->insert_after(tail, elem_t((uint32_t)i));
+        spush.stop();
+        if (0 == r)
+            std_res.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        siter.start();
+        for (typename std::forward_list<elem_t>::const_iterator it = lst->begin(); it != lst->end(); ++it)
+            sum += it->key();
+        siter.stop();
+        g_sink += sum;
+
+        spop.start();
+        for (size_t i = 0; i < count / 2; i++)
+            lst->pop_front();
+        spop.stop();
+
+        sclear.start();
+        lst->clear();
+        sclear.stop();
+        delete lst;
+    }
+    os_bench_add(std_res, "push_back", spush.per_op(count * reps));
+    os_bench_add(std_res, "iterate", siter.per_op(count * reps));
+    os_bench_add(std_res, "pop_front", spop.per_op(count / 2 * reps));
+    os_bench_add(std_res, "clear", sclear.per_op((count - count / 2) * reps));
+}
+
+// ---------------------------------------------------------------- dlist
+template <size_t N>
+void os_bench_dlist(size_t count, size_t reps, os_bench_result_t & os, os_bench_result_t & std_res)
+{
+    typedef os_bench_elem_t<N> elem_t;
+    os_bench_timer_t push, iter, pop, clear;
+
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        os_dlist_t * lst = os_dlist_create(N);
+        push.start();
+        for (size_t i = 0; i < count; i++) {
+            elem_t e((uint32_t)i);
+            os_dlist_add(lst, &e);
+        }
+        push.stop();
+        if (0 == r)
+            os.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        iter.start();
+        for (os_dlist_node_t * node = os_dlist_head(lst); node; node = os_dlist_next(node))
+            sum += os_bench_key(os_dlist_getdata(node));
+        iter.stop();
+        g_sink += sum;
+
+        pop.start();
+        for (size_t i = 0; i < count / 2; i++)
+            os_dlist_delete(lst, os_dlist_get_handle(os_dlist_head(lst)));
+        pop.stop();
+
+        clear.start();
+        os_dlist_clear(lst);
+        clear.stop();
+        os_dlist_destroy(&lst);
+    }
+    os_bench_add(os, "push_back", push.per_op(count * reps));
+    os_bench_add(os, "iterate", iter.per_op(count * reps));
+    os_bench_add(os, "pop_front", pop.per_op(count / 2 * reps));
+    os_bench_add(os, "clear", clear.per_op((count - count / 2) * reps));
+
+    os_bench_timer_t spush, siter, spop, sclear;
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        std::list<elem_t> * lst = new std::list<elem_t>();
+        spush.start();
+        for (size_t i = 0; i < count; i++)
+            lst->push_back(elem_t((uint32_t)i));
+        spush.stop();
+        if (0 == r)
+            std_res.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        siter.start();
+        for (typename std::list<elem_t>::const_iterator it = lst->begin(); it != lst->end(); ++it)
+            sum += it->key();
+        siter.stop();
+        g_sink += sum;
+
+        spop.start();
+        for (size_t i = 0; i < count / 2; i++)
+            lst->pop_front();
+        spop.stop();
+
+        sclear.start();
+        lst->clear();
+        sclear.stop();
+        delete lst;
+    }
+    os_bench_add(std_res, "push_back", spush.per_op(count * reps));
+    os_bench_add(std_res, "iterate", siter.per_op(count * reps));
+    os_bench_add(std_res, "pop_front", spop.per_op(count / 2 * reps));
+    os_bench_add(std_res, "clear", sclear.per_op((count - count / 2) * reps));
+}
+
+// ---------------------------------------------------------------- queue
+template <size_t N>
+void os_bench_queue(size_t count, size_t reps, os_bench_result_t & os, os_bench_result_t & std_res)
+{
+    typedef os_bench_elem_t<N> elem_t;
+    os_bench_timer_t push, pop, clear;
+
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        os_queue_t * q = os_queue_create(N);
+        push.start();
+        for (size_t i = 0; i < count; i++) {
+            elem_t e((uint32_t)i);
+            os_queue_push(q, &e);
+        }
+        push.stop();
+        if (0 == r)
+            os.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        pop.start();
+        for (size_t i = 0; i < count / 2; i++) {
+            sum += os_bench_key(os_queue_getdata(os_queue_front(q)));
+            os_queue_pop(q);
+        }
+        pop.stop();
+        g_sink += sum;
+
+        clear.start();
+        os_queue_clear(q);
+        clear.stop();
+        os_queue_destroy(&q);
+    }
+    os_bench_add(os, "push", push.per_op(count * reps));
+    os_bench_add(os, "front+pop", pop.per_op(count / 2 * reps));
+    os_bench_add(os, "clear", clear.per_op((count - count / 2) * reps));
+
+    os_bench_timer_t spush, spop, sclear;
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        std::queue<elem_t> * q = new std::queue<elem_t>();
+        spush.start();
+        for (size_t i = 0; i < count; i++)
+            q->push(elem_t((uint32_t)i));
+        spush.stop();
+        if (0 == r)
+            std_res.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        spop.start();
+        for (size_t i = 0; i < count / 2; i++) {
+            sum += q->front().key();
+            q->pop();
+        }
+        spop.stop();
+        g_sink += sum;
+
+        sclear.start();
+        delete q;
+        sclear.stop();
+    }
+    os_bench_add(std_res, "push", spush.per_op(count * reps));
+    os_bench_add(std_res, "front+pop", spop.per_op(count / 2 * reps));
+    os_bench_add(std_res, "clear", sclear.per_op((count - count / 2) * reps));
+}
+
+// ---------------------------------------------------------------- deque
+template <size_t N>
+void os_bench_deque(size_t count, size_t reps, os_bench_result_t & os, os_bench_result_t & std_res)
+{
+    typedef os_bench_elem_t<N> elem_t;
+    os_bench_timer_t push, iter, pop, clear;
+
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        os_deque_t * q = os_deque_create(N);
+        push.start();
+        for (size_t i = 0; i < count; i++) {
+            elem_t e((uint32_t)i);
+            if (i & 1)
+                os_deque_push_back(q, &e);
+            else
+                os_deque_push_front(q, &e);
+        }
+        push.stop();
+        if (0 == r)
+            os.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        iter.start();
+        for (size_t i = 0; i < count; i++)
+            sum += os_bench_key(os_deque_at(q, i));
+        iter.stop();
+        g_sink += sum;
+
+        pop.start();
+        for (size_t i = 0; i < count / 2; i++) {
+            if (i & 1)
+                os_deque_pop_back(q);
+            else
+                os_deque_pop_front(q);
+        }
+        pop.stop();
+
+        clear.start();
+        os_deque_clear(q);
+        clear.stop();
+        os_deque_destroy(&q);
+    }
+    os_bench_add(os, "push_both", push.per_op(count * reps));
+    os_bench_add(os, "at", iter.per_op(count * reps));
+    os_bench_add(os, "pop_both", pop.per_op(count / 2 * reps));
+    os_bench_add(os, "clear", clear.per_op((count - count / 2) * reps));
+
+    os_bench_timer_t spush, siter, spop, sclear;
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        std::deque<elem_t> * q = new std::deque<elem_t>();
+        spush.start();
+        for (size_t i = 0; i < count; i++) {
+            if (i & 1)
+                q->push_back(elem_t((uint32_t)i));
+            else
+                q->push_front(elem_t((uint32_t)i));
+        }
+        spush.stop();
+        if (0 == r)
+            std_res.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t sum = 0;
+        siter.start();
+        for (size_t i = 0; i < count; i++)
+            sum += (*q)[i].key();
+        siter.stop();
+        g_sink += sum;
+
+        spop.start();
+        for (size_t i = 0; i < count / 2; i++) {
+            if (i & 1)
+                q->pop_back();
+            else
+                q->pop_front();
+        }
+        spop.stop();
+
+        sclear.start();
+        q->clear();
+        sclear.stop();
+        delete q;
+    }
+    os_bench_add(std_res, "push_both", spush.per_op(count * reps));
+    os_bench_add(std_res, "at", siter.per_op(count * reps));
+    os_bench_add(std_res, "pop_both", spop.per_op(count / 2 * reps));
+    os_bench_add(std_res, "clear", sclear.per_op((count - count / 2) * reps));
+}
+
+// ---------------------------------------------------------------- rbt
+template <size_t N>
+void os_bench_rbt(size_t count, size_t reps, os_bench_result_t & os, os_bench_result_t & std_res)
+{
+    typedef os_bench_elem_t<N> elem_t;
+    std::vector<uint32_t> keys(count);
+    for (size_t i = 0; i < count; i++)
+        keys[i] = (uint32_t)i;
+    uint32_t state = 2463534242u;
+    for (size_t i = count - 1; i > 0; i--)
+        std::swap(keys[i], keys[os_bench_rand(state) % (i + 1)]);
+
+    os_bench_timer_t insert, find, erase, clear;
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        os_rbt_t * rbt = os_rbt_create(N, os_bench_rbt_compare);
+        insert.start();
+        for (size_t i = 0; i < count; i++) {
+            elem_t e(keys[i]);
+            os_rbt_insert(rbt, &e);
+        }
+        insert.stop();
+        if (0 == r)
+            os.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t hits = 0;
+        find.start();
+        for (size_t i = 0; i < count; i++) {
+            elem_t e((uint32_t)i);
+            hits += NULL != os_rbt_find(rbt, &e);
+        }
+        find.stop();
+        g_sink += hits;
+
+        erase.start();
+        for (size_t i = 0; i < count / 2; i++) {
+            elem_t e(keys[i]);
+            os_rbt_erase(rbt, &e);
+        }
+        erase.stop();
+
+        clear.start();
+        os_rbt_clear(rbt);
+        clear.stop();
+        os_rbt_destroy(&rbt);
+    }
+    os_bench_add(os, "insert", insert.per_op(count * reps));
+    os_bench_add(os, "find", find.per_op(count * reps));
+    os_bench_add(os, "erase", erase.per_op(count / 2 * reps));
+    os_bench_add(os, "clear", clear.per_op((count - count / 2) * reps));
+
+    os_bench_timer_t sinsert, sfind, serase, sclear;
+    for (size_t r = 0; r < reps; r++) {
+        size_t heap = os_bench_heap_used();
+        std::set<elem_t> * set = new std::set<elem_t>();
+        sinsert.start();
+        for (size_t i = 0; i < count; i++)
+            set->insert(elem_t(keys[i]));
+        sinsert.stop();
+        if (0 == r)
+            std_res.bytes = os_bench_heap_delta(heap, count);
+
+        uint64_t hits = 0;
+        sfind.start();
+        for (size_t i = 0; i < count; i++)
+            hits += set->find(elem_t((uint32_t)i)) != set->end();
+        sfind.stop();
+        g_sink += hits;
+
+        serase.start();
+        for (size_t i = 0; i < count / 2; i++)
+            set->erase(elem_t(keys[i]));
+        serase.stop();
+
+        sclear.start();
+        set->clear();
+        sclear.stop();
+        delete set;
+    }
+    os_bench_add(std_res, "insert", sinsert.per_op(count * reps));
+    os_bench_add(std_res, "find", sfind.per_op(count * reps));
+    os_bench_add(std_res, "erase", serase.per_op(count / 2 * reps));
+    os_bench_add(std_res, "clear", sclear.per_op((count - count / 2) * reps));
+}
+
+// ---------------------------------------------------------------- driver
+typedef void (*os_bench_func_t)(size_t, size_t, os_bench_result_t &, os_bench_result_t &);
+
+struct os_bench_case_t {
+    const char * name;
+    size_t node_overhead;   // 估算的每元素额外开销, 用于跳过超出内存上限的组合
+    os_bench_func_t funcs[4];
+};
+
+const size_t OS_BENCH_ELEM_SIZES[4] = { 4, 16, 64, 256 };
+
+const os_bench_case_t OS_BENCH_CASES[] = {
+    { "slist", 32, { os_bench_slist<4>, os_bench_slist<16>, os_bench_slist<64>, os_bench_slist<256> } },
+    { "dlist", 48, { os_bench_dlist<4>, os_bench_dlist<16>, os_bench_dlist<64>, os_bench_dlist<256> } },
+    { "queue", 32, { os_bench_queue<4>, os_bench_queue<16>, os_bench_queue<64>, os_bench_queue<256> } },
+    { "deque", 8, { os_bench_deque<4>, os_bench_deque<16>, os_bench_deque<64>, os_bench_deque<256> } },
+    { "rbt", 64, { os_bench_rbt<4>, os_bench_rbt<16>, os_bench_rbt<64>, os_bench_rbt<256> } },
+};
+
+void os_bench_print(const char * name, size_t elem_size, size_t count,
+                    const os_bench_result_t & os, const os_bench_result_t & std_res)
+{
+    for (int i = 0; i < os.count; i++) {
+        double ratio = std_res.rows[i].ns > 0 ? os.rows[i].ns / std_res.rows[i].ns : 0;
+        if (g_csv) {
+            printf("%s,%zu,%zu,%s,%.2f,%.2f,%.3f,%.1f,%.1f\n", name, elem_size, count, os.rows[i].op,
+                   os.rows[i].ns, std_res.rows[i].ns, ratio, os.bytes, std_res.bytes);
+        } else {
+            printf("%-6s %5zu %10zu %-10s %10.2f %10.2f %7.2fx %10.1f %10.1f\n", name, elem_size, count,
+                   os.rows[i].op, os.rows[i].ns, std_res.rows[i].ns, ratio, os.bytes, std_res.bytes);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    size_t max_count = 10000000;
+    std::string filter;
+    for (int i = 1; i < argc; i++) {
+        if (0 == std::strcmp(argv[i], "--csv"))
+            g_csv = true;
+        else if (argv[i][0] >= '0' && argv[i][0] <= '9')
+            max_count = (size_t)std::strtod(argv[i], NULL);
+        else
+            filter = argv[i];
+    }
+
+    if (max_count < 100) {
+        fprintf(stderr, "usage: %s [max_count >= 100] [slist|dlist|queue|deque|rbt] [--csv]\n", argv[0]);
+        return 1;
+    }
+
+    if (g_csv)
+        printf("container,elem_size,count,op,libos_ns,std_ns,ratio,libos_bytes,std_bytes\n");
+    else
+        printf("%-6s %5s %10s %-10s %10s %10s %8s %10s %10s\n", "type", "elem", "count", "op",
+               "libos ns", "std ns", "ratio", "libos B/e", "std B/e");
+
+    for (size_t c = 0; c < sizeof(OS_BENCH_CASES) / sizeof(OS_BENCH_CASES[0]); c++) {
+        const os_bench_case_t & bc = OS_BENCH_CASES[c];
+        if (!filter.empty() && filter != bc.name)
+            continue;
+
+        for (int s = 0; s < 4; s++) {
+            for (size_t count = 100; count <= max_count; count *= 10) {
+                size_t elem_size = OS_BENCH_ELEM_SIZES[s];
+                if (count * (elem_size + bc.node_overhead) > OS_BENCH_MAX_BYTES) {
+                    if (!g_csv)
+                        printf("%-6s %5zu %10zu skipped (exceeds memory budget)\n", bc.name, elem_size, count);
+                    continue;
+                }
+
+                size_t reps = count >= OS_BENCH_MIN_OPS ? 1 : OS_BENCH_MIN_OPS / count;
+                os_bench_result_t os_res, std_res;
+                std::memset(&os_res, 0, sizeof(os_res));
+                std::memset(&std_res, 0, sizeof(std_res));
+                bc.funcs[s](count, reps, os_res, std_res);
+                os_bench_print(bc.name, elem_size, count, os_res, std_res);
+            }
+        }
+    }
+
+    return 0;
+}
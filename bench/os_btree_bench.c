@@ -0,0 +1,198 @@
+﻿#include "os_btree.h"
+#include "os_rbt.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#define OS_BENCH_FINDS 1000000u
+
+typedef struct _os_bench_tree_t {
+    const char * name;
+    void * (*create)(void);
+    void (*destroy)(void * tree);
+    void (*insert)(void * tree, const uint64_t * key);
+    bool (*find)(const void * tree, const uint64_t * key);
+    uint64_t (*scan)(const void * tree);
+} os_bench_tree_t;
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t os_bench_rand(uint64_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// 进程常驻内存, 没有/proc时返回0
+static size_t os_bench_rss(void)
+{
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    size_t pages = 0u;
+    FILE * fp = fopen("/proc/self/statm", "r");
+    if (NULL == fp)
+        return 0u;
+    if (1 != fscanf(fp, "%*s %zu", &pages))
+        pages = 0u;
+    fclose(fp);
+    return pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static int os_bench_compare(const void * data1, const void * data2, size_t size)
+{
+    uint64_t key1 = *(const uint64_t *)data1;
+    uint64_t key2 = *(const uint64_t *)data2;
+    return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
+}
+
+static int os_bench_sum(const void * data, void * ctx)
+{
+    *(uint64_t *)ctx += *(const uint64_t *)data;
+    return 0;
+}
+
+static void * os_bench_rbt_create(void)
+{
+    return os_rbt_create(sizeof(uint64_t), os_bench_compare);
+}
+
+static void os_bench_rbt_destroy(void * tree)
+{
+    os_rbt_destroy((os_rbt_t **)&tree);
+}
+
+static void os_bench_rbt_insert(void * tree, const uint64_t * key)
+{
+    os_rbt_insert((os_rbt_t *)tree, (void *)key);
+}
+
+static bool os_bench_rbt_find(const void * tree, const uint64_t * key)
+{
+    return NULL != os_rbt_find((const os_rbt_t *)tree, key);
+}
+
+static uint64_t os_bench_rbt_scan(const void * tree)
+{
+    uint64_t sum = 0u;
+    os_rbt_foreach((const os_rbt_t *)tree, os_bench_sum, &sum);
+    return sum;
+}
+
+static void * os_bench_btree_create(void)
+{
+    return os_btree_create(sizeof(uint64_t), os_bench_compare);
+}
+
+static void os_bench_btree_destroy(void * tree)
+{
+    os_btree_destroy((os_btree_t **)&tree);
+}
+
+static void os_bench_btree_insert(void * tree, const uint64_t * key)
+{
+    os_btree_insert((os_btree_t *)tree, key);
+}
+
+static bool os_bench_btree_find(const void * tree, const uint64_t * key)
+{
+    return NULL != os_btree_find((const os_btree_t *)tree, key);
+}
+
+static uint64_t os_bench_btree_scan(const void * tree)
+{
+    uint64_t sum = 0u;
+    os_btree_foreach((const os_btree_t *)tree, os_bench_sum, &sum);
+    return sum;
+}
+
+static const os_bench_tree_t os_bench_trees[] = {
+    { "rbt", os_bench_rbt_create, os_bench_rbt_destroy, os_bench_rbt_insert, os_bench_rbt_find, os_bench_rbt_scan },
+    { "btree", os_bench_btree_create, os_bench_btree_destroy, os_bench_btree_insert, os_bench_btree_find, os_bench_btree_scan },
+};
+
+// 随机顺序插入count个键, 然后随机查找和顺序遍历, 输出每次操作的耗时和每个键占用的内存
+static void os_bench_run(const os_bench_tree_t * bench, const uint64_t * keys, size_t count)
+{
+    size_t rss = os_bench_rss();
+    void * tree = bench->create();
+    if (NULL == tree) {
+        fprintf(stderr, "%s create failed\n", bench->name);
+        return;
+    }
+
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i++)
+        bench->insert(tree, &keys[i]);
+    double insert_ns = (os_bench_now() - start) * 1e9 / (double)count;
+    double bytes = (double)(os_bench_rss() - rss) / (double)count;
+
+    uint64_t state = 88172645463325252ull;
+    size_t found = 0u;
+    start = os_bench_now();
+    for (size_t i = 0; i < OS_BENCH_FINDS; i++) {
+        uint64_t key = os_bench_rand(&state) % count;
+        if (bench->find(tree, &key))
+            found++;
+    }
+    double find_ns = (os_bench_now() - start) * 1e9 / (double)OS_BENCH_FINDS;
+
+    start = os_bench_now();
+    uint64_t sum = bench->scan(tree);
+    double scan_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    bench->destroy(tree);
+
+    printf("%-6s %10zu %12.1f %12.1f %12.2f %12.1f %s\n", bench->name, count, insert_ns, find_ns, scan_ns, bytes,
+           found == OS_BENCH_FINDS && sum == (uint64_t)count * (count - 1u) / 2u ? "" : "MISMATCH");
+}
+
+int main(int argc, char * argv[])
+{
+    static const size_t counts[] = { 1000000u, 5000000u, 10000000u, 20000000u, 50000000u };
+
+    size_t max_count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 50000000u;
+    if (max_count < counts[0]) {
+        fprintf(stderr, "usage: %s [max_count >= %zu]\n", argv[0], counts[0]);
+        return 1;
+    }
+
+    uint64_t * keys = (uint64_t *)malloc(max_count * sizeof(uint64_t));
+    if (NULL == keys) {
+        fprintf(stderr, "malloc failed\n");
+        return 1;
+    }
+
+    printf("%-6s %10s %12s %12s %12s %12s\n", "tree", "keys", "insert ns", "find ns", "scan ns", "bytes/key");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]) && counts[c] <= max_count; c++) {
+        size_t count = counts[c];
+        uint64_t state = 2463534242ull;
+        for (size_t i = 0; i < count; i++)
+            keys[i] = i;
+        for (size_t i = count - 1; i > 0; i--) {
+            size_t j = (size_t)(os_bench_rand(&state) % (i + 1));
+            uint64_t tmp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = tmp;
+        }
+
+        for (size_t t = 0; t < sizeof(os_bench_trees) / sizeof(os_bench_trees[0]); t++)
+            os_bench_run(&os_bench_trees[t], keys, count);
+    }
+
+    free(keys);
+
+    return 0;
+}
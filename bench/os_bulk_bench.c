@@ -0,0 +1,135 @@
+﻿#include "os_slist.h"
+#include "os_dlist.h"
+#include "os_queue.h"
+#include "os_deque.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define OS_BENCH_ELEM_SIZE  32u   // 元素大小
+#define OS_BENCH_BATCH      10000u // 每批元素个数
+#define OS_BENCH_REPS       5     // 重复次数, 取最快的一次
+
+typedef struct _os_bench_elem_t {
+    uint32_t key;
+    char payload[OS_BENCH_ELEM_SIZE - sizeof(uint32_t)];
+} os_bench_elem_t;
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 逐个插入与批量插入分别载入count个元素, 返回每个元素的耗时(ns)
+static double os_bench_slist(const os_bench_elem_t * data, size_t count, bool batch)
+{
+    os_slist_t * lst = os_slist_create(sizeof(os_bench_elem_t));
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i += OS_BENCH_BATCH) {
+        if (batch) {
+            os_slist_add_n(lst, data, OS_BENCH_BATCH);
+        } else {
+            for (size_t j = 0; j < OS_BENCH_BATCH; j++)
+                os_slist_add(lst, (void *)&data[j]);
+        }
+    }
+    double ns = (os_bench_now() - start) * 1e9 / (double)count;
+    os_slist_destroy(&lst);
+    return ns;
+}
+
+static double os_bench_dlist(const os_bench_elem_t * data, size_t count, bool batch)
+{
+    os_dlist_t * lst = os_dlist_create(sizeof(os_bench_elem_t));
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i += OS_BENCH_BATCH) {
+        if (batch) {
+            os_dlist_add_n(lst, data, OS_BENCH_BATCH);
+        } else {
+            for (size_t j = 0; j < OS_BENCH_BATCH; j++)
+                os_dlist_add(lst, (void *)&data[j]);
+        }
+    }
+    double ns = (os_bench_now() - start) * 1e9 / (double)count;
+    os_dlist_destroy(&lst);
+    return ns;
+}
+
+static double os_bench_queue(const os_bench_elem_t * data, size_t count, bool batch)
+{
+    os_queue_t * q = os_queue_create(sizeof(os_bench_elem_t));
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i += OS_BENCH_BATCH) {
+        if (batch) {
+            os_queue_push_n(q, data, OS_BENCH_BATCH);
+        } else {
+            for (size_t j = 0; j < OS_BENCH_BATCH; j++)
+                os_queue_push(q, (void *)&data[j]);
+        }
+    }
+    double ns = (os_bench_now() - start) * 1e9 / (double)count;
+    os_queue_destroy(&q);
+    return ns;
+}
+
+static double os_bench_deque(const os_bench_elem_t * data, size_t count, bool batch)
+{
+    os_deque_t * q = os_deque_create(sizeof(os_bench_elem_t));
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i += OS_BENCH_BATCH) {
+        if (batch) {
+            os_deque_push_back_n(q, data, OS_BENCH_BATCH);
+        } else {
+            for (size_t j = 0; j < OS_BENCH_BATCH; j++)
+                os_deque_push_back(q, (void *)&data[j]);
+        }
+    }
+    double ns = (os_bench_now() - start) * 1e9 / (double)count;
+    os_deque_destroy(&q);
+    return ns;
+}
+
+static void os_bench_run(const char * name, double (*run)(const os_bench_elem_t *, size_t, bool),
+                         const os_bench_elem_t * data, size_t count)
+{
+    double loop = 0.0;
+    double batch = 0.0;
+    for (int r = 0; r < OS_BENCH_REPS; r++) {
+        double ns = run(data, count, false);
+        if (0 == r || ns < loop)
+            loop = ns;
+        ns = run(data, count, true);
+        if (0 == r || ns < batch)
+            batch = ns;
+    }
+
+    printf("%-8s %10zu %12.2f %12.2f %9.2fx\n", name, count, loop, batch, loop / batch);
+}
+
+int main(int argc, char * argv[])
+{
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000u;
+    count = (count + OS_BENCH_BATCH - 1) / OS_BENCH_BATCH * OS_BENCH_BATCH;
+
+    os_bench_elem_t * data = (os_bench_elem_t *)calloc(OS_BENCH_BATCH, sizeof(os_bench_elem_t));
+    if (NULL == data) {
+        fprintf(stderr, "calloc failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < OS_BENCH_BATCH; i++)
+        data[i].key = (uint32_t)i;
+
+    printf("%-8s %10s %12s %12s %10s\n", "type", "elems", "loop ns", "batch ns", "speedup");
+    os_bench_run("slist", os_bench_slist, data, count);
+    os_bench_run("dlist", os_bench_dlist, data, count);
+    os_bench_run("queue", os_bench_queue, data, count);
+    os_bench_run("deque", os_bench_deque, data, count);
+
+    free(data);
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+﻿#include "os_mpmc_queue.h"
+#include "os_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define OS_BENCH_BATCH     32
+#define OS_BENCH_CAPACITY  4096
+
+typedef enum _OS_BENCH_MODE
+{
+    OS_BENCH_MPMC,          // os_mpmc_queue 单个读写
+    OS_BENCH_MPMC_BATCH,    // os_mpmc_queue 批量读写
+    OS_BENCH_LOCKED_QUEUE   // 全局锁 + os_queue
+} OS_BENCH_MODE;
+
+typedef struct _os_bench_ctx_t {
+    OS_BENCH_MODE mode;
+    os_mpmc_queue_t * mpmc;
+    os_queue_t * queue;
+    pthread_mutex_t lock;
+    size_t per_producer;        // 每个生产者写入的元素个数
+    size_t total;               // 元素总数
+    atomic_size_t consumed;     // 已消费的元素个数
+    atomic_ullong checksum;     // 消费到的元素之和
+} os_bench_ctx_t;
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool os_bench_locked_push(os_bench_ctx_t * ctx, uint64_t * data)
+{
+    pthread_mutex_lock(&ctx->lock);
+    bool ok = os_queue_size(ctx->queue) < OS_BENCH_CAPACITY && os_queue_push(ctx->queue, data);
+    pthread_mutex_unlock(&ctx->lock);
+    return ok;
+}
+
+static bool os_bench_locked_pop(os_bench_ctx_t * ctx, uint64_t * data)
+{
+    bool ok = false;
+    pthread_mutex_lock(&ctx->lock);
+    os_queue_node_t * node = os_queue_front(ctx->queue);
+    if (NULL != node) {
+        memcpy(data, os_queue_getdata(node), sizeof(uint64_t));
+        os_queue_pop(ctx->queue);
+        ok = true;
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    return ok;
+}
+
+static void * os_bench_producer(void * arg)
+{
+    os_bench_ctx_t * ctx = (os_bench_ctx_t *)arg;
+    uint64_t batch[OS_BENCH_BATCH];
+    size_t sent = 0u;
+    while (sent < ctx->per_producer) {
+        size_t n = 1u;
+        bool ok = false;
+        switch (ctx->mode) {
+        case OS_BENCH_MPMC:
+            batch[0] = 1u;
+            ok = os_mpmc_queue_push(ctx->mpmc, batch);
+            break;
+        case OS_BENCH_MPMC_BATCH:
+            n = ctx->per_producer - sent < OS_BENCH_BATCH ? ctx->per_producer - sent : OS_BENCH_BATCH;
+            for (size_t i = 0; i < n; i++)
+                batch[i] = 1u;
+            n = os_mpmc_queue_push_n(ctx->mpmc, batch, n);
+            ok = n > 0u;
+            break;
+        case OS_BENCH_LOCKED_QUEUE:
+            batch[0] = 1u;
+            ok = os_bench_locked_push(ctx, batch);
+            break;
+        }
+        if (ok)
+            sent += n;
+        else
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+static void * os_bench_consumer(void * arg)
+{
+    os_bench_ctx_t * ctx = (os_bench_ctx_t *)arg;
+    uint64_t batch[OS_BENCH_BATCH];
+    unsigned long long sum = 0u;
+    while (atomic_load_explicit(&ctx->consumed, memory_order_relaxed) < ctx->total) {
+        size_t n = 0u;
+        switch (ctx->mode) {
+        case OS_BENCH_MPMC:
+            n = os_mpmc_queue_pop(ctx->mpmc, batch) ? 1u : 0u;
+            break;
+        case OS_BENCH_MPMC_BATCH:
+            n = os_mpmc_queue_pop_n(ctx->mpmc, batch, OS_BENCH_BATCH);
+            break;
+        case OS_BENCH_LOCKED_QUEUE:
+            n = os_bench_locked_pop(ctx, batch) ? 1u : 0u;
+            break;
+        }
+        if (0u == n) {
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < n; i++)
+            sum += batch[i];
+        atomic_fetch_add_explicit(&ctx->consumed, n, memory_order_relaxed);
+    }
+    atomic_fetch_add(&ctx->checksum, sum);
+
+    return NULL;
+}
+
+static double os_bench_run(OS_BENCH_MODE mode, int threads, size_t total)
+{
+    os_bench_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.per_producer = total / (size_t)threads;
+    ctx.total = ctx.per_producer * (size_t)threads;
+    atomic_init(&ctx.consumed, 0u);
+    atomic_init(&ctx.checksum, 0u);
+    ctx.mpmc = os_mpmc_queue_create(sizeof(uint64_t), OS_BENCH_CAPACITY);
+    ctx.queue = os_queue_create(sizeof(uint64_t));
+    pthread_mutex_init(&ctx.lock, NULL);
+
+    pthread_t * tids = (pthread_t *)calloc((size_t)threads * 2, sizeof(pthread_t));
+    double start = os_bench_now();
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&tids[i * 2], NULL, os_bench_producer, &ctx);
+        pthread_create(&tids[i * 2 + 1], NULL, os_bench_consumer, &ctx);
+    }
+    for (int i = 0; i < threads * 2; i++)
+        pthread_join(tids[i], NULL);
+    double elapsed = os_bench_now() - start;
+
+    if (atomic_load(&ctx.checksum) != ctx.total)
+        fprintf(stderr, "checksum mismatch: %llu != %zu\n", atomic_load(&ctx.checksum), ctx.total);
+
+    free(tids);
+    pthread_mutex_destroy(&ctx.lock);
+    os_queue_destroy(&ctx.queue);
+    os_mpmc_queue_destroy(&ctx.mpmc);
+
+    return (double)ctx.total / elapsed / 1e6;
+}
+
+int main(int argc, char * argv[])
+{
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    size_t total = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 4000000u;
+    if (max_threads <= 0 || 0u == total) {
+        fprintf(stderr, "usage: %s [max_threads] [total_items]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-12s %14s %14s %14s\n", "threads", "mpmc Mops/s", "batch Mops/s", "locked Mops/s");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        double mpmc = os_bench_run(OS_BENCH_MPMC, t, total);
+        double batch = os_bench_run(OS_BENCH_MPMC_BATCH, t, total);
+        double locked = os_bench_run(OS_BENCH_LOCKED_QUEUE, t, total);
+        char label[32];
+        snprintf(label, sizeof(label), "%dP/%dC", t, t);
+        printf("%-12s %14.2f %14.2f %14.2f\n", label, mpmc, batch, locked);
+    }
+
+    return 0;
+}
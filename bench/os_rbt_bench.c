@@ -0,0 +1,103 @@
+﻿#include "os_rbt.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define OS_BENCH_FINDS 1000000u
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t os_bench_rand(uint64_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int os_bench_compare(const void * data1, const void * data2, size_t size)
+{
+    uint64_t key1 = *(const uint64_t *)data1;
+    uint64_t key2 = *(const uint64_t *)data2;
+    return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
+}
+
+// 插入count个键(build为true时用os_rbt_build_sorted一次构建), 然后随机查找, 输出每次操作的耗时
+static void os_bench_run(const char * name, uint64_t * keys, size_t count, bool build)
+{
+    os_rbt_t * rbt = os_rbt_create(sizeof(uint64_t), os_bench_compare);
+    if (NULL == rbt) {
+        fprintf(stderr, "os_rbt_create failed\n");
+        return;
+    }
+
+    double start = os_bench_now();
+    if (build) {
+        if (!os_rbt_build_sorted(rbt, keys, count))
+            fprintf(stderr, "os_rbt_build_sorted failed\n");
+    } else {
+        for (size_t i = 0; i < count; i++)
+            os_rbt_insert(rbt, &keys[i]);
+    }
+    double insert_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    uint64_t state = 88172645463325252ull;
+    size_t found = 0u;
+    start = os_bench_now();
+    for (size_t i = 0; i < OS_BENCH_FINDS; i++) {
+        uint64_t key = os_bench_rand(&state) % count;
+        if (NULL != os_rbt_find(rbt, &key))
+            found++;
+    }
+    double find_ns = (os_bench_now() - start) * 1e9 / (double)OS_BENCH_FINDS;
+
+    start = os_bench_now();
+    os_rbt_destroy(&rbt);
+    double clear_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    printf("%-8s %10zu %12.1f %12.1f %14.2f %12.1f %s\n", name, count, insert_ns, find_ns,
+           find_ns / log2((double)count), clear_ns, found == OS_BENCH_FINDS ? "" : "MISSING");
+}
+
+int main(int argc, char * argv[])
+{
+    size_t max_count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 10000000u;
+    if (max_count < 1000u) {
+        fprintf(stderr, "usage: %s [max_count >= 1000]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t * keys = (uint64_t *)malloc(max_count * sizeof(uint64_t));
+    if (NULL == keys) {
+        fprintf(stderr, "malloc failed\n");
+        return 1;
+    }
+
+    printf("%-8s %10s %12s %12s %14s %12s\n", "order", "keys", "insert ns", "find ns", "find/log2(n)", "clear ns");
+    for (size_t count = 1000u; count <= max_count; count *= 10) {
+        for (size_t i = 0; i < count; i++)
+            keys[i] = i;
+        os_bench_run("sorted", keys, count, false);
+        os_bench_run("build", keys, count, true);
+
+        uint64_t state = 2463534242ull;
+        for (size_t i = count - 1; i > 0; i--) {
+            size_t j = (size_t)(os_bench_rand(&state) % (i + 1));
+            uint64_t tmp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = tmp;
+        }
+        os_bench_run("random", keys, count, false);
+    }
+
+    free(keys);
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+﻿#include "os_rbt.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define OS_BENCH_KEYS          (1u << 20)
+#define OS_BENCH_WRITE_PERIOD  1000u    // 每1000次查找对应一次修改
+#define OS_BENCH_MAX_THREADS   64
+
+typedef enum _OS_BENCH_MODE
+{
+    OS_BENCH_CONCURRENT,    // os_rbt_create_concurrent
+    OS_BENCH_RWLOCK         // 读写锁 + os_rbt
+} OS_BENCH_MODE;
+
+typedef struct _os_bench_ctx_t os_bench_ctx_t;
+
+// 每个读者的计数独占一个缓存行, 避免计数本身成为共享写入点
+typedef struct _os_bench_reader_t {
+    os_bench_ctx_t * ctx;
+    uint64_t seed;
+    atomic_size_t reads;        // 完成的查找次数
+    size_t found;               // 命中次数
+    char pad[OS_CACHE_LINE_SIZE];
+} os_bench_reader_t;
+
+struct _os_bench_ctx_t {
+    OS_BENCH_MODE mode;
+    os_rbt_t * rbt;
+    pthread_rwlock_t lock;
+    atomic_bool stop;           // 停止标志, 由主线程计时后设置
+    int threads;                // 读者个数
+    os_bench_reader_t * readers;
+    size_t writes;              // 写者完成的修改次数
+};
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t os_bench_rand(uint64_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int os_bench_compare(const void * data1, const void * data2, size_t size)
+{
+    uint64_t key1 = *(const uint64_t *)data1;
+    uint64_t key2 = *(const uint64_t *)data2;
+    return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
+}
+
+static bool os_bench_find(os_bench_ctx_t * ctx, uint64_t key)
+{
+    uint64_t out = 0u;
+    if (OS_BENCH_CONCURRENT == ctx->mode)
+        return os_rbt_find_copy(ctx->rbt, &key, &out);
+
+    pthread_rwlock_rdlock(&ctx->lock);
+    bool ok = os_rbt_find_copy(ctx->rbt, &key, &out);
+    pthread_rwlock_unlock(&ctx->lock);
+    return ok;
+}
+
+static void * os_bench_reader(void * arg)
+{
+    os_bench_reader_t * reader = (os_bench_reader_t *)arg;
+    os_bench_ctx_t * ctx = reader->ctx;
+    size_t reads = 0u;
+    while (!atomic_load_explicit(&ctx->stop, memory_order_relaxed)) {
+        // 键空间为偶数键的两倍, 约一半查找命中
+        for (int i = 0; i < 256; i++) {
+            if (os_bench_find(ctx, os_bench_rand(&reader->seed) % (OS_BENCH_KEYS * 2u)))
+                reader->found++;
+        }
+        reads += 256u;
+        atomic_store_explicit(&reader->reads, reads, memory_order_relaxed);
+    }
+
+    return NULL;
+}
+
+static size_t os_bench_reads(const os_bench_ctx_t * ctx)
+{
+    size_t reads = 0u;
+    for (int i = 0; i < ctx->threads; i++)
+        reads += atomic_load_explicit(&ctx->readers[i].reads, memory_order_relaxed);
+    return reads;
+}
+
+// 写者按读者的进度删除并重新插入随机键, 使修改次数约为查找次数的1/OS_BENCH_WRITE_PERIOD
+static void * os_bench_writer(void * arg)
+{
+    os_bench_ctx_t * ctx = (os_bench_ctx_t *)arg;
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    struct timespec pause = { 0, 20000 };
+    while (!atomic_load_explicit(&ctx->stop, memory_order_relaxed)) {
+        uint64_t key = os_bench_rand(&state) % OS_BENCH_KEYS * 2u;
+        if (OS_BENCH_RWLOCK == ctx->mode)
+            pthread_rwlock_wrlock(&ctx->lock);
+        os_rbt_erase(ctx->rbt, &key);
+        os_rbt_insert(ctx->rbt, &key);
+        if (OS_BENCH_RWLOCK == ctx->mode)
+            pthread_rwlock_unlock(&ctx->lock);
+        ctx->writes += 2u;
+
+        // 查找进度不足时等待
+        while (!atomic_load_explicit(&ctx->stop, memory_order_relaxed) && ctx->writes * OS_BENCH_WRITE_PERIOD > os_bench_reads(ctx))
+            nanosleep(&pause, NULL);
+    }
+
+    return NULL;
+}
+
+static double os_bench_run(OS_BENCH_MODE mode, int threads, const uint64_t * keys, double seconds, double * hit_ratio)
+{
+    static os_bench_reader_t readers[OS_BENCH_MAX_THREADS];
+    os_bench_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.threads = threads;
+    ctx.readers = readers;
+    atomic_init(&ctx.stop, false);
+    pthread_rwlock_init(&ctx.lock, NULL);
+    ctx.rbt = OS_BENCH_CONCURRENT == mode ? os_rbt_create_concurrent(sizeof(uint64_t), os_bench_compare)
+                                          : os_rbt_create(sizeof(uint64_t), os_bench_compare);
+    if (NULL == ctx.rbt || !os_rbt_build_sorted(ctx.rbt, keys, OS_BENCH_KEYS)) {
+        fprintf(stderr, "build tree failed\n");
+        exit(1);
+    }
+
+    pthread_t tids[OS_BENCH_MAX_THREADS + 1];
+    for (int i = 0; i < threads; i++) {
+        readers[i].ctx = &ctx;
+        readers[i].seed = 88172645463325252ull + (uint64_t)i * 0x9e3779b97f4a7c15ull;
+        atomic_init(&readers[i].reads, 0u);
+        readers[i].found = 0u;
+    }
+    double start = os_bench_now();
+    for (int i = 0; i < threads; i++)
+        pthread_create(&tids[i], NULL, os_bench_reader, &readers[i]);
+    pthread_create(&tids[threads], NULL, os_bench_writer, &ctx);
+
+    struct timespec duration = { (time_t)seconds, (long)((seconds - (double)(time_t)seconds) * 1e9) };
+    nanosleep(&duration, NULL);
+    atomic_store(&ctx.stop, true);
+    for (int i = 0; i <= threads; i++)
+        pthread_join(tids[i], NULL);
+    double elapsed = os_bench_now() - start;
+
+    size_t reads = os_bench_reads(&ctx);
+    size_t found = 0u;
+    for (int i = 0; i < threads; i++)
+        found += readers[i].found;
+    *hit_ratio = 0u == reads ? 0.0 : (double)found / (double)reads;
+
+    os_rbt_destroy(&ctx.rbt);
+    pthread_rwlock_destroy(&ctx.lock);
+
+    return (double)reads / elapsed / 1e6;
+}
+
+int main(int argc, char * argv[])
+{
+    int max_threads = argc > 1 ? atoi(argv[1]) : OS_BENCH_MAX_THREADS;
+    double seconds = argc > 2 ? atof(argv[2]) : 0.5;
+    if (max_threads <= 0 || max_threads > OS_BENCH_MAX_THREADS || seconds <= 0.0) {
+        fprintf(stderr, "usage: %s [max_threads(1-%d)] [seconds]\n", argv[0], OS_BENCH_MAX_THREADS);
+        return 1;
+    }
+
+    uint64_t * keys = (uint64_t *)malloc(OS_BENCH_KEYS * sizeof(uint64_t));
+    if (NULL == keys)
+        return 1;
+    for (size_t i = 0; i < OS_BENCH_KEYS; i++)
+        keys[i] = (uint64_t)i * 2u;
+
+    printf("%u keys, 1 writer, %u reads per write\n", OS_BENCH_KEYS, OS_BENCH_WRITE_PERIOD);
+    printf("%-10s %18s %18s %10s\n", "readers", "concurrent Mops/s", "rwlock Mops/s", "hit");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        double hit = 0.0;
+        double concurrent = os_bench_run(OS_BENCH_CONCURRENT, t, keys, seconds, &hit);
+        double rwlock = os_bench_run(OS_BENCH_RWLOCK, t, keys, seconds, &hit);
+        printf("%-10d %18.2f %18.2f %9.1f%%\n", t, concurrent, rwlock, hit * 100.0);
+    }
+
+    free(keys);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+﻿#include "os_seq.h"
+#include "os_dlist.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define OS_BENCH_DLIST_MAX  100000u  // 链表按位置插入为O(n), 超过该规模不再测试
+#define OS_BENCH_LOOKUPS    1000000u // 随机访问次数
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t os_bench_rand(uint64_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// 随机位置插入count个元素, 然后顺序遍历和随机访问, 输出每次操作的耗时
+static void os_bench_seq(size_t count)
+{
+    os_seq_t * seq = os_seq_create(sizeof(uint64_t));
+    uint64_t state = 88172645463325252ull;
+
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = i;
+        os_seq_insert(seq, (size_t)(os_bench_rand(&state) % (i + 1)), &value);
+    }
+    double insert_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    uint64_t sum = 0u;
+    start = os_bench_now();
+    for (os_seq_cursor_t cur = os_seq_cursor(seq, 0); os_seq_cursor_valid(&cur); os_seq_cursor_next(&cur))
+        sum += *(uint64_t *)os_seq_cursor_get(&cur);
+    double iter_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    start = os_bench_now();
+    for (size_t i = 0; i < OS_BENCH_LOOKUPS; i++)
+        sum += *(uint64_t *)os_seq_at(seq, (size_t)(os_bench_rand(&state) % count));
+    double at_ns = (os_bench_now() - start) * 1e9 / (double)OS_BENCH_LOOKUPS;
+
+    start = os_bench_now();
+    for (size_t i = count; i > 0; i--)
+        os_seq_erase(seq, (size_t)(os_bench_rand(&state) % i));
+    double erase_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    printf("%-6s %10zu %12.1f %12.2f %12.1f %12.1f %s\n", "seq", count, insert_ns, iter_ns, at_ns, erase_ns,
+           0u == sum ? "EMPTY" : "");
+    os_seq_destroy(&seq);
+}
+
+static void os_bench_dlist(size_t count)
+{
+    os_dlist_t * lst = os_dlist_create(sizeof(uint64_t));
+    uint64_t state = 88172645463325252ull;
+
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = i;
+        os_dlist_insert(lst, (size_t)(os_bench_rand(&state) % (i + 1)), &value);
+    }
+    double insert_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    uint64_t sum = 0u;
+    start = os_bench_now();
+    for (os_dlist_node_t * node = os_dlist_head(lst); NULL != node; node = os_dlist_next(node))
+        sum += *(uint64_t *)os_dlist_getdata(node);
+    double iter_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    printf("%-6s %10zu %12.1f %12.2f %12s %12s %s\n", "dlist", count, insert_ns, iter_ns, "-", "-",
+           0u == sum ? "EMPTY" : "");
+    os_dlist_destroy(&lst);
+}
+
+int main(int argc, char * argv[])
+{
+    size_t max_count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000u;
+    if (max_count < 1000u) {
+        fprintf(stderr, "usage: %s [max_count >= 1000]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-6s %10s %12s %12s %12s %12s\n", "type", "elems", "insert ns", "iterate ns", "at ns", "erase ns");
+    for (size_t count = 1000u; count <= max_count; count *= 10) {
+        os_bench_seq(count);
+        if (count <= OS_BENCH_DLIST_MAX)
+            os_bench_dlist(count);
+    }
+
+    return 0;
+}
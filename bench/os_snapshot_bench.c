@@ -0,0 +1,129 @@
+﻿#include "os_rbt.h"
+#include "os_dlist.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define OS_BENCH_FINDS 1000000u
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t os_bench_rand(uint64_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int os_bench_compare(const void * data1, const void * data2, size_t size)
+{
+    uint64_t key1 = *(const uint64_t *)data1;
+    uint64_t key2 = *(const uint64_t *)data2;
+    return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
+}
+
+// 逐个插入重建与映射快照的启动耗时对比, 以及两者的随机查找耗时
+static void os_bench_rbt(size_t count, const char * path)
+{
+    double start = os_bench_now();
+    os_rbt_t * rbt = os_rbt_create(sizeof(uint64_t), os_bench_compare);
+    uint64_t state = 88172645463325252ull;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = os_bench_rand(&state) % (count * 2u);
+        os_rbt_insert(rbt, &key);
+    }
+    double rebuild_ms = (os_bench_now() - start) * 1e3;
+
+    start = os_bench_now();
+    if (!os_rbt_save(rbt, path)) {
+        fprintf(stderr, "os_rbt_save failed\n");
+        os_rbt_destroy(&rbt);
+        return;
+    }
+    double save_ms = (os_bench_now() - start) * 1e3;
+
+    uint64_t probe = 0u;
+    start = os_bench_now();
+    os_rbt_view_t * view = os_rbt_map(path, sizeof(uint64_t), os_bench_compare);
+    const void * first = os_rbt_view_lower_bound(view, &probe);
+    double map_ms = (os_bench_now() - start) * 1e3;
+    if (NULL == view || NULL == first) {
+        fprintf(stderr, "os_rbt_map failed\n");
+        os_rbt_destroy(&rbt);
+        return;
+    }
+
+    size_t found = 0u;
+    state = 2463534242ull;
+    start = os_bench_now();
+    for (size_t i = 0; i < OS_BENCH_FINDS; i++) {
+        uint64_t key = os_bench_rand(&state) % (count * 2u);
+        if (NULL != os_rbt_find(rbt, &key))
+            found++;
+    }
+    double tree_ns = (os_bench_now() - start) * 1e9 / (double)OS_BENCH_FINDS;
+
+    state = 2463534242ull;
+    start = os_bench_now();
+    for (size_t i = 0; i < OS_BENCH_FINDS; i++) {
+        uint64_t key = os_bench_rand(&state) % (count * 2u);
+        if (NULL != os_rbt_view_find(view, &key))
+            found--;
+    }
+    double view_ns = (os_bench_now() - start) * 1e9 / (double)OS_BENCH_FINDS;
+
+    if (0u != found)
+        fprintf(stderr, "tree and snapshot disagree\n");
+    printf("%-8s %10zu %12.1f %10.1f %14.3f %12.1f %12.1f\n", "os_rbt", os_rbt_size(rbt), rebuild_ms, save_ms, map_ms, tree_ns, view_ns);
+
+    os_rbt_unmap(&view);
+    os_rbt_destroy(&rbt);
+    remove(path);
+}
+
+// 逐个追加重建与映射快照后随机访问第一个元素的耗时
+static void os_bench_dlist(size_t count, const char * path)
+{
+    double start = os_bench_now();
+    os_dlist_t * lst = os_dlist_create(sizeof(uint64_t));
+    for (uint64_t i = 0; i < count; i++)
+        os_dlist_add(lst, &i);
+    double rebuild_ms = (os_bench_now() - start) * 1e3;
+
+    start = os_bench_now();
+    bool saved = os_dlist_save(lst, path);
+    double save_ms = (os_bench_now() - start) * 1e3;
+
+    start = os_bench_now();
+    os_dlist_view_t * view = os_dlist_map(path, sizeof(uint64_t));
+    const void * last = os_dlist_view_at(view, count - 1u);
+    double map_ms = (os_bench_now() - start) * 1e3;
+    if (!saved || NULL == last || *(const uint64_t *)last != count - 1u)
+        fprintf(stderr, "os_dlist snapshot failed\n");
+    printf("%-8s %10zu %12.1f %10.1f %14.3f %12s %12s\n", "os_dlist", os_dlist_size(lst), rebuild_ms, save_ms, map_ms, "-", "-");
+
+    os_dlist_unmap(&view);
+    os_dlist_destroy(&lst);
+    remove(path);
+}
+
+int main(int argc, char * argv[])
+{
+    const char * path = argc > 1 ? argv[1] : "os_snapshot_bench.snap";
+
+    // 文件刚写入, 仍在页缓存中, map耗时不含磁盘读取
+    printf("%-8s %10s %12s %10s %14s %12s %12s\n", "type", "elements", "rebuild ms", "save ms", "map+first ms", "tree find ns", "view find ns");
+    for (size_t count = 100000u; count <= 10000000u; count *= 10u) {
+        os_bench_rbt(count, path);
+        os_bench_dlist(count, path);
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+﻿#include "os_typed.h"
+#include "os_rbt.h"
+#include "os_slist.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define OS_BENCH_COUNT  1000000u  // 链表元素个数, 树的最大元素个数
+#define OS_BENCH_FINDS  1000000u  // 随机查找次数
+
+#define OS_BENCH_KEY_COMPARE(a, b) ((*(a) > *(b)) - (*(a) < *(b)))
+
+OS_DEFINE_SLIST(os_bench_slist, uint64_t)
+OS_DEFINE_RBT(os_bench_rbt, uint64_t, OS_BENCH_KEY_COMPARE)
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t os_bench_rand(uint64_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int os_bench_compare(const void * data1, const void * data2, size_t size)
+{
+    uint64_t key1 = *(const uint64_t *)data1;
+    uint64_t key2 = *(const uint64_t *)data2;
+    return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
+}
+
+// 链表尾部添加和遍历求和
+static void os_bench_slist(void)
+{
+    os_slist_t * lst = os_slist_create(sizeof(uint64_t));
+    double start = os_bench_now();
+    for (uint64_t i = 0; i < OS_BENCH_COUNT; i++)
+        os_slist_add(lst, &i);
+    double add_ns = (os_bench_now() - start) * 1e9 / OS_BENCH_COUNT;
+
+    uint64_t sum = 0u;
+    start = os_bench_now();
+    for (os_slist_node_t * node = os_slist_head(lst); NULL != node; node = os_slist_next(node))
+        sum += *(uint64_t *)os_slist_getdata(node);
+    double iter_ns = (os_bench_now() - start) * 1e9 / OS_BENCH_COUNT;
+    os_slist_destroy(&lst);
+    printf("%-14s %12.1f %12.2f %s\n", "os_slist", add_ns, iter_ns, 0u == sum ? "EMPTY" : "");
+
+    os_bench_slist_t typed;
+    os_bench_slist_init(&typed);
+    start = os_bench_now();
+    for (uint64_t i = 0; i < OS_BENCH_COUNT; i++)
+        os_bench_slist_add(&typed, i);
+    add_ns = (os_bench_now() - start) * 1e9 / OS_BENCH_COUNT;
+
+    sum = 0u;
+    start = os_bench_now();
+    for (os_bench_slist_node_t * node = os_bench_slist_head(&typed); NULL != node; node = os_bench_slist_next(node))
+        sum += *os_bench_slist_data(node);
+    iter_ns = (os_bench_now() - start) * 1e9 / OS_BENCH_COUNT;
+    os_bench_slist_clear(&typed);
+    printf("%-14s %12.1f %12.2f %s\n", "OS_DEFINE_SLIST", add_ns, iter_ns, 0u == sum ? "EMPTY" : "");
+}
+
+// 随机顺序插入count个键, 然后随机查找
+static void os_bench_rbt(const uint64_t * keys, size_t count)
+{
+    os_rbt_t * rbt = os_rbt_create(sizeof(uint64_t), os_bench_compare);
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i++)
+        os_rbt_insert(rbt, (void *)&keys[i]);
+    double insert_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    uint64_t state = 88172645463325252ull;
+    size_t found = 0u;
+    start = os_bench_now();
+    for (size_t i = 0; i < OS_BENCH_FINDS; i++) {
+        uint64_t key = os_bench_rand(&state) % count;
+        if (NULL != os_rbt_find(rbt, &key))
+            found++;
+    }
+    double find_ns = (os_bench_now() - start) * 1e9 / OS_BENCH_FINDS;
+    os_rbt_destroy(&rbt);
+    printf("%-14s %10zu %12.1f %12.1f %s\n", "os_rbt", count, insert_ns, find_ns, found == OS_BENCH_FINDS ? "" : "MISSING");
+
+    os_bench_rbt_t typed;
+    os_bench_rbt_init(&typed);
+    start = os_bench_now();
+    for (size_t i = 0; i < count; i++)
+        os_bench_rbt_insert(&typed, keys[i]);
+    insert_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    state = 88172645463325252ull;
+    found = 0u;
+    start = os_bench_now();
+    for (size_t i = 0; i < OS_BENCH_FINDS; i++) {
+        uint64_t key = os_bench_rand(&state) % count;
+        if (NULL != os_bench_rbt_find(&typed, &key))
+            found++;
+    }
+    find_ns = (os_bench_now() - start) * 1e9 / OS_BENCH_FINDS;
+    os_bench_rbt_clear(&typed);
+    printf("%-14s %10zu %12.1f %12.1f %s\n", "OS_DEFINE_RBT", count, insert_ns, find_ns, found == OS_BENCH_FINDS ? "" : "MISSING");
+}
+
+int main(void)
+{
+    uint64_t * keys = (uint64_t *)malloc(OS_BENCH_COUNT * sizeof(uint64_t));
+    if (NULL == keys) {
+        fprintf(stderr, "malloc failed\n");
+        return 1;
+    }
+
+    // 小规模时树在缓存中, 比较函数的调用开销占主要部分; 大规模时访存延迟占主要部分
+    printf("%-14s %10s %12s %12s\n", "rbt", "keys", "insert ns", "find ns");
+    for (size_t count = 1000u; count <= OS_BENCH_COUNT; count *= 10) {
+        uint64_t state = 2463534242ull;
+        for (size_t i = 0; i < count; i++)
+            keys[i] = i;
+        for (size_t i = count - 1; i > 0; i--) {
+            size_t j = (size_t)(os_bench_rand(&state) % (i + 1));
+            uint64_t tmp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = tmp;
+        }
+        os_bench_rbt(keys, count);
+    }
+
+    // 放在最后, 大量小块释放后glibc合并空闲块的开销不会计入其他测试
+    printf("%-14s %12s %12s\n", "slist", "add ns", "iter ns");
+    os_bench_slist();
+
+    free(keys);
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+﻿#include "os_dlist.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define OS_BENCH_REPS  5   // 遍历重复次数, 取最快的一次
+
+static double os_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t os_bench_rand(uint64_t * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// 遍历一次, 返回每个元素的耗时(ns)
+static double os_bench_iterate(const os_dlist_t * lst, size_t count, uint64_t * sum)
+{
+    double best = 0.0;
+    for (int r = 0; r < OS_BENCH_REPS; r++) {
+        double start = os_bench_now();
+        for (os_dlist_cursor_t cur = os_dlist_cursor(lst, 0); os_dlist_cursor_valid(&cur); os_dlist_cursor_next(&cur))
+            *sum += *(const uint32_t *)os_dlist_cursor_get(&cur);
+        double ns = (os_bench_now() - start) * 1e9 / (double)count;
+        if (0 == r || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+// 按连续段遍历
+static double os_bench_iterate_span(const os_dlist_t * lst, size_t count, uint64_t * sum)
+{
+    double best = 0.0;
+    for (int r = 0; r < OS_BENCH_REPS; r++) {
+        double start = os_bench_now();
+        os_dlist_cursor_t cur = os_dlist_cursor(lst, 0);
+        size_t n = 0u;
+        const uint32_t * data = NULL;
+        while (NULL != (data = (const uint32_t *)os_dlist_cursor_span(&cur, &n))) {
+            for (size_t i = 0; i < n; i++)
+                *sum += data[i];
+        }
+        double ns = (os_bench_now() - start) * 1e9 / (double)count;
+        if (0 == r || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+// 普通模式用os_dlist_next遍历
+static double os_bench_iterate_nodes(os_dlist_t * lst, size_t count, uint64_t * sum)
+{
+    double best = 0.0;
+    for (int r = 0; r < OS_BENCH_REPS; r++) {
+        double start = os_bench_now();
+        for (os_dlist_node_t * node = os_dlist_head(lst); NULL != node; node = os_dlist_next(node))
+            *sum += *(const uint32_t *)os_dlist_getdata(node);
+        double ns = (os_bench_now() - start) * 1e9 / (double)count;
+        if (0 == r || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+// per为0时为普通模式; random为true时按随机位置插入, 使节点在内存中的顺序被打乱
+static void os_bench_run(size_t per, size_t count, bool random)
+{
+    os_dlist_t * lst = per ? os_dlist_create_unrolled(sizeof(uint32_t), per) : os_dlist_create(sizeof(uint32_t));
+    uint64_t state = 88172645463325252ull;
+
+    double start = os_bench_now();
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = (uint32_t)i;
+        if (random)
+            os_dlist_insert(lst, (size_t)(os_bench_rand(&state) % (i + 1)), &value);
+        else
+            os_dlist_add(lst, &value);
+    }
+    double build_ns = (os_bench_now() - start) * 1e9 / (double)count;
+
+    uint64_t sum = 0u;
+    double iter_ns = os_bench_iterate(lst, count, &sum);
+    double span_ns = os_bench_iterate_span(lst, count, &sum);
+    char next_ns[32] = "-";
+    if (0u == per)
+        snprintf(next_ns, sizeof(next_ns), "%.2f", os_bench_iterate_nodes(lst, count, &sum));
+
+    printf("%-8zu %-7s %10zu %12.1f %12.2f %12.2f %12s %s\n", per, random ? "random" : "append", count, build_ns,
+           iter_ns, span_ns, next_ns, 0u == sum ? "EMPTY" : "");
+    os_dlist_destroy(&lst);
+}
+
+int main(int argc, char * argv[])
+{
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000u;
+    size_t random_count = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 50000u;
+    if (0u == count || 0u == random_count) {
+        fprintf(stderr, "usage: %s [append_count] [random_count]\n", argv[0]);
+        return 1;
+    }
+
+    static const size_t pers[] = { 0u, 4u, 16u, 64u };
+    printf("%-8s %-7s %10s %12s %12s %12s %12s\n", "per_node", "build", "elems", "build ns", "cursor ns", "span ns",
+           "next ns");
+    for (size_t i = 0; i < sizeof(pers) / sizeof(pers[0]); i++)
+        os_bench_run(pers[i], count, false);
+    for (size_t i = 0; i < sizeof(pers) / sizeof(pers[0]); i++)
+        os_bench_run(pers[i], random_count, true);
+
+    return 0;
+}
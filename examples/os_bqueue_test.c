@@ -0,0 +1,54 @@
+#include "os_bqueue.h"
+#include <pthread.h>
+
+#define OS_BQUEUE_TEST_COUNT 100000
+
+static void * os_bqueue_consumer(void * arg)
+{
+    os_bqueue_t * q = (os_bqueue_t *)arg;
+    long long sum = 0;
+    int num = 0;
+    OS_BQUEUE_RESULT_TYPE ret = OS_BQUEUE_OK;
+    while (OS_BQUEUE_CLOSED != (ret = os_bqueue_pop_wait(q, &num, 100))) {
+        if (OS_BQUEUE_TIMEOUT == ret) {
+            printf("consumer timeout\n");
+            continue;
+        }
+        sum += num;
+    }
+    printf("consumer done, sum: %lld\n", sum);
+
+    return NULL;
+}
+
+int main(int argc, char * argv[])
+{
+    os_bqueue_t * q = os_bqueue_create(sizeof(int), 64);
+    if (NULL == q) {
+        fprintf(stderr, "os_bqueue_create failed\n");
+        return 1;
+    }
+
+    pthread_t tids[2];
+    for (int i = 0; i < 2; i++)
+        pthread_create(&tids[i], NULL, os_bqueue_consumer, q);
+
+    for (int i = 0; i < OS_BQUEUE_TEST_COUNT; i++) {
+        if (OS_BQUEUE_OK != os_bqueue_push_wait(q, &i, -1)) {
+            fprintf(stderr, "os_bqueue_push_wait failed\n");
+            break;
+        }
+    }
+
+    // 关闭后消费者取完剩余数据即退出
+    os_bqueue_close(q);
+    for (int i = 0; i < 2; i++)
+        pthread_join(tids[i], NULL);
+
+    int num = 0;
+    printf("push after close: %d\n", os_bqueue_push_wait(q, &num, 0));
+
+    os_bqueue_destroy(&q);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+﻿#include "os_btree.h"
+
+static int os_int_compare(const void * data1, const void * data2, size_t size)
+{
+    int num1 = *(const int *)data1;
+    int num2 = *(const int *)data2;
+    return num1 < num2 ? -1 : (num1 > num2 ? 1 : 0);
+}
+
+static int os_int_print(const void * data, void * ctx)
+{
+    printf("%d ", *(const int *)data);
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    // 扇出取最小值4, 少量元素也能形成多层
+    os_btree_t * bt = os_btree_create_fanout(sizeof(int), os_int_compare, 4u);
+    if (NULL == bt) {
+        fprintf(stderr, "os_btree_create_fanout failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < 20; i++) {
+        os_btree_insert(bt, &i);
+    }
+    printf("size: %zu\n", os_btree_size(bt));
+
+    for (int i = 0; i < 20; i += 3) {
+        os_btree_erase(bt, &i);
+    }
+    printf("size after erase: %zu\n", os_btree_size(bt));
+
+    for (int i = 0; i < 20; i += 4) {
+        int * data = (int *)os_btree_find(bt, &i);
+        printf("find %d: %s\n", i, NULL != data ? "yes" : "no");
+    }
+
+    printf("in order: ");
+    os_btree_foreach(bt, os_int_print, NULL);
+    printf("\n");
+
+    int lo = 5, hi = 14;
+    printf("range [%d, %d): ", lo, hi);
+    os_btree_range(bt, &lo, &hi, os_int_print, NULL);
+    printf("\n");
+
+    os_btree_clear(bt);
+    printf("empty after clear: %d\n", os_btree_empty(bt));
+
+    os_btree_destroy(&bt);
+
+    return 0;
+}
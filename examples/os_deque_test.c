@@ -12,6 +12,11 @@ int main(int argc, char * argv[])
         os_deque_push_back(q, &i);
     }
 
+    for (size_t i = 0; i < os_deque_size(q); i++) {
+        int * data = (int *)os_deque_at(q, i);
+        printf("at %zu: %d\n", i, *data);
+    }
+
     while (!os_deque_empty(q)) {
         os_deque_node_t * node = os_deque_front(q);
         int * data = (int *)os_deque_getdata(node);
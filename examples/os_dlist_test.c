@@ -26,7 +26,19 @@ int main(void)
     cnt++;
     os_dlist_insert(lst, os_dlist_size(lst), &cnt);
 
-    os_dlist_delete(lst, (os_dlist_node_t*)100);
+    // 其他链表的节点会被拒绝
+    os_dlist_t * other = os_dlist_create(sizeof(int));
+    os_dlist_add(other, &cnt);
+    if (!os_dlist_delete(lst, os_dlist_get_handle(os_dlist_head(other))) && 1 == os_dlist_size(other))
+        printf("foreign node rejected\n");
+    os_dlist_destroy(&other);
+
+    // 节点删除后句柄失效
+    os_dlist_handle_t handle = os_dlist_get_handle(os_dlist_tail(lst));
+    os_dlist_delete(lst, handle);
+    os_dlist_add(lst, &cnt);
+    if (!os_dlist_delete(lst, handle))
+        printf("stale handle rejected\n");
     //for (int i = 0; i < 10; i++)
     //{
     //    os_dlist_add(lst, &i);
@@ -55,5 +67,23 @@ int main(void)
     os_dlist_clear(lst);
     os_dlist_destroy(&lst);
 
+    // 展开模式: 每个节点存放8个元素, 通过游标按段遍历
+    int nums[20];
+    for (int i = 0; i < 20; i++)
+        nums[i] = i;
+    lst = os_dlist_create_unrolled(sizeof(int), 8);
+    os_dlist_add_n(lst, nums, 20);
+    os_dlist_insert(lst, 5, &cnt);
+
+    size_t count = 0;
+    os_dlist_cursor_t cur = os_dlist_cursor(lst, 0);
+    int * span = NULL;
+    while (NULL != (span = (int *)os_dlist_cursor_span(&cur, &count))) {
+        for (size_t i = 0; i < count; i++)
+            printf("%d\t", span[i]);
+        printf("\n");
+    }
+    os_dlist_destroy(&lst);
+
     return 0;
 }
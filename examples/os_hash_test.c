@@ -0,0 +1,50 @@
+#include "os_hash.h"
+
+typedef struct _os_user_t {
+    int id;
+    int age;
+} os_user_t;
+
+static uint64_t os_user_hash(const void * data, size_t size)
+{
+    return (uint64_t)((const os_user_t *)data)->id;
+}
+
+static bool os_user_equal(const void * data1, const void * data2, size_t size)
+{
+    return ((const os_user_t *)data1)->id == ((const os_user_t *)data2)->id;
+}
+
+int main(int argc, char * argv[])
+{
+    os_hash_t * h = os_hash_create(sizeof(os_user_t), os_user_hash, os_user_equal);
+    if (NULL == h) {
+        fprintf(stderr, "os_hash_create failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < 100; i++) {
+        os_user_t user = { i, 20 + i % 30 };
+        os_hash_insert(h, &user);
+    }
+    printf("size: %zu\n", os_hash_size(h));
+
+    for (int i = 0; i < 100; i += 2) {
+        os_user_t key = { i, 0 };
+        os_hash_erase(h, &key);
+    }
+    printf("size after erase: %zu\n", os_hash_size(h));
+
+    for (int i = 0; i < 10; i++) {
+        os_user_t key = { i, 0 };
+        os_user_t * user = (os_user_t *)os_hash_find(h, &key);
+        if (NULL != user)
+            printf("id: %d age: %d\n", user->id, user->age);
+        else
+            printf("id: %d not found\n", i);
+    }
+
+    os_hash_destroy(&h);
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+﻿#include "os_ilist.h"
+#include "os_islist.h"
+
+typedef struct _session_t {
+    int id;                        // 编号
+    char payload[200];             // 业务数据
+    os_ilist_link_t active_link;   // 活跃链表节点
+    os_islist_link_t free_link;    // 空闲链表节点
+} session_t;
+
+int main(void)
+{
+    session_t sessions[10];
+    os_ilist_t active, closing;
+    os_islist_t free_list;
+
+    os_ilist_init(&active);
+    os_ilist_init(&closing);
+    os_islist_init(&free_list);
+
+    // 对象由调用者分配, 链表只串联指针
+    for (int i = 0; i < 10; i++) {
+        sessions[i].id = i;
+        snprintf(sessions[i].payload, sizeof(sessions[i].payload), "session-%d", i);
+        os_ilist_push_back(&active, &sessions[i].active_link);
+    }
+
+    // 偶数编号移到closing链表
+    os_ilist_link_t * link = NULL;
+    os_ilist_link_t * tmp = NULL;
+    os_ilist_foreach_safe(&active, link, tmp) {
+        session_t * s = os_ilist_entry(link, session_t, active_link);
+        if (0 == s->id % 2) {
+            os_ilist_unlink(&active, link);
+            os_ilist_push_back(&closing, link);
+        }
+    }
+    printf("active: %zu closing: %zu\n", os_ilist_size(&active), os_ilist_size(&closing));
+
+    // closing整体接回active头部
+    os_ilist_splice(&active, active.head.next, &closing);
+
+    os_ilist_foreach(&active, link) {
+        session_t * s = os_ilist_entry(link, session_t, active_link);
+        printf("active: %d %s\n", s->id, s->payload);
+    }
+
+    // 全部摘下放入空闲链表
+    while (NULL != (link = os_ilist_pop_front(&active))) {
+        session_t * s = os_ilist_entry(link, session_t, active_link);
+        os_islist_push_front(&free_list, &s->free_link);
+    }
+
+    os_islist_link_t * node = NULL;
+    os_islist_foreach(&free_list, node) {
+        session_t * s = os_islist_entry(node, session_t, free_link);
+        printf("free: %d\n", s->id);
+    }
+    printf("active: %zu free: %zu\n", os_ilist_size(&active), os_islist_size(&free_list));
+
+    return 0;
+}
@@ -1,5 +1,11 @@
 ﻿#include "os_queue.h"
 
+// 找到第一个大于ctx的元素后停止遍历
+static int os_int_find_greater(void * data, void * ctx)
+{
+    return *(int *)data > *(int *)ctx ? *(int *)data : 0;
+}
+
 int main(void)
 {
     os_queue_t * queue = os_queue_create(sizeof(int));
@@ -12,6 +18,9 @@ int main(void)
         os_queue_push(queue, &i);
     }
 
+    int limit = 6;
+    printf("first greater than %d: %d\n", limit, os_queue_foreach(queue, os_int_find_greater, &limit));
+
     while (!os_queue_empty(queue)) {
         os_queue_node_t * node = os_queue_front(queue);
         int * data = (int *)os_queue_getdata(node);
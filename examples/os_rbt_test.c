@@ -0,0 +1,90 @@
+#include "os_rbt.h"
+
+static int os_int_compare(const void * data1, const void * data2, size_t size)
+{
+    int num1 = *(const int *)data1;
+    int num2 = *(const int *)data2;
+    return num1 < num2 ? -1 : (num1 > num2 ? 1 : 0);
+}
+
+static int os_int_print(const void * data, void * ctx)
+{
+    printf("%d ", *(const int *)data);
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    os_rbt_t * rbt = os_rbt_create(sizeof(int), os_int_compare);
+    if (NULL == rbt) {
+        fprintf(stderr, "os_rbt_create failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < 20; i++) {
+        os_rbt_insert(rbt, &i);
+    }
+    printf("size: %zu\n", os_rbt_size(rbt));
+
+    for (int i = 0; i < 20; i += 3) {
+        os_rbt_erase(rbt, &i);
+    }
+    printf("size after erase: %zu\n", os_rbt_size(rbt));
+
+    for (int i = 0; i < 20; i++) {
+        os_rbt_node_t * node = os_rbt_find(rbt, &i);
+        if (NULL != node)
+            printf("find: %d\n", *(int *)os_rbt_data(node));
+    }
+
+    printf("in order: ");
+    os_rbt_foreach(rbt, os_int_print, NULL);
+    printf("\n");
+
+    int lo = 5, hi = 14;
+    printf("range [%d, %d): ", lo, hi);
+    os_rbt_range(rbt, &lo, &hi, os_int_print, NULL);
+    printf("\n");
+
+    os_rbt_node_t * first = os_rbt_first(rbt);
+    os_rbt_node_t * last = os_rbt_last(rbt);
+    printf("first: %d last: %d\n", *(int *)os_rbt_data(first), *(int *)os_rbt_data(last));
+    printf("lower_bound(%d): %d upper_bound(%d): %d\n", lo, *(int *)os_rbt_data(os_rbt_lower_bound(rbt, &lo)),
+           lo, *(int *)os_rbt_data(os_rbt_upper_bound(rbt, &lo)));
+
+    printf("reverse: ");
+    for (os_rbt_node_t * node = last; NULL != node; node = os_rbt_prev(node))
+        printf("%d ", *(int *)os_rbt_data(node));
+    printf("\n");
+
+    os_rbt_clear(rbt);
+    printf("empty after clear: %d\n", os_rbt_empty(rbt));
+
+    int sorted[10];
+    for (int i = 0; i < 10; i++)
+        sorted[i] = i * 10;
+    if (os_rbt_build_sorted(rbt, sorted, 10)) {
+        printf("build sorted: ");
+        os_rbt_foreach(rbt, os_int_print, NULL);
+        printf("\n");
+    }
+
+    // 保存快照后原地映射, 不需要重新插入
+    if (os_rbt_save(rbt, "os_rbt_test.snap")) {
+        os_rbt_view_t * view = os_rbt_map("os_rbt_test.snap", sizeof(int), os_int_compare);
+        int key = 40;
+        printf("snapshot size: %zu find(%d): %d\n", os_rbt_view_size(view), key, NULL != os_rbt_view_find(view, &key));
+        os_rbt_unmap(&view);
+        remove("os_rbt_test.snap");
+    }
+
+    // 以-DOS_ENABLE_STATS=ON构建时输出运行统计
+    os_stats_t stats;
+    if (os_rbt_stats(rbt, &stats) && 0u != stats.searches)
+        printf("allocs: %zu frees: %zu peak size: %zu avg depth: %.2f\n", stats.allocs, stats.frees, stats.peak_size,
+               (double)stats.search_depth / (double)stats.searches);
+
+    os_rbt_destroy(&rbt);
+
+    return 0;
+}
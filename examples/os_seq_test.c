@@ -0,0 +1,33 @@
+﻿#include "os_seq.h"
+#include <stdlib.h>
+#include <time.h>
+
+int main(void)
+{
+    srand((unsigned int)time(NULL));  // 用当前时间作为种子
+
+    os_seq_t * seq = os_seq_create(sizeof(int));
+    if (NULL == seq) {
+        printf("os_seq_create failed\n");
+        return 1;
+    }
+
+    // 每次插入到随机位置
+    for (int i = 0; i < 20; i++) {
+        size_t pos = (size_t)rand() % (os_seq_size(seq) + 1);
+        os_seq_insert(seq, pos, &i);
+    }
+
+    os_seq_erase(seq, 0);
+    os_seq_erase(seq, os_seq_size(seq) / 2);
+    printf("size: %zu, middle: %d\n", os_seq_size(seq), *(int *)os_seq_at(seq, os_seq_size(seq) / 2));
+
+    // 游标顺序遍历
+    for (os_seq_cursor_t cur = os_seq_cursor(seq, 0); os_seq_cursor_valid(&cur); os_seq_cursor_next(&cur))
+        printf("%d\t", *(int *)os_seq_cursor_get(&cur));
+    printf("\n");
+
+    os_seq_destroy(&seq);
+
+    return 0;
+}
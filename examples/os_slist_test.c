@@ -30,6 +30,13 @@ static bool os_delete_compare(const void * data1, const void * data2)
     return *num1 == *num2;
 }
 
+static bool os_remove_multiple(const void * data, void * ctx)
+{
+    int * num = (int *)data;
+    int * factor = (int *)ctx;
+    return 0 == *num % *factor;
+}
+
 int main(int argc, char * argv[])
 {
     os_slist_t * lst1 = os_slist_create(sizeof(int));
@@ -68,7 +75,34 @@ int main(int argc, char * argv[])
     printf("after delete: \n");
     os_slist_print(lst);
 
+    int factor = 3;
+    os_slist_node_t * removed = NULL;
+    size_t count = os_slist_remove_if(lst, os_remove_multiple, &factor, &removed);
+    printf("\nremoved %zu multiples of %d: \n", count, factor);
+    for (os_slist_node_t * node = removed; NULL != node; node = os_slist_next(node))
+        printf("%d\t", *(int *)os_slist_getdata(node));
+    os_slist_free_nodes(lst, removed);
+    printf("\nafter remove_if: \n");
+    os_slist_print(lst);
+    printf("\n");
+
+    os_slist_sort(lst, os_merge_compare);
+    printf("after sort: \n");
+    os_slist_print(lst);
+    printf("\n");
+
     os_slist_destroy(&lst1);
+    os_slist_destroy(&lst2);
+
+    // 节点从内存区分配, 链表销毁不逐个归还, 内存区整体释放
+    os_arena_t * arena = os_arena_create(0u);
+    os_allocator_t allocator = os_arena_allocator(arena);
+    os_slist_t * tmp = os_slist_create_ex(sizeof(int), &allocator);
+    for (int i = 0; i < 100; i++)
+        os_slist_add(tmp, &i);
+    printf("arena list size: %zu arena used: %zu\n", os_slist_size(tmp), os_arena_used(arena));
+    os_slist_destroy(&tmp);
+    os_arena_destroy(&arena);
 
     return 0;
 }
@@ -0,0 +1,61 @@
+#include "os_spsc_queue.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define OS_SPSC_TEST_COUNT 1000000
+
+static void * os_spsc_producer(void * arg)
+{
+    os_spsc_queue_t * q = (os_spsc_queue_t *)arg;
+    int batch[32];
+    int num = 0;
+    while (num < OS_SPSC_TEST_COUNT) {
+        int cnt = 0;
+        while (cnt < 32 && num + cnt < OS_SPSC_TEST_COUNT) {
+            batch[cnt] = num + cnt;
+            cnt++;
+        }
+        size_t pushed = os_spsc_queue_push_n(q, batch, (size_t)cnt);
+        if (0u == pushed)
+            sched_yield();
+        num += (int)pushed;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char * argv[])
+{
+    os_spsc_queue_t * q = os_spsc_queue_create(sizeof(int), 1000);
+    if (NULL == q) {
+        fprintf(stderr, "os_spsc_queue_create failed\n");
+        return 1;
+    }
+    printf("capacity: %zu\n", os_spsc_queue_capacity(q));
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, os_spsc_producer, q);
+
+    int expect = 0;
+    long long sum = 0;
+    while (expect < OS_SPSC_TEST_COUNT) {
+        int num = 0;
+        if (!os_spsc_queue_try_pop(q, &num)) {
+            sched_yield();
+            continue;
+        }
+        if (num != expect) {
+            fprintf(stderr, "out of order: %d != %d\n", num, expect);
+            break;
+        }
+        sum += num;
+        expect++;
+    }
+
+    pthread_join(tid, NULL);
+    printf("received: %d sum: %lld\n", expect, sum);
+
+    os_spsc_queue_destroy(&q);
+
+    return expect == OS_SPSC_TEST_COUNT ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+﻿#include "os_typed.h"
+
+typedef struct _os_point_t {
+    int x;
+    int y;
+} os_point_t;
+
+// 按x比较, 展开到生成的函数中, 不经过函数指针
+#define OS_POINT_COMPARE(a, b) (((a)->x > (b)->x) - ((a)->x < (b)->x))
+
+OS_DEFINE_SLIST(os_int_slist, int)
+OS_DEFINE_DLIST(os_int_dlist, int)
+OS_DEFINE_QUEUE(os_int_queue, int)
+OS_DEFINE_RBT(os_point_rbt, os_point_t, OS_POINT_COMPARE)
+
+static int os_int_print(int * data, void * ctx)
+{
+    printf("%d ", *data);
+    return 0;
+}
+
+static int os_point_print(const os_point_t * data, void * ctx)
+{
+    printf("(%d,%d) ", data->x, data->y);
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    os_int_slist_t slist;
+    os_int_slist_init(&slist);
+    for (int i = 0; i < 5; i++)
+        os_int_slist_add(&slist, i);
+    printf("slist: ");
+    os_int_slist_foreach(&slist, os_int_print, NULL);
+    printf("\n");
+    os_int_slist_clear(&slist);
+
+    os_int_dlist_t dlist;
+    os_int_dlist_init(&dlist);
+    for (int i = 0; i < 5; i++)
+        os_int_dlist_push_front(&dlist, i);
+    printf("dlist reverse: ");
+    os_int_dlist_foreach_reverse(&dlist, os_int_print, NULL);
+    printf("\n");
+    os_int_dlist_clear(&dlist);
+
+    os_int_queue_t queue;
+    os_int_queue_init(&queue);
+    for (int i = 0; i < 5; i++)
+        os_int_queue_push(&queue, i * 10);
+    int value = 0;
+    while (os_int_queue_pop(&queue, &value))
+        printf("queue pop: %d\n", value);
+
+    os_point_rbt_t rbt;
+    os_point_rbt_init(&rbt);
+    for (int i = 9; i >= 0; i--) {
+        os_point_t point = { i, i * i };
+        os_point_rbt_insert(&rbt, point);
+    }
+
+    os_point_t key = { 4, 0 };
+    os_point_rbt_node_t * node = os_point_rbt_find(&rbt, &key);
+    if (NULL != node)
+        printf("find x=4: y=%d\n", os_point_rbt_data(node)->y);
+
+    os_point_rbt_erase(&rbt, &key);
+    printf("rbt: ");
+    os_point_rbt_foreach(&rbt, os_point_print, NULL);
+    printf("\nsize: %zu\n", os_point_rbt_size(&rbt));
+    os_point_rbt_clear(&rbt);
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 #define __LIBOS_H__
 
 #include <stdio.h>
+#include <stddef.h>
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -22,4 +23,23 @@
 #define OS_API
 #endif
 
+// 缓存行大小, 用于隔离多线程频繁写入的字段
+#define OS_CACHE_LINE_SIZE 64
+
+// 由成员指针获取其所在结构体的指针
+#define os_container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+// 预取addr所在的缓存行, 仅是性能提示, 地址无效时也不会出错;
+// 遍历链式结构时预取后继的后继: 后继已在上一轮预取, 读取它的next不会停顿,
+// 隔一个节点发出的预取有一次visitor调用的时间完成, 只预取后继则几乎掩盖不了访存延迟
+#if defined(__GNUC__) || defined(__clang__)
+#define OS_PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define OS_PREFETCH(addr) _mm_prefetch((const char *)(addr), _MM_HINT_T0)
+#else
+#define OS_PREFETCH(addr) ((void)(addr))
+#endif
+
 #endif
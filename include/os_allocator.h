@@ -0,0 +1,108 @@
+﻿#ifndef __OS_ALLOCATOR_H__
+#define __OS_ALLOCATOR_H__
+
+#include "libos.h"
+
+// 容器的内存分配接口, 容器结构、节点池内存块、双端队列的块都经由它申请和释放;
+// free为NULL表示区域式分配器(如os_arena_t), 容器清空和销毁时不逐块归还, 内存由分配器整体释放;
+// 只在单次调用内存在的临时缓冲区(展开链表排序、并发区间遍历的元素副本)不经由分配器, 直接使用malloc/free,
+// 以免区域式分配器下每次调用都占用内存区
+
+typedef void * (*os_alloc_fn)(void * ctx, size_t size);
+typedef void (*os_free_fn)(void * ctx, void * ptr, size_t size);
+
+typedef struct _os_allocator_t {
+    os_alloc_fn alloc;      // 申请size字节, 按2 * sizeof(void *)对齐, 失败返回NULL
+    os_free_fn free;        // 归还alloc申请的内存, size与申请时相同; NULL表示不逐块归还
+    void * ctx;             // 传给alloc/free的用户数据
+} os_allocator_t;
+
+// 按块顺序分配的内存区, 只能整体释放
+typedef struct _os_arena_t os_arena_t;
+
+OS_API_BEGIN
+
+/*
+* os_allocator_default
+* @brief  获取默认分配器(malloc/free)
+* @return 分配器指针, 全局共享, 不需要释放
+*/
+OS_API const os_allocator_t * os_allocator_default(void);
+
+/*
+* os_allocator_alloc
+* @brief  经由分配器申请内存, allocator为NULL时使用默认分配器
+* @param  allocator  分配器
+* @param  size       字节数
+* @return NULL/内存地址, 内容未初始化
+*/
+OS_API void * os_allocator_alloc(const os_allocator_t * allocator, size_t size);
+
+/*
+* os_allocator_calloc
+* @brief  经由分配器申请内存并清零
+* @param  allocator  分配器
+* @param  size       字节数
+* @return NULL/内存地址
+*/
+OS_API void * os_allocator_calloc(const os_allocator_t * allocator, size_t size);
+
+/*
+* os_allocator_free
+* @brief  经由分配器归还内存, 区域式分配器不做任何事
+* @param  allocator  分配器
+* @param  ptr        内存地址, 可以为NULL
+* @param  size       申请时的字节数
+*/
+OS_API void os_allocator_free(const os_allocator_t * allocator, void * ptr, size_t size);
+
+/*
+* os_arena_create
+* @brief  创建内存区, 不是线程安全的
+* @param  block_size  单个内存块的字节数, 0表示使用默认值(64KB); 超过块大小的申请单独占用一块, 重置时释放
+* @return NULL/实例
+*/
+OS_API os_arena_t * os_arena_create(size_t block_size);
+
+/*
+* os_arena_destroy
+* @brief  销毁内存区, 从中分配的内存全部失效, 使用该内存区的容器不能再访问
+* @param  arena  指向内存区指针的指针
+*/
+OS_API void os_arena_destroy(os_arena_t ** arena);
+
+/*
+* os_arena_reset
+* @brief  整体释放已分配的内存, 保留首个默认大小的内存块供再次使用; 使用该内存区的容器要先销毁或不再访问
+* @param  arena  内存区指针
+*/
+OS_API void os_arena_reset(os_arena_t * arena);
+
+/*
+* os_arena_alloc
+* @brief  从内存区顺序分配
+* @param  arena  内存区指针
+* @param  size   字节数
+* @return NULL/内存地址, 按2 * sizeof(void *)对齐
+*/
+OS_API void * os_arena_alloc(os_arena_t * arena, size_t size);
+
+/*
+* os_arena_used
+* @brief  获取已分配的字节数(含对齐填充)
+* @param  arena  内存区指针
+* @return 字节数
+*/
+OS_API size_t os_arena_used(const os_arena_t * arena);
+
+/*
+* os_arena_allocator
+* @brief  获取以内存区为后端的分配器, 其free为NULL, 容器的清空和销毁不逐块归还内存
+* @param  arena  内存区指针
+* @return 分配器, 按值传入os_*_create_ex即可
+*/
+OS_API os_allocator_t os_arena_allocator(os_arena_t * arena);
+
+OS_API_END
+
+#endif
@@ -0,0 +1,90 @@
+﻿#ifndef __OS_BQUEUE_H__
+#define __OS_BQUEUE_H__
+
+#include "libos.h"
+#include "os_allocator.h"
+
+typedef struct _os_bqueue_t os_bqueue_t;
+
+typedef enum _OS_BQUEUE_RESULT_TYPE
+{
+    OS_BQUEUE_OK,        // 成功
+    OS_BQUEUE_TIMEOUT,   // 等待超时
+    OS_BQUEUE_CLOSED,    // 队列已关闭
+    OS_BQUEUE_ERROR      // 参数错误或内存不足
+} OS_BQUEUE_RESULT_TYPE;
+
+OS_API_BEGIN
+
+/*
+* os_bqueue_create
+* @brief  创建线程安全的阻塞队列
+* @param  elem_size  元素大小
+* @param  capacity   容量, 0表示不限制
+* @return 队列指针或者为NULL
+*/
+OS_API os_bqueue_t * os_bqueue_create(size_t elem_size, size_t capacity);
+
+/*
+* os_bqueue_create_ex
+* @brief  创建线程安全的阻塞队列, 队列本身和数据块经由allocator申请和释放
+* @param  elem_size  元素大小
+* @param  capacity   容量, 0表示不限制
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 只在持有队列锁时调用, 不能与其他线程共用
+* @return 队列指针或者为NULL
+*/
+OS_API os_bqueue_t * os_bqueue_create_ex(size_t elem_size, size_t capacity, const os_allocator_t * allocator);
+
+/*
+* os_bqueue_destroy
+* @brief  销毁队列, 调用前需保证没有线程在等待
+* @param  q  指向队列指针的指针
+*/
+OS_API void os_bqueue_destroy(os_bqueue_t ** q);
+
+/*
+* os_bqueue_close
+* @brief  关闭队列并唤醒所有等待者, 之后不能再插入, 剩余数据仍可取出
+* @param  q  队列指针
+*/
+OS_API void os_bqueue_close(os_bqueue_t * q);
+
+/*
+* os_bqueue_closed
+* @brief  判断队列是否已关闭
+* @param  q  队列指针
+* @return true--已关闭 false--未关闭
+*/
+OS_API bool os_bqueue_closed(os_bqueue_t * q);
+
+/*
+* os_bqueue_size
+* @brief  获取队列长度
+* @param  q  队列指针
+* @return 队列长度
+*/
+OS_API size_t os_bqueue_size(os_bqueue_t * q);
+
+/*
+* os_bqueue_push_wait
+* @brief  向队列尾插入数据, 队列满时等待
+* @param  q           队列指针
+* @param  data        数据指针
+* @param  timeout_ms  超时时间(毫秒), 0不等待, 小于0一直等待
+* @return OS_BQUEUE_OK/OS_BQUEUE_TIMEOUT/OS_BQUEUE_CLOSED/OS_BQUEUE_ERROR
+*/
+OS_API OS_BQUEUE_RESULT_TYPE os_bqueue_push_wait(os_bqueue_t * q, const void * data, int timeout_ms);
+
+/*
+* os_bqueue_pop_wait
+* @brief  取出队列头数据, 队列空时等待
+* @param  q           队列指针
+* @param  data        接收数据的缓冲区
+* @param  timeout_ms  超时时间(毫秒), 0不等待, 小于0一直等待
+* @return OS_BQUEUE_OK/OS_BQUEUE_TIMEOUT/OS_BQUEUE_CLOSED/OS_BQUEUE_ERROR
+*/
+OS_API OS_BQUEUE_RESULT_TYPE os_bqueue_pop_wait(os_bqueue_t * q, void * data, int timeout_ms);
+
+OS_API_END
+
+#endif
@@ -0,0 +1,142 @@
+﻿#ifndef __OS_BTREE_H__
+#define __OS_BTREE_H__
+
+#include "libos.h"
+#include "os_allocator.h"
+
+// B树: 每个节点连续存放多个元素, 查找时每层只有一次缓存缺失
+// 元素在节点内和节点间移动, 元素指针在插入或删除后失效
+
+typedef struct _os_btree_t os_btree_t;
+
+OS_API_BEGIN
+
+/*
+* @brief  键值比较回调函数, 与os_rbt_compare相同
+* @param  data1
+* @param  data2
+* @param  size
+* @return -1(data1<data2) 0(data1==data2) 1(data1>data2)
+*/
+typedef int(*os_btree_compare)(const void * data1, const void * data2, size_t size);
+
+/*
+* @brief  遍历回调函数
+* @param  data  元素, 不能修改参与比较的部分
+* @param  ctx   用户数据
+* @return 0继续遍历, 非0停止遍历
+*/
+typedef int(*os_btree_visitor)(const void * data, void * ctx);
+
+/*
+* os_btree_create
+* @brief  创建B树, 扇出按元素大小取默认值, 使节点元素区约为4个缓存行
+* @param  elem_size  元素类型大小
+* @param  cmp  键值比较函数
+* @return NULL/实例
+*/
+OS_API os_btree_t * os_btree_create(size_t elem_size, os_btree_compare cmp);
+
+/*
+* os_btree_create_fanout
+* @brief  创建B树并指定扇出
+* @param  elem_size  元素类型大小
+* @param  cmp     键值比较函数
+* @param  fanout  内部节点最多的孩子个数, 向下取偶数, 最小为4, 0表示使用默认值
+* @return NULL/实例
+*/
+OS_API os_btree_t * os_btree_create_fanout(size_t elem_size, os_btree_compare cmp, size_t fanout);
+
+/*
+* os_btree_create_ex
+* @brief  创建B树, B树本身和节点都经由allocator申请和释放
+* @param  elem_size  元素类型大小
+* @param  cmp        键值比较函数
+* @param  fanout     内部节点最多的孩子个数, 同os_btree_create_fanout
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 区域式分配器下清空和销毁为O(1)
+* @return NULL/实例
+*/
+OS_API os_btree_t * os_btree_create_ex(size_t elem_size, os_btree_compare cmp, size_t fanout, const os_allocator_t * allocator);
+
+/*
+* os_btree_destroy
+* @brief  销毁B树
+* @param  bt  树实例
+*/
+OS_API void os_btree_destroy(os_btree_t ** bt);
+
+/*
+* os_btree_clear
+* @brief  清空树
+* @param  bt  树实例
+*/
+OS_API void os_btree_clear(os_btree_t * bt);
+
+/*
+* os_btree_insert
+* @brief  插入元素, 已存在时不修改
+* @param  bt    树实例
+* @param  data  要插入的数据
+* @return true/false
+*/
+OS_API bool os_btree_insert(os_btree_t * bt, const void * data);
+
+/*
+* os_btree_erase
+* @brief  删除元素
+* @param  bt    树实例
+* @param  data  要删除的数据
+* @return true/false
+*/
+OS_API bool os_btree_erase(os_btree_t * bt, const void * data);
+
+/*
+* os_btree_find
+* @brief  查找元素
+* @param  bt    树实例
+* @param  data  要查找的数据
+* @return NULL/元素指针, 插入或删除后失效
+*/
+OS_API void * os_btree_find(const os_btree_t * bt, const void * data);
+
+/*
+* os_btree_size
+* @brief  获取树元素个数
+* @param  bt  树实例
+* @return 元素个数
+*/
+OS_API size_t os_btree_size(const os_btree_t * bt);
+
+/*
+* os_btree_empty
+* @brief  判断树是否为空
+* @param  bt  树实例
+* @return true/false
+*/
+OS_API bool os_btree_empty(const os_btree_t * bt);
+
+/*
+* os_btree_foreach
+* @brief  按键值从小到大访问每个元素, 遍历过程中不能修改树
+* @param  bt       树实例
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_btree_foreach(const os_btree_t * bt, os_btree_visitor visitor, void * ctx);
+
+/*
+* os_btree_range
+* @brief  按键值从小到大访问[lo, hi)内的元素, 访问k个元素耗时O(log n + k), 遍历过程中不能修改树
+* @param  bt       树实例
+* @param  lo       下界(包含), NULL表示从最小元素开始
+* @param  hi       上界(不包含), NULL表示到最大元素为止
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_btree_range(const os_btree_t * bt, const void * lo, const void * hi, os_btree_visitor visitor, void * ctx);
+
+OS_API_END
+
+#endif
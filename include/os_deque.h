@@ -2,6 +2,8 @@
 #define __OS_DEQUE_H__
 
 #include "libos.h"
+#include "os_stats.h"
+#include "os_allocator.h"
 
 typedef struct _os_deque_t os_deque_t;
 typedef struct _os_deque_node_t os_deque_node_t;
@@ -16,6 +18,15 @@ OS_API_BEGIN
 */
 OS_API os_deque_t * os_deque_create(size_t elem_size);
 
+/*
+* os_deque_create_ex
+* @brief  创建队列, 队列本身、块和块指针数组都经由allocator申请和释放
+* @param  elem_size  元素大小
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存
+* @return 队列指针或者为NULL
+*/
+OS_API os_deque_t * os_deque_create_ex(size_t elem_size, const os_allocator_t * allocator);
+
 /*
 * os_deque_destroy
 * @brief  销毁队列
@@ -64,6 +75,26 @@ OS_API bool os_deque_push_back(os_deque_t * q, void * data);
 */
 OS_API bool os_deque_push_front(os_deque_t * q, void * data);
 
+/*
+* os_deque_push_back_n
+* @brief  队列尾批量插入数据, 失败时队列不变
+* @param  q      队列指针
+* @param  data   连续存放的count个元素
+* @param  count  元素个数
+* @return true--成功 false--失败
+*/
+OS_API bool os_deque_push_back_n(os_deque_t * q, const void * data, size_t count);
+
+/*
+* os_deque_push_front_n
+* @brief  队列头批量插入数据, 保持数组顺序, 即data[0]成为新的队列头, 失败时队列不变
+* @param  q      队列指针
+* @param  data   连续存放的count个元素
+* @param  count  元素个数
+* @return true--成功 false--失败
+*/
+OS_API bool os_deque_push_front_n(os_deque_t * q, const void * data, size_t count);
+
 /*
 * os_deque_pop
 * @brief  删除队列头
@@ -82,7 +113,7 @@ OS_API bool os_deque_pop_back(os_deque_t * q);
 
 /*
 * os_deque_front
-* @brief  获取队列头
+* @brief  获取队列头, 节点在其元素出队前一直有效
 * @param  q  队列指针
 * @return 头结点指针或者NULL
 */
@@ -90,7 +121,7 @@ OS_API os_deque_node_t * os_deque_front(os_deque_t * q);
 
 /*
 * os_deque_back
-* @brief  获取队列头
+* @brief  获取队列尾, 节点在其元素出队前一直有效
 * @param  q  队列指针
 * @return 尾结点指针或者NULL
 */
@@ -104,6 +135,24 @@ OS_API os_deque_node_t * os_deque_back(os_deque_t * q);
 */
 OS_API void * os_deque_getdata(const os_deque_node_t * node);
 
+/*
+* os_deque_at
+* @brief  按下标获取元素, O(1)
+* @param  q      队列指针
+* @param  index  下标, 0为队列头
+* @return 数据指针或者NULL
+*/
+OS_API void * os_deque_at(const os_deque_t * q, size_t index);
+
+/*
+* os_deque_stats
+* @brief  获取运行统计, 需要以OS_ENABLE_STATS编译
+* @param  q      队列指针
+* @param  stats  输出统计, 未开启统计时清零
+* @return true--成功 false--未开启统计或参数错误
+*/
+OS_API bool os_deque_stats(const os_deque_t * q, os_stats_t * stats);
+
 OS_API_END
 
 #endif
@@ -2,9 +2,32 @@
 #define __OS_DOUBLE_LIST_H__
 
 #include "libos.h"
+#include "os_stats.h"
+#include "os_allocator.h"
+#include <stdint.h>
 
 typedef struct _os_dlist_t os_dlist_t;
 typedef struct _os_dlist_node_t os_dlist_node_t;
+typedef struct _os_dlist_view_t os_dlist_view_t;
+typedef bool (*os_dlist_compare)(const void * data1, const void * data2);
+typedef bool (*os_dlist_predicate)(const void * data, void * ctx);
+typedef int (*os_dlist_visitor)(void * data, void * ctx);
+typedef int (*os_dlist_view_visitor)(const void * data, void * ctx);
+
+// 顺序游标, 普通模式和展开模式通用, 链表插入或删除后失效
+typedef struct _os_dlist_cursor_t {
+    const os_dlist_t * lst;  // 所属链表
+    void * node;             // 当前节点或块, NULL表示越界
+    size_t index;            // 块内下标, 普通模式总为0
+} os_dlist_cursor_t;
+
+// 节点句柄, 节点被删除或重新分配、链表清空或销毁后句柄失效, 可在O(1)内校验;
+// 先比较链表编号和清空时的代数, 不会读取已经释放的内存
+typedef struct _os_dlist_handle_t {
+    os_dlist_node_t * node;  // 节点
+    uint32_t owner;          // 节点所属链表编号
+    uint32_t gen;            // 节点分配时的代数
+} os_dlist_handle_t;
 
 OS_API_BEGIN
 
@@ -16,6 +39,46 @@ OS_API_BEGIN
 */
 OS_API os_dlist_t * os_dlist_create(size_t elem_size);
 
+/*
+* os_dlist_create_pool
+* @brief  创建链表并指定节点池内存块大小
+* @param  elem_size   节点大小
+* @param  chunk_size  每个内存块容纳的节点个数, 0表示使用默认值
+* @return 链表指针或者为NULL
+*/
+OS_API os_dlist_t * os_dlist_create_pool(size_t elem_size, size_t chunk_size);
+
+/*
+* os_dlist_create_ex
+* @brief  创建链表, 链表本身和节点都经由allocator申请和释放
+* @param  elem_size  节点大小
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 区域式分配器下清空和销毁为O(1)
+* @return 链表指针或者为NULL
+*/
+OS_API os_dlist_t * os_dlist_create_ex(size_t elem_size, const os_allocator_t * allocator);
+
+/*
+* os_dlist_create_unrolled
+* @brief  创建展开模式的链表, 每个节点连续存放多个元素, 遍历和插入主要在连续内存上进行
+*         该模式下没有单元素节点, 只能通过游标访问元素: os_dlist_head/os_dlist_tail返回NULL,
+*         os_dlist_delete和os_dlist_handle_node总是失败; 排序借助临时缓冲区,
+*         os_dlist_remove_if把被删除的元素拷入独立节点返回
+* @param  elem_size       元素大小
+* @param  elems_per_node  每个节点的元素个数, 小于2时等同于os_dlist_create
+* @return 链表指针或者为NULL
+*/
+OS_API os_dlist_t * os_dlist_create_unrolled(size_t elem_size, size_t elems_per_node);
+
+/*
+* os_dlist_create_unrolled_ex
+* @brief  创建展开模式的链表, 链表本身、元素块和os_dlist_remove_if返回的节点都经由allocator申请和释放
+* @param  elem_size       元素大小
+* @param  elems_per_node  每个节点的元素个数, 小于2时等同于os_dlist_create_ex
+* @param  allocator       分配器, NULL表示默认分配器
+* @return 链表指针或者为NULL
+*/
+OS_API os_dlist_t * os_dlist_create_unrolled_ex(size_t elem_size, size_t elems_per_node, const os_allocator_t * allocator);
+
 /*
 * os_dlist_destroy
 * @brief  销毁链表
@@ -55,6 +118,16 @@ OS_API size_t os_dlist_size(os_dlist_t * lst);
 */
 OS_API bool os_dlist_add(os_dlist_t * lst, void * data);
 
+/*
+* os_dlist_add_n
+* @brief  向链表尾部批量添加数据, 节点一次性分配, 失败时链表不变
+* @param  lst    链表指针
+* @param  data   连续存放的count个元素
+* @param  count  元素个数
+* @return true--成功 false--失败
+*/
+OS_API bool os_dlist_add_n(os_dlist_t * lst, const void * data, size_t count);
+
 /*
 * os_dlist_insert
 * @brief  向链表指定位置插入数据
@@ -65,14 +138,26 @@ OS_API bool os_dlist_add(os_dlist_t * lst, void * data);
 */
 OS_API bool os_dlist_insert(os_dlist_t * lst, size_t pos, void * data);
 
+/*
+* os_dlist_insert_n
+* @brief  向链表指定位置批量插入数据, 插入后第一个元素位于pos, 失败时链表不变
+* @param  lst    链表指针
+* @param  pos    位置, 不小于链表长度时添加到尾部
+* @param  data   连续存放的count个元素
+* @param  count  元素个数
+* @return true--成功 false--失败
+*/
+OS_API bool os_dlist_insert_n(os_dlist_t * lst, size_t pos, const void * data, size_t count);
+
 /*
 * os_dlist_delete
-* @brief  从链表中删除数据
-* @param  lst   链表指针
-* @param  node  要删除的节点指针
-* @return NULL 或者下一个节点
+* @brief  根据句柄在O(1)内删除节点, 拒绝其他链表、已删除或重新分配的节点以及清空前取得的句柄;
+*         遍历中删除时先用os_dlist_next取得下一个节点
+* @param  lst     链表指针
+* @param  handle  节点句柄, 由os_dlist_get_handle取得
+* @return true--成功 false--句柄不属于该链表或已失效, 展开模式总是失败
 */
-OS_API os_dlist_node_t * os_dlist_delete(os_dlist_t * lst, os_dlist_node_t * node);
+OS_API bool os_dlist_delete(os_dlist_t * lst, os_dlist_handle_t handle);
 
 /*
 * os_dlist_delete_ex
@@ -83,11 +168,127 @@ OS_API os_dlist_node_t * os_dlist_delete(os_dlist_t * lst, os_dlist_node_t * nod
 */
 OS_API bool os_dlist_delete_ex(os_dlist_t * lst, void * data);
 
+/*
+* os_dlist_remove_if
+* @brief  一次遍历删除所有满足条件的节点
+* @param  lst      链表指针
+* @param  pred     删除条件, 返回true的节点被删除
+* @param  ctx      传给pred的用户数据
+* @param  removed  非NULL时被删除的节点按原顺序串成链返回, 由调用者用os_dlist_free_nodes释放; NULL表示直接释放;
+*                  展开模式下为每个被删除的元素申请独立节点, 内存不足的元素留在链表中不删除
+* @return 删除的节点个数
+*/
+OS_API size_t os_dlist_remove_if(os_dlist_t * lst, os_dlist_predicate pred, void * ctx, os_dlist_node_t ** removed);
+
+/*
+* os_dlist_free_nodes
+* @brief  释放os_dlist_remove_if返回的节点链
+* @param  lst    链表指针
+* @param  nodes  节点链头
+*/
+OS_API void os_dlist_free_nodes(os_dlist_t * lst, os_dlist_node_t * nodes);
+
+/*
+* os_dlist_sort
+* @brief  稳定排序, 原地重新链接节点, 不申请内存; 展开模式下临时申请2倍元素总大小的缓冲区(malloc)
+* @param  lst      链表指针
+* @param  compare  data1小于data2时返回true
+* @return true--成功 false--参数错误或展开模式下内存不足
+*/
+OS_API bool os_dlist_sort(os_dlist_t * lst, os_dlist_compare compare);
+
+/*
+* os_dlist_foreach
+* @brief  从头到尾访问每个元素, 遍历过程中不能修改链表
+* @param  lst      链表指针
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_dlist_foreach(const os_dlist_t * lst, os_dlist_visitor visitor, void * ctx);
+
+/*
+* os_dlist_foreach_reverse
+* @brief  从尾到头访问每个元素, 遍历过程中不能修改链表
+* @param  lst      链表指针
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_dlist_foreach_reverse(const os_dlist_t * lst, os_dlist_visitor visitor, void * ctx);
+
+/*
+* os_dlist_cursor
+* @brief  获取指向指定位置的游标, 从较近的一端查找
+* @param  lst  链表指针
+* @param  pos  位置, 越界时返回无效游标
+* @return 游标
+*/
+OS_API os_dlist_cursor_t os_dlist_cursor(const os_dlist_t * lst, size_t pos);
+
+/*
+* os_dlist_cursor_valid
+* @brief  判断游标是否指向数据
+* @param  cur  游标指针
+* @return true/false
+*/
+OS_API bool os_dlist_cursor_valid(const os_dlist_cursor_t * cur);
+
+/*
+* os_dlist_cursor_get
+* @brief  获取游标处的数据指针
+* @param  cur  游标指针
+* @return 数据指针或者NULL
+*/
+OS_API void * os_dlist_cursor_get(const os_dlist_cursor_t * cur);
+
+/*
+* os_dlist_cursor_next
+* @brief  游标后移一个位置, 越过尾部后游标无效
+* @param  cur  游标指针
+* @return true--游标有效 false--已越界
+*/
+OS_API bool os_dlist_cursor_next(os_dlist_cursor_t * cur);
+
+/*
+* os_dlist_cursor_prev
+* @brief  游标前移一个位置, 越过头部后游标无效
+* @param  cur  游标指针
+* @return true--游标有效 false--已越界
+*/
+OS_API bool os_dlist_cursor_prev(os_dlist_cursor_t * cur);
+
+/*
+* os_dlist_cursor_span
+* @brief  获取游标处起连续存放的一段元素, 并将游标移到这段元素之后
+* @param  cur    游标指针
+* @param  count  返回这段元素的个数, 普通模式总为1
+* @return 首元素指针或者NULL(游标无效)
+*/
+OS_API void * os_dlist_cursor_span(os_dlist_cursor_t * cur, size_t * count);
+
+/*
+* os_dlist_get_handle
+* @brief  获取节点句柄, 节点必须仍在链表中
+* @param  node  节点指针
+* @return 节点句柄, node为NULL时句柄无效
+*/
+OS_API os_dlist_handle_t os_dlist_get_handle(const os_dlist_node_t * node);
+
+/*
+* os_dlist_handle_node
+* @brief  校验句柄并获取节点, 链表清空后取得的句柄才可能有效
+* @param  lst     链表指针
+* @param  handle  节点句柄
+* @return 节点指针或者NULL(句柄不属于该链表或已失效, 或链表为展开模式)
+*/
+OS_API os_dlist_node_t * os_dlist_handle_node(const os_dlist_t * lst, os_dlist_handle_t handle);
+
 /*
 * os_dlist_head
 * @brief  获取链表头节点
 * @param  lst   链表指针
-* @return 头节点指针或者NULL
+* @return 头节点指针或者NULL(空链表或展开模式, 展开模式用os_dlist_cursor(lst, 0)访问)
 */
 OS_API os_dlist_node_t * os_dlist_head(os_dlist_t * lst);
 
@@ -95,7 +296,7 @@ OS_API os_dlist_node_t * os_dlist_head(os_dlist_t * lst);
 * os_dlist_tail
 * @brief  获取链表尾节点
 * @param  lst   链表指针
-* @return 尾节点指针或者NULL
+* @return 尾节点指针或者NULL(空链表或展开模式, 展开模式用os_dlist_cursor(lst, size - 1)访问)
 */
 OS_API os_dlist_node_t * os_dlist_tail(os_dlist_t * lst);
 
@@ -123,6 +324,68 @@ OS_API os_dlist_node_t * os_dlist_prev(const os_dlist_node_t * node);
 */
 OS_API void * os_dlist_getdata(const os_dlist_node_t * node);
 
+/*
+* os_dlist_stats
+* @brief  获取运行统计, 需要以OS_ENABLE_STATS编译
+* @param  lst    链表指针
+* @param  stats  输出统计, 未开启统计时清零
+* @return true--成功 false--未开启统计或参数错误
+*/
+OS_API bool os_dlist_stats(const os_dlist_t * lst, os_stats_t * stats);
+
+/*
+* os_dlist_save
+* @brief  按链表顺序把全部元素写入快照文件, 文件不含指针, 可由os_dlist_map原地映射;
+*         元素按字节原样保存, 元素中含有指针时映射后不可用
+* @param  lst   链表指针
+* @param  path  文件路径, 已存在时整体替换; 先写入同目录下的临时文件, 已映射旧文件的快照仍然有效
+* @return true/false, 失败时原文件保持不变
+*/
+OS_API bool os_dlist_save(const os_dlist_t * lst, const char * path);
+
+/*
+* os_dlist_map
+* @brief  以只读方式映射快照文件, 只校验文件头, 耗时与元素个数无关, 页面在访问时按需载入
+* @param  path       文件路径
+* @param  elem_size  元素类型大小, 必须与保存时一致
+* @return NULL/快照实例
+*/
+OS_API os_dlist_view_t * os_dlist_map(const char * path, size_t elem_size);
+
+/*
+* os_dlist_unmap
+* @brief  解除快照映射, 之前取得的元素指针全部失效
+* @param  view  快照实例
+*/
+OS_API void os_dlist_unmap(os_dlist_view_t ** view);
+
+/*
+* os_dlist_view_size
+* @brief  获取快照元素个数
+* @param  view  快照实例
+* @return 元素个数
+*/
+OS_API size_t os_dlist_view_size(const os_dlist_view_t * view);
+
+/*
+* os_dlist_view_at
+* @brief  获取快照中第pos个元素, 元素连续存放, O(1)
+* @param  view  快照实例
+* @param  pos   位置, 从0开始
+* @return NULL/只读元素
+*/
+OS_API const void * os_dlist_view_at(const os_dlist_view_t * view, size_t pos);
+
+/*
+* os_dlist_view_foreach
+* @brief  按顺序访问快照中的每个元素
+* @param  view     快照实例
+* @param  visitor  访问函数, 返回非0时停止遍历; 元素位于只读映射中, 写入会触发段错误
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_dlist_view_foreach(const os_dlist_view_t * view, os_dlist_view_visitor visitor, void * ctx);
+
 OS_API_END
 
 #endif
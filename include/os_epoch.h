@@ -0,0 +1,78 @@
+﻿#ifndef __OS_EPOCH_H__
+#define __OS_EPOCH_H__
+
+#include "libos.h"
+
+// 基于纪元的内存回收: 读者进入和离开读区间时只修改本线程所在条带的计数器,
+// 写者把摘除的对象交给retire, 确认摘除前进入的读者都已离开后才真正释放
+
+typedef struct _os_epoch_t os_epoch_t;
+
+OS_API_BEGIN
+
+/*
+* @brief  释放回调函数
+* @param  obj  被回收的对象
+* @param  ctx  创建时传入的用户数据
+*/
+typedef void(*os_epoch_free)(void * obj, void * ctx);
+
+/*
+* os_epoch_create
+* @brief  创建回收器
+* @param  free_fn  释放回调函数
+* @param  ctx      传给free_fn的用户数据
+* @return NULL/实例
+*/
+OS_API os_epoch_t * os_epoch_create(os_epoch_free free_fn, void * ctx);
+
+/*
+* os_epoch_destroy
+* @brief  销毁回收器, 尚未释放的对象全部交给free_fn, 调用方保证此时没有读者
+* @param  epoch  回收器实例
+*/
+OS_API void os_epoch_destroy(os_epoch_t ** epoch);
+
+/*
+* os_epoch_enter
+* @brief  进入读区间, 可以嵌套, 区间内读到的对象不会被释放
+* @param  epoch  回收器实例
+* @return 凭据, 离开时传给os_epoch_leave
+*/
+OS_API unsigned os_epoch_enter(os_epoch_t * epoch);
+
+/*
+* os_epoch_leave
+* @brief  离开读区间
+* @param  epoch   回收器实例
+* @param  ticket  os_epoch_enter返回的凭据
+*/
+OS_API void os_epoch_leave(os_epoch_t * epoch, unsigned ticket);
+
+/*
+* os_epoch_retire
+* @brief  登记已摘除的对象, 写者之间需要由调用方互斥; 内存不足时退化为os_epoch_synchronize,
+*         因此同样不能在本线程的读区间内调用
+* @param  epoch  回收器实例
+* @param  obj    已对读者不可达的对象
+*/
+OS_API void os_epoch_retire(os_epoch_t * epoch, void * obj);
+
+/*
+* os_epoch_reclaim
+* @brief  释放已经安全的对象并在需要时推进纪元, 不等待读者, 写者之间需要由调用方互斥
+* @param  epoch  回收器实例
+*/
+OS_API void os_epoch_reclaim(os_epoch_t * epoch);
+
+/*
+* os_epoch_synchronize
+* @brief  等待当前所有读者离开, 然后释放全部已登记的对象, 写者之间需要由调用方互斥;
+*         本线程处于读区间时会等待自己, 造成死锁
+* @param  epoch  回收器实例
+*/
+OS_API void os_epoch_synchronize(os_epoch_t * epoch);
+
+OS_API_END
+
+#endif
@@ -0,0 +1,118 @@
+﻿#ifndef __OS_HASH_H__
+#define __OS_HASH_H__
+
+#include "libos.h"
+#include "os_allocator.h"
+#include <stdint.h>
+
+typedef struct _os_hash_t os_hash_t;
+
+OS_API_BEGIN
+
+/*
+* @brief  哈希回调函数
+* @param  data  元素
+* @param  size  元素大小
+* @return 哈希值
+*/
+typedef uint64_t (*os_hash_func)(const void * data, size_t size);
+
+/*
+* @brief  判等回调函数
+* @param  data1
+* @param  data2
+* @param  size  元素大小
+* @return true--相等 false--不相等
+*/
+typedef bool (*os_hash_equal)(const void * data1, const void * data2, size_t size);
+
+/*
+* os_hash_create
+* @brief  创建哈希表
+* @param  elem_size  元素大小
+* @param  hash   哈希函数, NULL表示按字节计算
+* @param  equal  判等函数, NULL表示按字节比较
+* @return NULL/实例
+*/
+OS_API os_hash_t * os_hash_create(size_t elem_size, os_hash_func hash, os_hash_equal equal);
+
+/*
+* os_hash_create_ex
+* @brief  创建哈希表, 哈希表本身和槽位数组都经由allocator申请和释放
+* @param  elem_size  元素大小
+* @param  hash       哈希函数, NULL表示按字节计算
+* @param  equal      判等函数, NULL表示按字节比较
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存; 区域式分配器下扩容后旧表不归还, 随内存区整体释放
+* @return NULL/实例
+*/
+OS_API os_hash_t * os_hash_create_ex(size_t elem_size, os_hash_func hash, os_hash_equal equal, const os_allocator_t * allocator);
+
+/*
+* os_hash_destroy
+* @brief  销毁哈希表
+* @param  h  指向哈希表指针的指针
+*/
+OS_API void os_hash_destroy(os_hash_t ** h);
+
+/*
+* os_hash_clear
+* @brief  清空哈希表
+* @param  h  哈希表实例
+*/
+OS_API void os_hash_clear(os_hash_t * h);
+
+/*
+* os_hash_size
+* @brief  获取元素个数
+* @param  h  哈希表实例
+* @return 元素个数
+*/
+OS_API size_t os_hash_size(const os_hash_t * h);
+
+/*
+* os_hash_empty
+* @brief  判断哈希表是否为空
+* @param  h  哈希表实例
+* @return true/false
+*/
+OS_API bool os_hash_empty(const os_hash_t * h);
+
+/*
+* os_hash_reserve
+* @brief  预留容量, 扩容时数据随后续插入删除逐步迁移; 上一次扩容尚未迁移完时, 本次扩容推迟到迁移完成后进行
+* @param  h      哈希表实例
+* @param  count  期望容纳的元素个数
+* @return true/false
+*/
+OS_API bool os_hash_reserve(os_hash_t * h, size_t count);
+
+/*
+* os_hash_insert
+* @brief  插入数据, 已存在时不做修改
+* @param  h     哈希表实例
+* @param  data  要插入的数据
+* @return true/false
+*/
+OS_API bool os_hash_insert(os_hash_t * h, const void * data);
+
+/*
+* os_hash_erase
+* @brief  删除数据
+* @param  h     哈希表实例
+* @param  data  要删除的数据
+* @return true--已删除 false--不存在
+*/
+OS_API bool os_hash_erase(os_hash_t * h, const void * data);
+
+/*
+* os_hash_find
+* @brief  查找数据, 返回的指针在下一次插入或删除前有效
+* @param  h     哈希表实例
+* @param  data  要查找的数据
+* @return NULL/元素指针
+*/
+OS_API void * os_hash_find(const os_hash_t * h, const void * data);
+
+OS_API_END
+
+#endif
@@ -0,0 +1,237 @@
+﻿#ifndef __OS_INTRUSIVE_LIST_H__
+#define __OS_INTRUSIVE_LIST_H__
+
+#include "libos.h"
+
+// 侵入式双链表: 链接节点由调用者嵌入自己的结构体中, 链表只修改指针, 不分配内存也不拷贝数据
+// 链表头是环形哨兵, 插入和删除不需要判断边界
+
+typedef struct _os_ilist_link_t os_ilist_link_t;
+
+struct _os_ilist_link_t {
+    os_ilist_link_t * next;   // 后继
+    os_ilist_link_t * prev;   // 前驱
+};
+
+typedef struct _os_ilist_t {
+    os_ilist_link_t head;     // 哨兵
+    size_t size;              // 节点个数
+} os_ilist_t;
+
+// 由链接节点获取所在的结构体
+#define os_ilist_entry(link, type, member) os_container_of(link, type, member)
+
+// 正向遍历, 遍历过程中不能删除link
+#define os_ilist_foreach(lst, link) \
+    for ((link) = (lst)->head.next; (link) != &(lst)->head; (link) = (link)->next)
+
+// 正向遍历, 遍历过程中可以删除link
+#define os_ilist_foreach_safe(lst, link, tmp) \
+    for ((link) = (lst)->head.next, (tmp) = (link)->next; (link) != &(lst)->head; (link) = (tmp), (tmp) = (link)->next)
+
+// 反向遍历, 遍历过程中不能删除link
+#define os_ilist_foreach_reverse(lst, link) \
+    for ((link) = (lst)->head.prev; (link) != &(lst)->head; (link) = (link)->prev)
+
+OS_API_BEGIN
+
+/*
+* os_ilist_init
+* @brief  初始化链表
+* @param  lst  链表指针
+*/
+static inline void os_ilist_init(os_ilist_t * lst)
+{
+    lst->head.next = &lst->head;
+    lst->head.prev = &lst->head;
+    lst->size = 0u;
+}
+
+/*
+* os_ilist_empty
+* @brief  判断链表是否为空
+* @param  lst  链表指针
+* @return true--为空 false--不为空
+*/
+static inline bool os_ilist_empty(const os_ilist_t * lst)
+{
+    return lst->head.next == &lst->head;
+}
+
+/*
+* os_ilist_size
+* @brief  获取链表长度
+* @param  lst  链表指针
+* @return 链表长度
+*/
+static inline size_t os_ilist_size(const os_ilist_t * lst)
+{
+    return lst->size;
+}
+
+/*
+* os_ilist_insert_before
+* @brief  在pos之前插入节点
+* @param  lst   链表指针
+* @param  pos   位置节点, 传入&lst->head表示插入到尾部
+* @param  link  要插入的节点, 不能已在其他链表中
+*/
+static inline void os_ilist_insert_before(os_ilist_t * lst, os_ilist_link_t * pos, os_ilist_link_t * link)
+{
+    link->next = pos;
+    link->prev = pos->prev;
+    pos->prev->next = link;
+    pos->prev = link;
+    ++lst->size;
+}
+
+/*
+* os_ilist_insert_after
+* @brief  在pos之后插入节点
+* @param  lst   链表指针
+* @param  pos   位置节点, 传入&lst->head表示插入到头部
+* @param  link  要插入的节点, 不能已在其他链表中
+*/
+static inline void os_ilist_insert_after(os_ilist_t * lst, os_ilist_link_t * pos, os_ilist_link_t * link)
+{
+    os_ilist_insert_before(lst, pos->next, link);
+}
+
+/*
+* os_ilist_push_front
+* @brief  向链表头部添加节点
+* @param  lst   链表指针
+* @param  link  要添加的节点
+*/
+static inline void os_ilist_push_front(os_ilist_t * lst, os_ilist_link_t * link)
+{
+    os_ilist_insert_before(lst, lst->head.next, link);
+}
+
+/*
+* os_ilist_push_back
+* @brief  向链表尾部添加节点
+* @param  lst   链表指针
+* @param  link  要添加的节点
+*/
+static inline void os_ilist_push_back(os_ilist_t * lst, os_ilist_link_t * link)
+{
+    os_ilist_insert_before(lst, &lst->head, link);
+}
+
+/*
+* os_ilist_unlink
+* @brief  从链表中摘除节点, 节点内存仍由调用者管理
+* @param  lst   链表指针
+* @param  link  链表中的节点
+*/
+static inline void os_ilist_unlink(os_ilist_t * lst, os_ilist_link_t * link)
+{
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = NULL;
+    link->prev = NULL;
+    --lst->size;
+}
+
+/*
+* os_ilist_head
+* @brief  获取链表头节点
+* @param  lst  链表指针
+* @return NULL/头节点
+*/
+static inline os_ilist_link_t * os_ilist_head(const os_ilist_t * lst)
+{
+    return lst->head.next == &lst->head ? NULL : lst->head.next;
+}
+
+/*
+* os_ilist_tail
+* @brief  获取链表尾节点
+* @param  lst  链表指针
+* @return NULL/尾节点
+*/
+static inline os_ilist_link_t * os_ilist_tail(const os_ilist_t * lst)
+{
+    return lst->head.prev == &lst->head ? NULL : lst->head.prev;
+}
+
+/*
+* os_ilist_next
+* @brief  获取下一个节点
+* @param  lst   链表指针
+* @param  link  当前节点
+* @return NULL/下一个节点
+*/
+static inline os_ilist_link_t * os_ilist_next(const os_ilist_t * lst, const os_ilist_link_t * link)
+{
+    return link->next == &lst->head ? NULL : link->next;
+}
+
+/*
+* os_ilist_prev
+* @brief  获取上一个节点
+* @param  lst   链表指针
+* @param  link  当前节点
+* @return NULL/上一个节点
+*/
+static inline os_ilist_link_t * os_ilist_prev(const os_ilist_t * lst, const os_ilist_link_t * link)
+{
+    return link->prev == &lst->head ? NULL : link->prev;
+}
+
+/*
+* os_ilist_pop_front
+* @brief  摘除并返回链表头节点
+* @param  lst  链表指针
+* @return NULL/头节点
+*/
+static inline os_ilist_link_t * os_ilist_pop_front(os_ilist_t * lst)
+{
+    os_ilist_link_t * link = os_ilist_head(lst);
+    if (NULL != link)
+        os_ilist_unlink(lst, link);
+    return link;
+}
+
+/*
+* os_ilist_pop_back
+* @brief  摘除并返回链表尾节点
+* @param  lst  链表指针
+* @return NULL/尾节点
+*/
+static inline os_ilist_link_t * os_ilist_pop_back(os_ilist_t * lst)
+{
+    os_ilist_link_t * link = os_ilist_tail(lst);
+    if (NULL != link)
+        os_ilist_unlink(lst, link);
+    return link;
+}
+
+/*
+* os_ilist_splice
+* @brief  将src的全部节点移动到dst的pos之前, 移动后src为空
+* @param  dst  目标链表
+* @param  pos  dst中的位置节点, 传入&dst->head表示接到尾部
+* @param  src  源链表
+*/
+static inline void os_ilist_splice(os_ilist_t * dst, os_ilist_link_t * pos, os_ilist_t * src)
+{
+    if (os_ilist_empty(src))
+        return;
+
+    os_ilist_link_t * first = src->head.next;
+    os_ilist_link_t * last = src->head.prev;
+
+    first->prev = pos->prev;
+    pos->prev->next = first;
+    last->next = pos;
+    pos->prev = last;
+
+    dst->size += src->size;
+    os_ilist_init(src);
+}
+
+OS_API_END
+
+#endif
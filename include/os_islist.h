@@ -0,0 +1,208 @@
+﻿#ifndef __OS_INTRUSIVE_SINGLE_LIST_H__
+#define __OS_INTRUSIVE_SINGLE_LIST_H__
+
+#include "libos.h"
+
+// 侵入式单链表: 链接节点由调用者嵌入自己的结构体中, 链表只修改指针, 不分配内存也不拷贝数据
+// 单链表没有前驱指针, 删除中间节点需要提供其前一个节点
+
+typedef struct _os_islist_link_t os_islist_link_t;
+
+struct _os_islist_link_t {
+    os_islist_link_t * next;   // 后继
+};
+
+typedef struct _os_islist_t {
+    os_islist_link_t * head;   // 头节点
+    os_islist_link_t * tail;   // 尾节点
+    size_t size;               // 节点个数
+} os_islist_t;
+
+// 由链接节点获取所在的结构体
+#define os_islist_entry(link, type, member) os_container_of(link, type, member)
+
+// 正向遍历, 遍历过程中不能删除link
+#define os_islist_foreach(lst, link) \
+    for ((link) = (lst)->head; NULL != (link); (link) = (link)->next)
+
+OS_API_BEGIN
+
+/*
+* os_islist_init
+* @brief  初始化链表
+* @param  lst  链表指针
+*/
+static inline void os_islist_init(os_islist_t * lst)
+{
+    lst->head = NULL;
+    lst->tail = NULL;
+    lst->size = 0u;
+}
+
+/*
+* os_islist_empty
+* @brief  判断链表是否为空
+* @param  lst  链表指针
+* @return true--为空 false--不为空
+*/
+static inline bool os_islist_empty(const os_islist_t * lst)
+{
+    return NULL == lst->head;
+}
+
+/*
+* os_islist_size
+* @brief  获取链表长度
+* @param  lst  链表指针
+* @return 链表长度
+*/
+static inline size_t os_islist_size(const os_islist_t * lst)
+{
+    return lst->size;
+}
+
+/*
+* os_islist_head
+* @brief  获取链表头节点
+* @param  lst  链表指针
+* @return NULL/头节点
+*/
+static inline os_islist_link_t * os_islist_head(const os_islist_t * lst)
+{
+    return lst->head;
+}
+
+/*
+* os_islist_tail
+* @brief  获取链表尾节点
+* @param  lst  链表指针
+* @return NULL/尾节点
+*/
+static inline os_islist_link_t * os_islist_tail(const os_islist_t * lst)
+{
+    return lst->tail;
+}
+
+/*
+* os_islist_next
+* @brief  获取下一个节点
+* @param  link  当前节点
+* @return NULL/下一个节点
+*/
+static inline os_islist_link_t * os_islist_next(const os_islist_link_t * link)
+{
+    return link->next;
+}
+
+/*
+* os_islist_push_front
+* @brief  向链表头部添加节点
+* @param  lst   链表指针
+* @param  link  要添加的节点, 不能已在其他链表中
+*/
+static inline void os_islist_push_front(os_islist_t * lst, os_islist_link_t * link)
+{
+    link->next = lst->head;
+    lst->head = link;
+    if (NULL == lst->tail)
+        lst->tail = link;
+    ++lst->size;
+}
+
+/*
+* os_islist_push_back
+* @brief  向链表尾部添加节点
+* @param  lst   链表指针
+* @param  link  要添加的节点, 不能已在其他链表中
+*/
+static inline void os_islist_push_back(os_islist_t * lst, os_islist_link_t * link)
+{
+    link->next = NULL;
+    if (NULL == lst->tail)
+        lst->head = link;
+    else
+        lst->tail->next = link;
+    lst->tail = link;
+    ++lst->size;
+}
+
+/*
+* os_islist_insert_after
+* @brief  在pos之后插入节点
+* @param  lst   链表指针
+* @param  pos   位置节点, NULL表示插入到头部
+* @param  link  要插入的节点, 不能已在其他链表中
+*/
+static inline void os_islist_insert_after(os_islist_t * lst, os_islist_link_t * pos, os_islist_link_t * link)
+{
+    if (NULL == pos) {
+        os_islist_push_front(lst, link);
+        return;
+    }
+
+    link->next = pos->next;
+    pos->next = link;
+    if (lst->tail == pos)
+        lst->tail = link;
+    ++lst->size;
+}
+
+/*
+* os_islist_unlink_after
+* @brief  摘除pos之后的节点, 节点内存仍由调用者管理
+* @param  lst  链表指针
+* @param  pos  位置节点, NULL表示摘除头节点
+* @return NULL/被摘除的节点
+*/
+static inline os_islist_link_t * os_islist_unlink_after(os_islist_t * lst, os_islist_link_t * pos)
+{
+    os_islist_link_t * link = NULL == pos ? lst->head : pos->next;
+    if (NULL == link)
+        return NULL;
+
+    if (NULL == pos)
+        lst->head = link->next;
+    else
+        pos->next = link->next;
+    if (lst->tail == link)
+        lst->tail = pos;
+    link->next = NULL;
+    --lst->size;
+
+    return link;
+}
+
+/*
+* os_islist_pop_front
+* @brief  摘除并返回链表头节点
+* @param  lst  链表指针
+* @return NULL/头节点
+*/
+static inline os_islist_link_t * os_islist_pop_front(os_islist_t * lst)
+{
+    return os_islist_unlink_after(lst, NULL);
+}
+
+/*
+* os_islist_splice
+* @brief  将src的全部节点接到dst尾部, 移动后src为空
+* @param  dst  目标链表
+* @param  src  源链表
+*/
+static inline void os_islist_splice(os_islist_t * dst, os_islist_t * src)
+{
+    if (NULL == src->head)
+        return;
+
+    if (NULL == dst->tail)
+        dst->head = src->head;
+    else
+        dst->tail->next = src->head;
+    dst->tail = src->tail;
+    dst->size += src->size;
+    os_islist_init(src);
+}
+
+OS_API_END
+
+#endif
@@ -0,0 +1,67 @@
+﻿#ifndef __OS_MAPFILE_H__
+#define __OS_MAPFILE_H__
+
+#include "libos.h"
+
+// 只读文件映射, 供容器快照在原地查询; 页面在首次访问时才由系统载入
+// 快照先写入同目录下的临时文件, 完成后整体替换目标文件, 已有映射继续引用旧文件
+
+typedef struct _os_mapfile_t os_mapfile_t;
+
+OS_API_BEGIN
+
+/*
+* os_mapfile_open
+* @brief  以只读方式映射整个文件
+* @param  path  文件路径
+* @return NULL/实例, 文件不存在或者为空时返回NULL
+*/
+OS_API os_mapfile_t * os_mapfile_open(const char * path);
+
+/*
+* os_mapfile_close
+* @brief  解除映射, 之前取得的数据指针全部失效
+* @param  map  映射实例
+*/
+OS_API void os_mapfile_close(os_mapfile_t ** map);
+
+/*
+* os_mapfile_data
+* @brief  获取映射的起始地址, 按页对齐
+* @param  map  映射实例
+* @return NULL/起始地址
+*/
+OS_API const void * os_mapfile_data(const os_mapfile_t * map);
+
+/*
+* os_mapfile_size
+* @brief  获取映射的字节数
+* @param  map  映射实例
+* @return 字节数
+*/
+OS_API size_t os_mapfile_size(const os_mapfile_t * map);
+
+/*
+* os_mapfile_create
+* @brief  在path所在目录创建临时文件用于写入快照, 写完后由os_mapfile_commit替换path
+* @param  path      目标文件路径
+* @param  tmp_path  返回临时文件路径, 由os_mapfile_commit释放
+* @return NULL/以二进制写入方式打开的临时文件
+*/
+OS_API FILE * os_mapfile_create(const char * path, char ** tmp_path);
+
+/*
+* os_mapfile_commit
+* @brief  关闭临时文件, ok为true时落盘后替换path, 否则删除临时文件, path保持不变;
+*         替换不截断旧文件, 映射旧文件的视图仍然有效
+* @param  fp        os_mapfile_create返回的文件
+* @param  tmp_path  os_mapfile_create返回的临时文件路径, 调用后释放
+* @param  path      目标文件路径
+* @param  ok        写入是否成功
+* @return true--已替换 false--写入、落盘或替换失败
+*/
+OS_API bool os_mapfile_commit(FILE * fp, char * tmp_path, const char * path, bool ok);
+
+OS_API_END
+
+#endif
@@ -0,0 +1,81 @@
+﻿#ifndef __OS_MEMPOOL_H__
+#define __OS_MEMPOOL_H__
+
+#include "libos.h"
+#include "os_allocator.h"
+
+typedef struct _os_mempool_t os_mempool_t;
+
+OS_API_BEGIN
+
+/*
+* os_mempool_create
+* @brief  创建定长对象池
+* @param  obj_size    对象大小
+* @param  chunk_size  单个内存块最多容纳的对象个数, 0表示使用默认值
+* @return 对象池指针或者为NULL
+*/
+OS_API os_mempool_t * os_mempool_create(size_t obj_size, size_t chunk_size);
+
+/*
+* os_mempool_create_ex
+* @brief  创建定长对象池, 对象池本身和内存块都经由allocator申请;
+*         区域式分配器(free为NULL)下清空只丢弃内存块链表, 为O(1)
+* @param  obj_size    对象大小
+* @param  chunk_size  单个内存块最多容纳的对象个数, 0表示使用默认值
+* @param  allocator   分配器, NULL表示默认分配器; 按值保存, 调用后可以释放
+* @return 对象池指针或者为NULL
+*/
+OS_API os_mempool_t * os_mempool_create_ex(size_t obj_size, size_t chunk_size, const os_allocator_t * allocator);
+
+/*
+* os_mempool_destroy
+* @brief  销毁对象池, 池中分配出的对象全部失效
+* @param  pool  指向对象池指针的指针
+*/
+OS_API void os_mempool_destroy(os_mempool_t ** pool);
+
+/*
+* os_mempool_clear
+* @brief  整块释放对象池中的全部内存
+* @param  pool  对象池指针
+*/
+OS_API void os_mempool_clear(os_mempool_t * pool);
+
+/*
+* os_mempool_alloc
+* @brief  分配一个对象, 内容未初始化
+* @param  pool  对象池指针
+* @return 对象指针或者NULL
+*/
+OS_API void * os_mempool_alloc(os_mempool_t * pool);
+
+/*
+* os_mempool_reserve
+* @brief  预留对象, 保证之后的count次os_mempool_alloc不会失败, 不足时只申请一个内存块
+* @param  pool   对象池指针
+* @param  count  对象个数
+* @return true/false
+*/
+OS_API bool os_mempool_reserve(os_mempool_t * pool, size_t count);
+
+/*
+* os_mempool_free
+* @brief  归还一个对象
+* @param  pool  对象池指针
+* @param  obj   由os_mempool_alloc分配的对象
+*/
+OS_API void os_mempool_free(os_mempool_t * pool, void * obj);
+
+/*
+* os_mempool_merge
+* @brief  将src中的全部内存块转移给dst, 之后src为空
+* @param  dst  目标对象池
+* @param  src  源对象池
+* @return true--成功 false--失败(对象大小或分配器不一致)
+*/
+OS_API bool os_mempool_merge(os_mempool_t * dst, os_mempool_t * src);
+
+OS_API_END
+
+#endif
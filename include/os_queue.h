@@ -2,10 +2,13 @@
 #define _OS_QUEUE_H_
 
 #include "libos.h"
+#include "os_stats.h"
+#include "os_allocator.h"
 #include <stdint.h>
 
 typedef struct _os_queue_t os_queue_t;
 typedef struct _os_queue_node_t os_queue_node_t;
+typedef int (*os_queue_visitor)(void * data, void * ctx);
 
 OS_API_BEGIN
 
@@ -17,6 +20,15 @@ OS_API_BEGIN
 */
 OS_API os_queue_t * os_queue_create(uint32_t elem_size);
 
+/*
+* os_queue_create_ex
+* @brief  创建队列, 队列本身和节点都经由allocator申请和释放
+* @param  elem_size  元素大小
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 区域式分配器下清空和销毁为O(1)
+* @return 队列指针或者为NULL
+*/
+OS_API os_queue_t * os_queue_create_ex(uint32_t elem_size, const os_allocator_t * allocator);
+
 /*
 * os_queue_destroy
 * @brief  销毁队列
@@ -56,6 +68,16 @@ OS_API size_t os_queue_size(os_queue_t * q);
 */
 OS_API bool os_queue_push(os_queue_t * q, void * data);
 
+/*
+* os_queue_push_n
+* @brief  向队列尾批量插入数据, 节点一次性分配, 失败时队列不变
+* @param  q      队列指针
+* @param  data   连续存放的count个元素
+* @param  count  元素个数
+* @return true--成功 false--失败
+*/
+OS_API bool os_queue_push_n(os_queue_t * q, const void * data, size_t count);
+
 /*
 * os_queue_pop
 * @brief  删除队列头
@@ -80,6 +102,25 @@ OS_API os_queue_node_t * os_queue_front(os_queue_t * q);
 */
 OS_API void * os_queue_getdata(const os_queue_node_t * node);
 
+/*
+* os_queue_stats
+* @brief  获取运行统计, 需要以OS_ENABLE_STATS编译
+* @param  q      队列指针
+* @param  stats  输出统计, 未开启统计时清零
+* @return true--成功 false--未开启统计或参数错误
+*/
+OS_API bool os_queue_stats(const os_queue_t * q, os_stats_t * stats);
+
+/*
+* os_queue_foreach
+* @brief  从队头到队尾访问每个元素, 遍历过程中不能修改队列
+* @param  q        队列指针
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_queue_foreach(const os_queue_t * q, os_queue_visitor visitor, void * ctx);
+
 OS_API_END
 
 #endif
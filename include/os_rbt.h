@@ -2,9 +2,12 @@
 #define __OS_RBT_H__
 
 #include "libos.h"
+#include "os_stats.h"
+#include "os_allocator.h"
 
 typedef struct _os_rbt_t os_rbt_t;
 typedef struct _os_rbt_node_t os_rbt_node_t;
+typedef struct _os_rbt_view_t os_rbt_view_t;
 
 OS_API_BEGIN
 
@@ -17,6 +20,14 @@ OS_API_BEGIN
 */
 typedef int(*os_rbt_compare)(const void * data1, const void * data2, size_t size);
 
+/*
+* @brief  遍历回调函数
+* @param  data  元素, 不能修改参与比较的部分
+* @param  ctx   用户数据
+* @return 0继续遍历, 非0停止遍历
+*/
+typedef int(*os_rbt_visitor)(const void * data, void * ctx);
+
 /*
 * os_rbt_create
 * @brief  创建红黑树
@@ -24,21 +35,42 @@ typedef int(*os_rbt_compare)(const void * data1, const void * data2, size_t size
 * @param  cmp  键值比较函数
 * @return NULL/实例
 */
-os_rbt_t * os_rbt_create(size_t elem_size, os_rbt_compare cmp);
+OS_API os_rbt_t * os_rbt_create(size_t elem_size, os_rbt_compare cmp);
+
+/*
+* os_rbt_create_ex
+* @brief  创建红黑树, 树本身和节点都经由allocator申请和释放
+* @param  elem_size  元素类型大小
+* @param  cmp  键值比较函数
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 区域式分配器下清空和销毁为O(1)
+* @return NULL/实例
+*/
+OS_API os_rbt_t * os_rbt_create_ex(size_t elem_size, os_rbt_compare cmp, const os_allocator_t * allocator);
+
+/*
+* os_rbt_create_concurrent
+* @brief  创建并发红黑树, 查找不加锁且不写共享缓存行, 修改操作之间互斥,
+*         被删除的节点在所有可能访问它的读者离开后才回收;
+*         修改操作(插入、删除、清空、构建)可能等待读者离开, 不能在本线程的os_rbt_read_begin/os_rbt_read_end之间调用, 否则死锁
+* @param  elem_size  元素类型大小
+* @param  cmp  键值比较函数
+* @return NULL/实例
+*/
+OS_API os_rbt_t * os_rbt_create_concurrent(size_t elem_size, os_rbt_compare cmp);
 
 /*
 * os_rbt_destroy
 * @brief  销毁红黑树
 * @param  rbt  树实例
 */
-void os_rbt_destroy(os_rbt_t ** rbt);
+OS_API void os_rbt_destroy(os_rbt_t ** rbt);
 
 /*
 * os_rbt_clear
-* @brief  清空树
+* @brief  清空树, 并发模式下等待全部读者离开后释放节点, 不能在读区间内调用
 * @param  rbt  树实例
 */
-void os_rbt_clear(os_rbt_t * rbt);
+OS_API void os_rbt_clear(os_rbt_t * rbt);
 
 /*
 * os_rbt_insert
@@ -47,7 +79,17 @@ void os_rbt_clear(os_rbt_t * rbt);
 * @param  data 要插入的数据
 * @return true/false
 */
-bool os_rbt_insert(os_rbt_t * rbt, void * data);
+OS_API bool os_rbt_insert(os_rbt_t * rbt, void * data);
+
+/*
+* os_rbt_build_sorted
+* @brief  由严格递增的数组一次性构建平衡树, 耗时O(n), 节点来自同一块连续内存; 并发模式下不能在读区间内调用
+* @param  rbt    树实例, 必须为空
+* @param  array  元素数组
+* @param  count  元素个数
+* @return true--成功 false--树非空, 数组不是严格递增或者内存不足
+*/
+OS_API bool os_rbt_build_sorted(os_rbt_t * rbt, const void * array, size_t count);
 
 /*
 * os_rbt_erase
@@ -56,16 +98,93 @@ bool os_rbt_insert(os_rbt_t * rbt, void * data);
 * @param  data 要删除的数据
 * @return true/false
 */
-bool os_rbt_erase(os_rbt_t * rbt, void * data);
+OS_API bool os_rbt_erase(os_rbt_t * rbt, const void * data);
 
 /*
 * os_rbt_find
-* @brief  查找某个节点
+* @brief  查找某个节点, 并发模式下返回的节点只在os_rbt_read_begin/os_rbt_read_end之间有效
+* @param  rbt  树实例
+* @param  data 要查找的数据
+* @return NULL/节点
+*/
+OS_API os_rbt_node_t * os_rbt_find(const os_rbt_t * rbt, const void * data);
+
+/*
+* os_rbt_find_copy
+* @brief  查找元素并复制到out, 并发模式下不需要另外进入读区间
 * @param  rbt  树实例
 * @param  data 要查找的数据
+* @param  out  输出缓冲区, 至少elem_size字节
+* @return true--找到 false--不存在
+*/
+OS_API bool os_rbt_find_copy(const os_rbt_t * rbt, const void * data, void * out);
+
+/*
+* os_rbt_read_begin
+* @brief  并发模式下进入读区间, 区间内查找得到的节点不会被回收, 非并发模式下不做任何事;
+*         区间内不能修改同一棵树
+* @param  rbt  树实例
+* @return 凭据, 传给os_rbt_read_end
+*/
+OS_API unsigned os_rbt_read_begin(const os_rbt_t * rbt);
+
+/*
+* os_rbt_read_end
+* @brief  离开读区间
+* @param  rbt     树实例
+* @param  ticket  os_rbt_read_begin返回的凭据
+*/
+OS_API void os_rbt_read_end(const os_rbt_t * rbt, unsigned ticket);
+
+/*
+* os_rbt_lower_bound
+* @brief  查找第一个不小于data的节点, 并发模式下返回的节点只在os_rbt_read_begin/os_rbt_read_end之间有效
+* @param  rbt  树实例
+* @param  data 要比较的数据
+* @return NULL/节点
+*/
+OS_API os_rbt_node_t * os_rbt_lower_bound(const os_rbt_t * rbt, const void * data);
+
+/*
+* os_rbt_upper_bound
+* @brief  查找第一个大于data的节点, 并发模式下返回的节点只在os_rbt_read_begin/os_rbt_read_end之间有效
+* @param  rbt  树实例
+* @param  data 要比较的数据
+* @return NULL/节点
+*/
+OS_API os_rbt_node_t * os_rbt_upper_bound(const os_rbt_t * rbt, const void * data);
+
+/*
+* os_rbt_first
+* @brief  获取最小节点, O(1); 并发模式下沿左链查找, 为O(log n), 返回的节点只在os_rbt_read_begin/os_rbt_read_end之间有效
+* @param  rbt  树实例
 * @return NULL/节点
 */
-os_rbt_node_t * os_rbt_find(const os_rbt_t * rbt, void * data);
+OS_API os_rbt_node_t * os_rbt_first(const os_rbt_t * rbt);
+
+/*
+* os_rbt_last
+* @brief  获取最大节点, O(1); 并发模式下沿右链查找, 为O(log n), 返回的节点只在os_rbt_read_begin/os_rbt_read_end之间有效
+* @param  rbt  树实例
+* @return NULL/节点
+*/
+OS_API os_rbt_node_t * os_rbt_last(const os_rbt_t * rbt);
+
+/*
+* os_rbt_next
+* @brief  获取中序后继节点, 并发模式下不能与修改操作同时进行
+* @param  node  节点
+* @return NULL/后继节点
+*/
+OS_API os_rbt_node_t * os_rbt_next(const os_rbt_node_t * node);
+
+/*
+* os_rbt_prev
+* @brief  获取中序前驱节点, 并发模式下不能与修改操作同时进行
+* @param  node  节点
+* @return NULL/前驱节点
+*/
+OS_API os_rbt_node_t * os_rbt_prev(const os_rbt_node_t * node);
 
 /*
 * os_rbt_data
@@ -73,7 +192,7 @@ os_rbt_node_t * os_rbt_find(const os_rbt_t * rbt, void * data);
 * @param  node  节点
 * @return NULL/val
 */
-void * os_rbt_data(const os_rbt_node_t * node);
+OS_API void * os_rbt_data(const os_rbt_node_t * node);
 
 /*
 * os_rbt_size
@@ -81,7 +200,7 @@ void * os_rbt_data(const os_rbt_node_t * node);
 * @param  rbt  树实例
 * @return 元素个数
 */
-size_t os_rbt_size(const os_rbt_t * rbt);
+OS_API size_t os_rbt_size(const os_rbt_t * rbt);
 
 /*
 * os_rbt_empty
@@ -89,7 +208,124 @@ size_t os_rbt_size(const os_rbt_t * rbt);
 * @param  rbt  树实例
 * @return true/false
 */
-bool os_rbt_empty(const os_rbt_t * rbt);
+OS_API bool os_rbt_empty(const os_rbt_t * rbt);
+
+/*
+* os_rbt_foreach
+* @brief  按键值从小到大访问每个元素, 同os_rbt_range(rbt, NULL, NULL, visitor, ctx)
+* @param  rbt      树实例
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_rbt_foreach(const os_rbt_t * rbt, os_rbt_visitor visitor, void * ctx);
+
+/*
+* os_rbt_range
+* @brief  按键值从小到大访问[lo, hi)内的元素, 访问k个元素耗时O(log n + k), 遍历过程中不能修改树;
+*         并发模式下不加锁也不阻塞写者, 每一步查找上一个元素的后继, 耗时O(k log n),
+*         visitor拿到的是元素的副本, 可以修改树, 遍历期间插入或删除的元素可能访问到也可能访问不到
+* @param  rbt      树实例
+* @param  lo       下界(包含), NULL表示从最小元素开始
+* @param  hi       上界(不包含), NULL表示到最大元素为止
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_rbt_range(const os_rbt_t * rbt, const void * lo, const void * hi, os_rbt_visitor visitor, void * ctx);
+
+/*
+* os_rbt_stats
+* @brief  获取运行统计, 需要以OS_ENABLE_STATS编译; search_depth/searches为平均查找深度,
+*         并发模式下无锁读者的查找不计入
+* @param  rbt    树实例
+* @param  stats  输出统计, 未开启统计时清零
+* @return true--成功 false--未开启统计或参数错误
+*/
+OS_API bool os_rbt_stats(const os_rbt_t * rbt, os_stats_t * stats);
+
+/*
+* os_rbt_save
+* @brief  按键值从小到大把全部元素写入快照文件, 文件不含指针, 可由os_rbt_map原地映射;
+*         元素按字节原样保存, 元素中含有指针时映射后不可用
+* @param  rbt   树实例
+* @param  path  文件路径, 已存在时整体替换; 先写入同目录下的临时文件, 已映射旧文件的快照仍然有效
+* @return true/false, 失败时原文件保持不变
+*/
+OS_API bool os_rbt_save(const os_rbt_t * rbt, const char * path);
+
+/*
+* os_rbt_map
+* @brief  以只读方式映射快照文件, 只校验文件头, 耗时与元素个数无关, 页面在查询时按需载入
+* @param  path       文件路径
+* @param  elem_size  元素类型大小, 必须与保存时一致
+* @param  cmp        键值比较函数, 顺序必须与保存时一致
+* @return NULL/快照实例
+*/
+OS_API os_rbt_view_t * os_rbt_map(const char * path, size_t elem_size, os_rbt_compare cmp);
+
+/*
+* os_rbt_unmap
+* @brief  解除快照映射, 之前取得的元素指针全部失效
+* @param  view  快照实例
+*/
+OS_API void os_rbt_unmap(os_rbt_view_t ** view);
+
+/*
+* os_rbt_view_find
+* @brief  在快照中查找元素, 二分查找耗时O(log n)
+* @param  view  快照实例
+* @param  data  要查找的数据
+* @return NULL/只读元素
+*/
+OS_API const void * os_rbt_view_find(const os_rbt_view_t * view, const void * data);
+
+/*
+* os_rbt_view_lower_bound
+* @brief  查找快照中第一个不小于data的元素
+* @param  view  快照实例
+* @param  data  要比较的数据
+* @return NULL/只读元素
+*/
+OS_API const void * os_rbt_view_lower_bound(const os_rbt_view_t * view, const void * data);
+
+/*
+* os_rbt_view_upper_bound
+* @brief  查找快照中第一个大于data的元素
+* @param  view  快照实例
+* @param  data  要比较的数据
+* @return NULL/只读元素
+*/
+OS_API const void * os_rbt_view_upper_bound(const os_rbt_view_t * view, const void * data);
+
+/*
+* os_rbt_view_at
+* @brief  获取快照中第index小的元素, O(1)
+* @param  view   快照实例
+* @param  index  下标, 从0开始
+* @return NULL/只读元素
+*/
+OS_API const void * os_rbt_view_at(const os_rbt_view_t * view, size_t index);
+
+/*
+* os_rbt_view_size
+* @brief  获取快照元素个数
+* @param  view  快照实例
+* @return 元素个数
+*/
+OS_API size_t os_rbt_view_size(const os_rbt_view_t * view);
+
+/*
+* os_rbt_view_range
+* @brief  按键值从小到大访问快照中[lo, hi)内的元素
+* @param  view     快照实例
+* @param  lo       下界(包含), NULL表示从最小元素开始
+* @param  hi       上界(不包含), NULL表示到最大元素为止
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_rbt_view_range(const os_rbt_view_t * view, const void * lo, const void * hi, os_rbt_visitor visitor, void * ctx);
 
 OS_API_END
 
@@ -0,0 +1,146 @@
+﻿#ifndef __OS_SEQUENCE_H__
+#define __OS_SEQUENCE_H__
+
+#include "libos.h"
+#include "os_allocator.h"
+
+typedef struct _os_seq_t os_seq_t;
+typedef struct _os_seq_leaf_t os_seq_leaf_t;
+
+// 顺序游标, 序列插入或删除后失效
+typedef struct _os_seq_cursor_t {
+    const os_seq_t * seq;    // 所属序列
+    os_seq_leaf_t * leaf;    // 当前叶子, NULL表示越界
+    size_t index;            // 叶子内的下标
+} os_seq_cursor_t;
+
+OS_API_BEGIN
+
+/*
+* os_seq_create
+* @brief  创建序列, 按位置插入删除和随机访问均为O(log n)
+* @param  elem_size  元素大小
+* @return 序列指针或者为NULL
+*/
+OS_API os_seq_t * os_seq_create(size_t elem_size);
+
+/*
+* os_seq_create_ex
+* @brief  创建序列, 序列本身和叶子、内部节点都经由allocator申请和释放
+* @param  elem_size  元素大小
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 区域式分配器下清空和销毁为O(1)
+* @return 序列指针或者为NULL
+*/
+OS_API os_seq_t * os_seq_create_ex(size_t elem_size, const os_allocator_t * allocator);
+
+/*
+* os_seq_destroy
+* @brief  销毁序列
+* @param  seq  指向序列指针的指针
+*/
+OS_API void os_seq_destroy(os_seq_t ** seq);
+
+/*
+* os_seq_clear
+* @brief  清空序列
+* @param  seq  序列指针
+*/
+OS_API void os_seq_clear(os_seq_t * seq);
+
+/*
+* os_seq_empty
+* @brief  判断序列是否为空
+* @param  seq  序列指针
+* @return true--为空 false--不为空
+*/
+OS_API bool os_seq_empty(const os_seq_t * seq);
+
+/*
+* os_seq_size
+* @brief  获取序列长度
+* @param  seq  序列指针
+* @return 序列长度
+*/
+OS_API size_t os_seq_size(const os_seq_t * seq);
+
+/*
+* os_seq_add
+* @brief  向序列尾部添加数据
+* @param  seq   序列指针
+* @param  data  数据
+* @return true--成功 false--失败
+*/
+OS_API bool os_seq_add(os_seq_t * seq, const void * data);
+
+/*
+* os_seq_insert
+* @brief  向序列指定位置插入数据, 插入后数据位于pos
+* @param  seq   序列指针
+* @param  pos   位置, 不小于序列长度时添加到尾部
+* @param  data  数据
+* @return true--成功 false--失败
+*/
+OS_API bool os_seq_insert(os_seq_t * seq, size_t pos, const void * data);
+
+/*
+* os_seq_erase
+* @brief  删除指定位置的数据
+* @param  seq  序列指针
+* @param  pos  位置
+* @return true--成功 false--位置越界
+*/
+OS_API bool os_seq_erase(os_seq_t * seq, size_t pos);
+
+/*
+* os_seq_at
+* @brief  获取指定位置的数据指针, 序列插入或删除后失效
+* @param  seq  序列指针
+* @param  pos  位置
+* @return 数据指针或者NULL
+*/
+OS_API void * os_seq_at(const os_seq_t * seq, size_t pos);
+
+/*
+* os_seq_cursor
+* @brief  获取指向指定位置的游标
+* @param  seq  序列指针
+* @param  pos  位置, 越界时返回无效游标
+* @return 游标
+*/
+OS_API os_seq_cursor_t os_seq_cursor(const os_seq_t * seq, size_t pos);
+
+/*
+* os_seq_cursor_valid
+* @brief  判断游标是否指向数据
+* @param  cur  游标指针
+* @return true/false
+*/
+OS_API bool os_seq_cursor_valid(const os_seq_cursor_t * cur);
+
+/*
+* os_seq_cursor_get
+* @brief  获取游标处的数据指针
+* @param  cur  游标指针
+* @return 数据指针或者NULL
+*/
+OS_API void * os_seq_cursor_get(const os_seq_cursor_t * cur);
+
+/*
+* os_seq_cursor_next
+* @brief  游标后移一个位置, 越过尾部后游标无效
+* @param  cur  游标指针
+* @return true--游标有效 false--已越界
+*/
+OS_API bool os_seq_cursor_next(os_seq_cursor_t * cur);
+
+/*
+* os_seq_cursor_prev
+* @brief  游标前移一个位置, 越过头部后游标无效
+* @param  cur  游标指针
+* @return true--游标有效 false--已越界
+*/
+OS_API bool os_seq_cursor_prev(os_seq_cursor_t * cur);
+
+OS_API_END
+
+#endif
@@ -2,10 +2,14 @@
 #define _OS_SINGLE_LIST_H_
 
 #include "libos.h"
+#include "os_stats.h"
+#include "os_allocator.h"
 
 typedef struct _os_slist_t os_slist_t;
 typedef struct _os_slist_node_t os_slist_node_t;
 typedef bool (*os_slist_compare)(const void * data1, const void * data2);
+typedef bool (*os_slist_predicate)(const void * data, void * ctx);
+typedef int (*os_slist_visitor)(void * data, void * ctx);
 
 OS_API_BEGIN
 
@@ -17,6 +21,24 @@ OS_API_BEGIN
 */
 OS_API os_slist_t * os_slist_create(const size_t elem_size);
 
+/*
+* os_slist_create_pool
+* @brief  创建链表并指定节点池内存块大小
+* @param  elem_size   节点大小
+* @param  chunk_size  每个内存块容纳的节点个数, 0表示使用默认值
+* @return 链表指针或者为NULL
+*/
+OS_API os_slist_t * os_slist_create_pool(const size_t elem_size, const size_t chunk_size);
+
+/*
+* os_slist_create_ex
+* @brief  创建链表, 链表本身和节点都经由allocator申请和释放
+* @param  elem_size  节点大小
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 区域式分配器下清空和销毁为O(1)
+* @return 链表指针或者为NULL
+*/
+OS_API os_slist_t * os_slist_create_ex(const size_t elem_size, const os_allocator_t * allocator);
+
 /*
 * os_slist_destroy
 * @brief  销毁链表
@@ -56,6 +78,16 @@ OS_API size_t os_slist_size(const os_slist_t * lst);
 */
 OS_API bool os_slist_add(os_slist_t * lst, void * data);
 
+/*
+* os_slist_add_n
+* @brief  向链表尾部批量添加数据, 节点一次性分配, 失败时链表不变
+* @param  lst    链表指针
+* @param  data   连续存放的count个元素
+* @param  count  元素个数
+* @return true--成功 false--失败
+*/
+OS_API bool os_slist_add_n(os_slist_t * lst, const void * data, size_t count);
+
 /*
 * os_slist_insert
 * @brief  向链表指定位置插入数据
@@ -85,6 +117,25 @@ OS_API os_slist_node_t * os_slist_delete(os_slist_t * lst, os_slist_node_t * nod
 */
 OS_API bool os_slist_delete_ex(os_slist_t * lst, void * data, os_slist_compare compare);
 
+/*
+* os_slist_remove_if
+* @brief  一次遍历删除所有满足条件的节点
+* @param  lst      链表指针
+* @param  pred     删除条件, 返回true的节点被删除
+* @param  ctx      传给pred的用户数据
+* @param  removed  非NULL时被删除的节点按原顺序串成链返回, 由调用者用os_slist_free_nodes释放; NULL表示直接释放
+* @return 删除的节点个数
+*/
+OS_API size_t os_slist_remove_if(os_slist_t * lst, os_slist_predicate pred, void * ctx, os_slist_node_t ** removed);
+
+/*
+* os_slist_free_nodes
+* @brief  释放os_slist_remove_if返回的节点链
+* @param  lst    链表指针
+* @param  nodes  节点链头
+*/
+OS_API void os_slist_free_nodes(os_slist_t * lst, os_slist_node_t * nodes);
+
 /*
 * os_slist_head
 * @brief  获取链表头节点
@@ -119,14 +170,42 @@ OS_API os_slist_t * os_slist_reverse_order(os_slist_t * lst);
 
 /*
 * os_slist_merge
-* @brief  合并链表
+* @brief  合并链表, lst2的节点转移到lst1中, 合并后lst2为空
 * @param  lst1  链表1
 * @param  lst2  链表2
 * @param  compare 自实现data1与data2比较函数
-* @return 合并后的链表
+* @return 合并后的链表, 两个链表的分配器不同时返回NULL
 */
 OS_API os_slist_t * os_slist_merge(os_slist_t * lst1, os_slist_t * lst2, os_slist_compare compare);
 
+/*
+* os_slist_sort
+* @brief  稳定排序, 原地重新链接节点, 不申请内存
+* @param  lst      链表指针
+* @param  compare  data1小于data2时返回true
+* @return true--成功 false--参数错误
+*/
+OS_API bool os_slist_sort(os_slist_t * lst, os_slist_compare compare);
+
+/*
+* os_slist_stats
+* @brief  获取运行统计, 需要以OS_ENABLE_STATS编译
+* @param  lst    链表指针
+* @param  stats  输出统计, 未开启统计时清零
+* @return true--成功 false--未开启统计或参数错误
+*/
+OS_API bool os_slist_stats(const os_slist_t * lst, os_stats_t * stats);
+
+/*
+* os_slist_foreach
+* @brief  从头到尾访问每个元素, 遍历过程中不能修改链表
+* @param  lst      链表指针
+* @param  visitor  访问函数, 返回非0时停止遍历
+* @param  ctx      传给visitor的用户数据
+* @return 0--遍历完成 其他--visitor的返回值
+*/
+OS_API int os_slist_foreach(const os_slist_t * lst, os_slist_visitor visitor, void * ctx);
+
 OS_API_END
 
 #endif
@@ -0,0 +1,101 @@
+﻿#ifndef __OS_SPSC_QUEUE_H__
+#define __OS_SPSC_QUEUE_H__
+
+#include "libos.h"
+#include "os_allocator.h"
+
+typedef struct _os_spsc_queue_t os_spsc_queue_t;
+
+OS_API_BEGIN
+
+/*
+* os_spsc_queue_create
+* @brief  创建单生产者单消费者无锁环形队列
+* @param  elem_size  元素大小
+* @param  capacity   容量, 向上取整为2的幂
+* @return 队列指针或者为NULL
+*/
+OS_API os_spsc_queue_t * os_spsc_queue_create(size_t elem_size, size_t capacity);
+
+/*
+* os_spsc_queue_create_ex
+* @brief  创建单生产者单消费者无锁环形队列, 队列本身和元素数组经由allocator申请和释放
+* @param  elem_size  元素大小
+* @param  capacity   容量, 向上取整为2的幂
+* @param  allocator  分配器, NULL表示默认分配器; 按值保存, 只在创建和销毁时调用
+* @return 队列指针或者为NULL
+*/
+OS_API os_spsc_queue_t * os_spsc_queue_create_ex(size_t elem_size, size_t capacity, const os_allocator_t * allocator);
+
+/*
+* os_spsc_queue_destroy
+* @brief  销毁队列, 调用时不能有线程在使用队列
+* @param  q  指向队列指针的指针
+*/
+OS_API void os_spsc_queue_destroy(os_spsc_queue_t ** q);
+
+/*
+* os_spsc_queue_capacity
+* @brief  获取队列容量
+* @param  q  队列指针
+* @return 队列容量
+*/
+OS_API size_t os_spsc_queue_capacity(const os_spsc_queue_t * q);
+
+/*
+* os_spsc_queue_size
+* @brief  获取队列长度, 并发时仅为近似值
+* @param  q  队列指针
+* @return 队列长度
+*/
+OS_API size_t os_spsc_queue_size(os_spsc_queue_t * q);
+
+/*
+* os_spsc_queue_empty
+* @brief  判断队列是否为空, 并发时仅为近似值
+* @param  q  队列指针
+* @return true--空 false--非空
+*/
+OS_API bool os_spsc_queue_empty(os_spsc_queue_t * q);
+
+/*
+* os_spsc_queue_try_push
+* @brief  插入数据, 只能由生产者线程调用
+* @param  q     队列指针
+* @param  data  数据指针
+* @return true--成功 false--队列已满
+*/
+OS_API bool os_spsc_queue_try_push(os_spsc_queue_t * q, const void * data);
+
+/*
+* os_spsc_queue_try_pop
+* @brief  取出队列头数据, 只能由消费者线程调用
+* @param  q     队列指针
+* @param  data  接收数据的缓冲区
+* @return true--成功 false--队列为空
+*/
+OS_API bool os_spsc_queue_try_pop(os_spsc_queue_t * q, void * data);
+
+/*
+* os_spsc_queue_push_n
+* @brief  批量插入数据, 只发布一次尾部位置, 只能由生产者线程调用
+* @param  q     队列指针
+* @param  data  连续存放的元素数组
+* @param  n     元素个数
+* @return 实际插入的元素个数
+*/
+OS_API size_t os_spsc_queue_push_n(os_spsc_queue_t * q, const void * data, size_t n);
+
+/*
+* os_spsc_queue_pop_n
+* @brief  批量取出数据, 只发布一次头部位置, 只能由消费者线程调用
+* @param  q     队列指针
+* @param  data  接收数据的数组, 至少容纳n个元素
+* @param  n     最多取出的元素个数
+* @return 实际取出的元素个数
+*/
+OS_API size_t os_spsc_queue_pop_n(os_spsc_queue_t * q, void * data, size_t n);
+
+OS_API_END
+
+#endif
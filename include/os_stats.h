@@ -0,0 +1,114 @@
+﻿#ifndef __OS_STATS_H__
+#define __OS_STATS_H__
+
+#include "libos.h"
+
+// 容器运行统计, 由CMake选项OS_ENABLE_STATS开启;
+// 关闭时容器中没有统计字段, 统计宏展开为空语句, os_*_stats返回false;
+// 查找等只读接口也累计计数, 可能被多个线程同时调用, 因此OS_STATS_ADD是松弛的原子加,
+// 其余统计只在修改接口中更新, 由容器本身的互斥约定保护
+
+typedef struct _os_stats_t {
+    size_t allocs;          // 内存分配次数, 包括容器本身
+    size_t frees;           // 内存释放次数
+    size_t live_bytes;      // 当前占用的字节数, 按容器结构和节点(块)大小计算, 不含内存池未使用的部分
+    size_t peak_bytes;      // 占用字节数的峰值
+    size_t peak_size;       // 元素个数的峰值
+    size_t compares;        // 比较或判断回调的调用次数
+    size_t searches;        // 按键查找次数(os_rbt)
+    size_t search_depth;    // 查找经过的节点总数, 除以searches即平均查找深度(os_rbt)
+    size_t scan_steps;      // 线性扫描经过的节点或块数(链表按节点或按位置删除, 按位置定位)
+} os_stats_t;
+
+#if defined(OS_ENABLE_STATS)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+static inline void os_stats_add(size_t * field, size_t n)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_fetch_add(field, n, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    _InterlockedExchangeAdd64((volatile __int64 *)field, (__int64)n);
+#elif defined(_MSC_VER)
+    _InterlockedExchangeAdd((volatile long *)field, (long)n);
+#else
+    *field += n;
+#endif
+}
+
+// 逐个字段原子读取, 与只读接口中的OS_STATS_ADD并发时也能得到完整的值
+static inline void os_stats_load(os_stats_t * dst, const os_stats_t * src)
+{
+    const size_t * from = (const size_t *)src;
+    size_t * to = (size_t *)dst;
+    for (size_t i = 0u; i < sizeof(os_stats_t) / sizeof(size_t); ++i) {
+#if defined(__GNUC__) || defined(__clang__)
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+#else
+        to[i] = *(const volatile size_t *)&from[i];
+#endif
+    }
+}
+
+static inline void os_stats_alloc(os_stats_t * stats, size_t count, size_t bytes)
+{
+    stats->allocs += count;
+    stats->live_bytes += bytes;
+    if (stats->live_bytes > stats->peak_bytes)
+        stats->peak_bytes = stats->live_bytes;
+}
+
+static inline void os_stats_free(os_stats_t * stats, size_t count, size_t bytes)
+{
+    stats->frees += count;
+    stats->live_bytes -= bytes;
+}
+
+// 整体释放全部节点, 只保留keep_bytes(容器本身等), 节点大小相同
+static inline void os_stats_release(os_stats_t * stats, size_t keep_bytes, size_t node_bytes)
+{
+    stats->frees += (stats->live_bytes - keep_bytes) / node_bytes;
+    stats->live_bytes = keep_bytes;
+}
+
+// 节点连同内存整体从src转移到dst, src只保留keep_bytes; 对src记为释放, 对dst记为分配
+static inline void os_stats_move(os_stats_t * dst, os_stats_t * src, size_t keep_bytes, size_t node_bytes)
+{
+    size_t count = (src->live_bytes - keep_bytes) / node_bytes;
+    src->frees += count;
+    dst->allocs += count;
+    dst->live_bytes += src->live_bytes - keep_bytes;
+    if (dst->live_bytes > dst->peak_bytes)
+        dst->peak_bytes = dst->live_bytes;
+    src->live_bytes = keep_bytes;
+}
+
+static inline void os_stats_size(os_stats_t * stats, size_t size)
+{
+    if (size > stats->peak_size)
+        stats->peak_size = size;
+}
+
+#define OS_STATS_ALLOC(stats, count, bytes)             os_stats_alloc(&(stats), (count), (bytes))
+#define OS_STATS_FREE(stats, count, bytes)              os_stats_free(&(stats), (count), (bytes))
+#define OS_STATS_RELEASE(stats, keep_bytes, node_bytes) os_stats_release(&(stats), (keep_bytes), (node_bytes))
+#define OS_STATS_MOVE(dst, src, keep_bytes, node_bytes) os_stats_move(&(dst), &(src), (keep_bytes), (node_bytes))
+#define OS_STATS_SIZE(stats, size)                      os_stats_size(&(stats), (size))
+#define OS_STATS_ADD(stats, field, n)                   os_stats_add(&(stats).field, (size_t)(n))
+
+#else
+
+// 参数不会被求值, 可以引用关闭时不存在的字段
+#define OS_STATS_ALLOC(stats, count, bytes)             ((void)0)
+#define OS_STATS_FREE(stats, count, bytes)              ((void)0)
+#define OS_STATS_RELEASE(stats, keep_bytes, node_bytes) ((void)0)
+#define OS_STATS_MOVE(dst, src, keep_bytes, node_bytes) ((void)0)
+#define OS_STATS_SIZE(stats, size)                      ((void)0)
+#define OS_STATS_ADD(stats, field, n)                   ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,818 @@
+﻿#ifndef __OS_TYPED_H__
+#define __OS_TYPED_H__
+
+#include "libos.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// 类型化容器生成宏: 在调用处展开为static inline函数, 元素按类型赋值, 比较在编译期内联,
+// 不再经过elem_size的memcpy和cmp函数指针. 与os_slist/os_dlist/os_queue/os_rbt的void*接口相互独立
+//
+//     OS_DEFINE_SLIST(int_slist, int)
+//     int_slist_t lst;
+//     int_slist_init(&lst);
+//     int_slist_add(&lst, 1);
+//     int_slist_clear(&lst);
+//
+// 节点默认用malloc/free申请, 包含本头文件前定义OS_TYPED_MALLOC/OS_TYPED_FREE可以替换
+
+#ifndef OS_TYPED_MALLOC
+#define OS_TYPED_MALLOC(size) malloc(size)
+#endif
+
+#ifndef OS_TYPED_FREE
+#define OS_TYPED_FREE(ptr) free(ptr)
+#endif
+
+/*
+* OS_DEFINE_SLIST
+* @brief  生成单链表name_t及其节点name_node_t
+*         init clear empty size add push_front pop_front head next data foreach
+* @param  name  类型和函数名前缀
+* @param  T     元素类型
+*/
+#define OS_DEFINE_SLIST(name, T) \
+typedef struct name##_node_t name##_node_t; \
+struct name##_node_t { \
+    name##_node_t * next; \
+    T data; \
+}; \
+typedef struct name##_t { \
+    size_t size; \
+    name##_node_t * head; \
+    name##_node_t * tail; \
+} name##_t; \
+static inline void name##_init(name##_t * lst) \
+{ \
+    lst->size = 0u; \
+    lst->head = NULL; \
+    lst->tail = NULL; \
+} \
+static inline void name##_clear(name##_t * lst) \
+{ \
+    name##_node_t * node = lst->head; \
+    while (NULL != node) { \
+        name##_node_t * next = node->next; \
+        OS_TYPED_FREE(node); \
+        node = next; \
+    } \
+    name##_init(lst); \
+} \
+static inline bool name##_empty(const name##_t * lst) \
+{ \
+    return 0u == lst->size; \
+} \
+static inline size_t name##_size(const name##_t * lst) \
+{ \
+    return lst->size; \
+} \
+static inline bool name##_add(name##_t * lst, T value) \
+{ \
+    name##_node_t * node = (name##_node_t *)OS_TYPED_MALLOC(sizeof(name##_node_t)); \
+    if (NULL == node) \
+        return false; \
+    node->next = NULL; \
+    node->data = value; \
+    if (NULL == lst->tail) \
+        lst->head = node; \
+    else \
+        lst->tail->next = node; \
+    lst->tail = node; \
+    ++lst->size; \
+    return true; \
+} \
+static inline bool name##_push_front(name##_t * lst, T value) \
+{ \
+    name##_node_t * node = (name##_node_t *)OS_TYPED_MALLOC(sizeof(name##_node_t)); \
+    if (NULL == node) \
+        return false; \
+    node->next = lst->head; \
+    node->data = value; \
+    lst->head = node; \
+    if (NULL == lst->tail) \
+        lst->tail = node; \
+    ++lst->size; \
+    return true; \
+} \
+static inline bool name##_pop_front(name##_t * lst, T * out) \
+{ \
+    name##_node_t * node = lst->head; \
+    if (NULL == node) \
+        return false; \
+    if (NULL != out) \
+        *out = node->data; \
+    lst->head = node->next; \
+    if (NULL == lst->head) \
+        lst->tail = NULL; \
+    --lst->size; \
+    OS_TYPED_FREE(node); \
+    return true; \
+} \
+static inline name##_node_t * name##_head(const name##_t * lst) \
+{ \
+    return lst->head; \
+} \
+static inline name##_node_t * name##_next(const name##_node_t * node) \
+{ \
+    return node->next; \
+} \
+static inline T * name##_data(name##_node_t * node) \
+{ \
+    return &node->data; \
+} \
+static inline int name##_foreach(const name##_t * lst, int (*visitor)(T * data, void * ctx), void * ctx) \
+{ \
+    for (name##_node_t * node = lst->head; NULL != node; ) { \
+        name##_node_t * next = node->next; \
+        if (NULL != next) \
+            OS_PREFETCH(next->next); \
+        int ret = visitor(&node->data, ctx); \
+        if (0 != ret) \
+            return ret; \
+        node = next; \
+    } \
+    return 0; \
+}
+
+/*
+* OS_DEFINE_DLIST
+* @brief  生成双链表name_t及其节点name_node_t
+*         init clear empty size add push_front pop_front pop_back erase head tail next prev data
+*         foreach foreach_reverse
+* @param  name  类型和函数名前缀
+* @param  T     元素类型
+*/
+#define OS_DEFINE_DLIST(name, T) \
+typedef struct name##_node_t name##_node_t; \
+struct name##_node_t { \
+    name##_node_t * next; \
+    name##_node_t * prev; \
+    T data; \
+}; \
+typedef struct name##_t { \
+    size_t size; \
+    name##_node_t * head; \
+    name##_node_t * tail; \
+} name##_t; \
+static inline void name##_init(name##_t * lst) \
+{ \
+    lst->size = 0u; \
+    lst->head = NULL; \
+    lst->tail = NULL; \
+} \
+static inline void name##_clear(name##_t * lst) \
+{ \
+    name##_node_t * node = lst->head; \
+    while (NULL != node) { \
+        name##_node_t * next = node->next; \
+        OS_TYPED_FREE(node); \
+        node = next; \
+    } \
+    name##_init(lst); \
+} \
+static inline bool name##_empty(const name##_t * lst) \
+{ \
+    return 0u == lst->size; \
+} \
+static inline size_t name##_size(const name##_t * lst) \
+{ \
+    return lst->size; \
+} \
+static inline bool name##_add(name##_t * lst, T value) \
+{ \
+    name##_node_t * node = (name##_node_t *)OS_TYPED_MALLOC(sizeof(name##_node_t)); \
+    if (NULL == node) \
+        return false; \
+    node->next = NULL; \
+    node->prev = lst->tail; \
+    node->data = value; \
+    if (NULL == lst->tail) \
+        lst->head = node; \
+    else \
+        lst->tail->next = node; \
+    lst->tail = node; \
+    ++lst->size; \
+    return true; \
+} \
+static inline bool name##_push_front(name##_t * lst, T value) \
+{ \
+    name##_node_t * node = (name##_node_t *)OS_TYPED_MALLOC(sizeof(name##_node_t)); \
+    if (NULL == node) \
+        return false; \
+    node->next = lst->head; \
+    node->prev = NULL; \
+    node->data = value; \
+    if (NULL == lst->head) \
+        lst->tail = node; \
+    else \
+        lst->head->prev = node; \
+    lst->head = node; \
+    ++lst->size; \
+    return true; \
+} \
+static inline name##_node_t * name##_erase(name##_t * lst, name##_node_t * node) \
+{ \
+    name##_node_t * next = node->next; \
+    if (NULL == node->prev) \
+        lst->head = next; \
+    else \
+        node->prev->next = next; \
+    if (NULL == next) \
+        lst->tail = node->prev; \
+    else \
+        next->prev = node->prev; \
+    --lst->size; \
+    OS_TYPED_FREE(node); \
+    return next; \
+} \
+static inline bool name##_pop_front(name##_t * lst, T * out) \
+{ \
+    if (NULL == lst->head) \
+        return false; \
+    if (NULL != out) \
+        *out = lst->head->data; \
+    name##_erase(lst, lst->head); \
+    return true; \
+} \
+static inline bool name##_pop_back(name##_t * lst, T * out) \
+{ \
+    if (NULL == lst->tail) \
+        return false; \
+    if (NULL != out) \
+        *out = lst->tail->data; \
+    name##_erase(lst, lst->tail); \
+    return true; \
+} \
+static inline name##_node_t * name##_head(const name##_t * lst) \
+{ \
+    return lst->head; \
+} \
+static inline name##_node_t * name##_tail(const name##_t * lst) \
+{ \
+    return lst->tail; \
+} \
+static inline name##_node_t * name##_next(const name##_node_t * node) \
+{ \
+    return node->next; \
+} \
+static inline name##_node_t * name##_prev(const name##_node_t * node) \
+{ \
+    return node->prev; \
+} \
+static inline T * name##_data(name##_node_t * node) \
+{ \
+    return &node->data; \
+} \
+static inline int name##_foreach(const name##_t * lst, int (*visitor)(T * data, void * ctx), void * ctx) \
+{ \
+    for (name##_node_t * node = lst->head; NULL != node; ) { \
+        name##_node_t * next = node->next; \
+        if (NULL != next) \
+            OS_PREFETCH(next->next); \
+        int ret = visitor(&node->data, ctx); \
+        if (0 != ret) \
+            return ret; \
+        node = next; \
+    } \
+    return 0; \
+} \
+static inline int name##_foreach_reverse(const name##_t * lst, int (*visitor)(T * data, void * ctx), void * ctx) \
+{ \
+    for (name##_node_t * node = lst->tail; NULL != node; ) { \
+        name##_node_t * prev = node->prev; \
+        if (NULL != prev) \
+            OS_PREFETCH(prev->prev); \
+        int ret = visitor(&node->data, ctx); \
+        if (0 != ret) \
+            return ret; \
+        node = prev; \
+    } \
+    return 0; \
+}
+
+/*
+* OS_DEFINE_QUEUE
+* @brief  生成先进先出队列name_t
+*         init clear empty size push pop front foreach
+* @param  name  类型和函数名前缀
+* @param  T     元素类型
+*/
+#define OS_DEFINE_QUEUE(name, T) \
+typedef struct name##_node_t name##_node_t; \
+struct name##_node_t { \
+    name##_node_t * next; \
+    T data; \
+}; \
+typedef struct name##_t { \
+    size_t size; \
+    name##_node_t * head; \
+    name##_node_t * tail; \
+} name##_t; \
+static inline void name##_init(name##_t * q) \
+{ \
+    q->size = 0u; \
+    q->head = NULL; \
+    q->tail = NULL; \
+} \
+static inline void name##_clear(name##_t * q) \
+{ \
+    name##_node_t * node = q->head; \
+    while (NULL != node) { \
+        name##_node_t * next = node->next; \
+        OS_TYPED_FREE(node); \
+        node = next; \
+    } \
+    name##_init(q); \
+} \
+static inline bool name##_empty(const name##_t * q) \
+{ \
+    return 0u == q->size; \
+} \
+static inline size_t name##_size(const name##_t * q) \
+{ \
+    return q->size; \
+} \
+static inline bool name##_push(name##_t * q, T value) \
+{ \
+    name##_node_t * node = (name##_node_t *)OS_TYPED_MALLOC(sizeof(name##_node_t)); \
+    if (NULL == node) \
+        return false; \
+    node->next = NULL; \
+    node->data = value; \
+    if (NULL == q->tail) \
+        q->head = node; \
+    else \
+        q->tail->next = node; \
+    q->tail = node; \
+    ++q->size; \
+    return true; \
+} \
+static inline bool name##_pop(name##_t * q, T * out) \
+{ \
+    name##_node_t * node = q->head; \
+    if (NULL == node) \
+        return false; \
+    if (NULL != out) \
+        *out = node->data; \
+    q->head = node->next; \
+    if (NULL == q->head) \
+        q->tail = NULL; \
+    --q->size; \
+    OS_TYPED_FREE(node); \
+    return true; \
+} \
+static inline T * name##_front(const name##_t * q) \
+{ \
+    return NULL == q->head ? NULL : &q->head->data; \
+} \
+static inline int name##_foreach(const name##_t * q, int (*visitor)(T * data, void * ctx), void * ctx) \
+{ \
+    for (name##_node_t * node = q->head; NULL != node; ) { \
+        name##_node_t * next = node->next; \
+        if (NULL != next) \
+            OS_PREFETCH(next->next); \
+        int ret = visitor(&node->data, ctx); \
+        if (0 != ret) \
+            return ret; \
+        node = next; \
+    } \
+    return 0; \
+}
+
+// 红黑树的平衡操作与元素类型无关, 由各个类型化红黑树共用; 颜色存放在父节点指针的最低位
+#define OS_TYPED_RBT_RED    0u
+#define OS_TYPED_RBT_BLACK  1u
+
+typedef struct _os_typed_rbt_link_t os_typed_rbt_link_t;
+
+struct _os_typed_rbt_link_t {
+    uintptr_t parent_color;        // 父节点指针 | 颜色
+    os_typed_rbt_link_t * left;    // 左孩子
+    os_typed_rbt_link_t * right;   // 右孩子
+};
+
+OS_API_BEGIN
+
+static inline os_typed_rbt_link_t * os_typed_rbt_parent(const os_typed_rbt_link_t * link)
+{
+    return (os_typed_rbt_link_t *)(link->parent_color & ~(uintptr_t)1u);
+}
+
+static inline bool os_typed_rbt_is_red(const os_typed_rbt_link_t * link)
+{
+    return NULL != link && OS_TYPED_RBT_RED == (link->parent_color & 1u);
+}
+
+static inline void os_typed_rbt_set_parent(os_typed_rbt_link_t * link, os_typed_rbt_link_t * parent)
+{
+    link->parent_color = (uintptr_t)parent | (link->parent_color & 1u);
+}
+
+static inline void os_typed_rbt_set_color(os_typed_rbt_link_t * link, uintptr_t color)
+{
+    link->parent_color = (link->parent_color & ~(uintptr_t)1u) | color;
+}
+
+static inline void os_typed_rbt_left_rotate(os_typed_rbt_link_t ** root, os_typed_rbt_link_t * link)
+{
+    os_typed_rbt_link_t * right = link->right;
+    os_typed_rbt_link_t * parent = os_typed_rbt_parent(link);
+    link->right = right->left;
+    if (NULL != right->left)
+        os_typed_rbt_set_parent(right->left, link);
+    os_typed_rbt_set_parent(right, parent);
+    if (NULL == parent)
+        *root = right;
+    else if (link == parent->left)
+        parent->left = right;
+    else
+        parent->right = right;
+    right->left = link;
+    os_typed_rbt_set_parent(link, right);
+}
+
+static inline void os_typed_rbt_right_rotate(os_typed_rbt_link_t ** root, os_typed_rbt_link_t * link)
+{
+    os_typed_rbt_link_t * left = link->left;
+    os_typed_rbt_link_t * parent = os_typed_rbt_parent(link);
+    link->left = left->right;
+    if (NULL != left->right)
+        os_typed_rbt_set_parent(left->right, link);
+    os_typed_rbt_set_parent(left, parent);
+    if (NULL == parent)
+        *root = left;
+    else if (link == parent->left)
+        parent->left = left;
+    else
+        parent->right = left;
+    left->right = link;
+    os_typed_rbt_set_parent(link, left);
+}
+
+/*
+* os_typed_rbt_insert
+* @brief  把红色新节点接到查找得到的空位slot上, 然后修复平衡
+* @param  root    根指针
+* @param  parent  slot所在的节点, NULL表示树为空
+* @param  slot    parent->left或parent->right, 树为空时为root
+* @param  link    新节点
+*/
+static inline void os_typed_rbt_insert(os_typed_rbt_link_t ** root, os_typed_rbt_link_t * parent,
+                                       os_typed_rbt_link_t ** slot, os_typed_rbt_link_t * link)
+{
+    link->parent_color = (uintptr_t)parent | OS_TYPED_RBT_RED;
+    link->left = NULL;
+    link->right = NULL;
+    *slot = link;
+
+    // 父节点为红时必然不是根, 祖父节点一定存在
+    while (os_typed_rbt_is_red(parent = os_typed_rbt_parent(link))) {
+        os_typed_rbt_link_t * grand = os_typed_rbt_parent(parent);
+        if (parent == grand->left) {
+            os_typed_rbt_link_t * uncle = grand->right;
+            if (os_typed_rbt_is_red(uncle)) {
+                os_typed_rbt_set_color(parent, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(uncle, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(grand, OS_TYPED_RBT_RED);
+                link = grand;
+                continue;
+            }
+            if (link == parent->right) {
+                link = parent;
+                os_typed_rbt_left_rotate(root, link);
+                parent = os_typed_rbt_parent(link);
+            }
+            os_typed_rbt_set_color(parent, OS_TYPED_RBT_BLACK);
+            os_typed_rbt_set_color(grand, OS_TYPED_RBT_RED);
+            os_typed_rbt_right_rotate(root, grand);
+        } else {
+            os_typed_rbt_link_t * uncle = grand->left;
+            if (os_typed_rbt_is_red(uncle)) {
+                os_typed_rbt_set_color(parent, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(uncle, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(grand, OS_TYPED_RBT_RED);
+                link = grand;
+                continue;
+            }
+            if (link == parent->left) {
+                link = parent;
+                os_typed_rbt_right_rotate(root, link);
+                parent = os_typed_rbt_parent(link);
+            }
+            os_typed_rbt_set_color(parent, OS_TYPED_RBT_BLACK);
+            os_typed_rbt_set_color(grand, OS_TYPED_RBT_RED);
+            os_typed_rbt_left_rotate(root, grand);
+        }
+    }
+
+    os_typed_rbt_set_color(*root, OS_TYPED_RBT_BLACK);
+}
+
+static inline void os_typed_rbt_transplant(os_typed_rbt_link_t ** root, os_typed_rbt_link_t * u, os_typed_rbt_link_t * v)
+{
+    os_typed_rbt_link_t * parent = os_typed_rbt_parent(u);
+    if (NULL == parent)
+        *root = v;
+    else if (u == parent->left)
+        parent->left = v;
+    else
+        parent->right = v;
+    if (NULL != v)
+        os_typed_rbt_set_parent(v, parent);
+}
+
+static inline os_typed_rbt_link_t * os_typed_rbt_minimum(os_typed_rbt_link_t * link)
+{
+    while (NULL != link->left)
+        link = link->left;
+    return link;
+}
+
+static inline os_typed_rbt_link_t * os_typed_rbt_maximum(os_typed_rbt_link_t * link)
+{
+    while (NULL != link->right)
+        link = link->right;
+    return link;
+}
+
+static inline os_typed_rbt_link_t * os_typed_rbt_next(const os_typed_rbt_link_t * link)
+{
+    if (NULL != link->right)
+        return os_typed_rbt_minimum(link->right);
+    os_typed_rbt_link_t * parent = os_typed_rbt_parent(link);
+    while (NULL != parent && link == parent->right) {
+        link = parent;
+        parent = os_typed_rbt_parent(parent);
+    }
+    return parent;
+}
+
+static inline os_typed_rbt_link_t * os_typed_rbt_prev(const os_typed_rbt_link_t * link)
+{
+    if (NULL != link->left)
+        return os_typed_rbt_maximum(link->left);
+    os_typed_rbt_link_t * parent = os_typed_rbt_parent(link);
+    while (NULL != parent && link == parent->left) {
+        link = parent;
+        parent = os_typed_rbt_parent(parent);
+    }
+    return parent;
+}
+
+/*
+* os_typed_rbt_erase
+* @brief  从树中摘除节点并修复平衡, 节点内存由调用者释放
+* @param  root  根指针
+* @param  link  树中的节点
+*/
+static inline void os_typed_rbt_erase(os_typed_rbt_link_t ** root, os_typed_rbt_link_t * link)
+{
+    os_typed_rbt_link_t * child = NULL;
+    os_typed_rbt_link_t * parent = NULL;
+    uintptr_t color = link->parent_color & 1u;
+    if (NULL == link->left) {
+        child = link->right;
+        parent = os_typed_rbt_parent(link);
+        os_typed_rbt_transplant(root, link, child);
+    } else if (NULL == link->right) {
+        child = link->left;
+        parent = os_typed_rbt_parent(link);
+        os_typed_rbt_transplant(root, link, child);
+    } else {
+        os_typed_rbt_link_t * succ = os_typed_rbt_minimum(link->right);
+        color = succ->parent_color & 1u;
+        child = succ->right;
+        if (os_typed_rbt_parent(succ) == link) {
+            parent = succ;
+        } else {
+            parent = os_typed_rbt_parent(succ);
+            os_typed_rbt_transplant(root, succ, succ->right);
+            succ->right = link->right;
+            os_typed_rbt_set_parent(succ->right, succ);
+        }
+        os_typed_rbt_transplant(root, link, succ);
+        succ->left = link->left;
+        os_typed_rbt_set_parent(succ->left, succ);
+        os_typed_rbt_set_color(succ, link->parent_color & 1u);
+    }
+
+    if (OS_TYPED_RBT_RED == color)
+        return;
+
+    // child比兄弟子树少一个黑节点, 兄弟一定存在
+    while (child != *root && !os_typed_rbt_is_red(child)) {
+        if (child == parent->left) {
+            os_typed_rbt_link_t * sibling = parent->right;
+            if (os_typed_rbt_is_red(sibling)) {
+                os_typed_rbt_set_color(sibling, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(parent, OS_TYPED_RBT_RED);
+                os_typed_rbt_left_rotate(root, parent);
+                sibling = parent->right;
+            }
+            if (!os_typed_rbt_is_red(sibling->left) && !os_typed_rbt_is_red(sibling->right)) {
+                os_typed_rbt_set_color(sibling, OS_TYPED_RBT_RED);
+                child = parent;
+                parent = os_typed_rbt_parent(child);
+                continue;
+            }
+            if (!os_typed_rbt_is_red(sibling->right)) {
+                os_typed_rbt_set_color(sibling->left, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(sibling, OS_TYPED_RBT_RED);
+                os_typed_rbt_right_rotate(root, sibling);
+                sibling = parent->right;
+            }
+            os_typed_rbt_set_color(sibling, parent->parent_color & 1u);
+            os_typed_rbt_set_color(parent, OS_TYPED_RBT_BLACK);
+            os_typed_rbt_set_color(sibling->right, OS_TYPED_RBT_BLACK);
+            os_typed_rbt_left_rotate(root, parent);
+            child = *root;
+        } else {
+            os_typed_rbt_link_t * sibling = parent->left;
+            if (os_typed_rbt_is_red(sibling)) {
+                os_typed_rbt_set_color(sibling, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(parent, OS_TYPED_RBT_RED);
+                os_typed_rbt_right_rotate(root, parent);
+                sibling = parent->left;
+            }
+            if (!os_typed_rbt_is_red(sibling->left) && !os_typed_rbt_is_red(sibling->right)) {
+                os_typed_rbt_set_color(sibling, OS_TYPED_RBT_RED);
+                child = parent;
+                parent = os_typed_rbt_parent(child);
+                continue;
+            }
+            if (!os_typed_rbt_is_red(sibling->left)) {
+                os_typed_rbt_set_color(sibling->right, OS_TYPED_RBT_BLACK);
+                os_typed_rbt_set_color(sibling, OS_TYPED_RBT_RED);
+                os_typed_rbt_left_rotate(root, sibling);
+                sibling = parent->left;
+            }
+            os_typed_rbt_set_color(sibling, parent->parent_color & 1u);
+            os_typed_rbt_set_color(parent, OS_TYPED_RBT_BLACK);
+            os_typed_rbt_set_color(sibling->left, OS_TYPED_RBT_BLACK);
+            os_typed_rbt_right_rotate(root, parent);
+            child = *root;
+        }
+    }
+
+    if (NULL != child)
+        os_typed_rbt_set_color(child, OS_TYPED_RBT_BLACK);
+}
+
+OS_API_END
+
+/*
+* OS_DEFINE_RBT
+* @brief  生成红黑树name_t及其节点name_node_t, 相同的元素只保存一个
+*         init clear empty size insert erase erase_node find lower_bound first last next prev data foreach
+* @param  name  类型和函数名前缀
+* @param  K     元素类型
+* @param  CMP   比较函数或宏, CMP(const K * a, const K * b)在a<b, a==b, a>b时分别返回负数, 0, 正数
+*/
+#define OS_DEFINE_RBT(name, K, CMP) \
+typedef struct name##_node_t { \
+    os_typed_rbt_link_t link; \
+    K data; \
+} name##_node_t; \
+typedef struct name##_t { \
+    size_t size; \
+    os_typed_rbt_link_t * root; \
+} name##_t; \
+static inline name##_node_t * name##_entry(const os_typed_rbt_link_t * link) \
+{ \
+    return NULL == link ? NULL : os_container_of(link, name##_node_t, link); \
+} \
+static inline void name##_init(name##_t * t) \
+{ \
+    t->size = 0u; \
+    t->root = NULL; \
+} \
+static inline void name##_clear(name##_t * t) \
+{ \
+    os_typed_rbt_link_t * link = t->root; \
+    while (NULL != link) { \
+        if (NULL != link->left) { \
+            link = link->left; \
+        } else if (NULL != link->right) { \
+            link = link->right; \
+        } else { \
+            os_typed_rbt_link_t * parent = os_typed_rbt_parent(link); \
+            if (NULL != parent) { \
+                if (link == parent->left) \
+                    parent->left = NULL; \
+                else \
+                    parent->right = NULL; \
+            } \
+            OS_TYPED_FREE(name##_entry(link)); \
+            link = parent; \
+        } \
+    } \
+    name##_init(t); \
+} \
+static inline bool name##_empty(const name##_t * t) \
+{ \
+    return 0u == t->size; \
+} \
+static inline size_t name##_size(const name##_t * t) \
+{ \
+    return t->size; \
+} \
+static inline bool name##_insert(name##_t * t, K value) \
+{ \
+    os_typed_rbt_link_t * parent = NULL; \
+    os_typed_rbt_link_t ** slot = &t->root; \
+    while (NULL != *slot) { \
+        parent = *slot; \
+        int ret = CMP(&name##_entry(parent)->data, &value); \
+        if (ret < 0) \
+            slot = &parent->right; \
+        else if (ret > 0) \
+            slot = &parent->left; \
+        else \
+            return true; \
+    } \
+    name##_node_t * node = (name##_node_t *)OS_TYPED_MALLOC(sizeof(name##_node_t)); \
+    if (NULL == node) \
+        return false; \
+    node->data = value; \
+    os_typed_rbt_insert(&t->root, parent, slot, &node->link); \
+    ++t->size; \
+    return true; \
+} \
+static inline name##_node_t * name##_find(const name##_t * t, const K * key) \
+{ \
+    os_typed_rbt_link_t * link = t->root; \
+    while (NULL != link) { \
+        int ret = CMP(&name##_entry(link)->data, key); \
+        if (ret < 0) \
+            link = link->right; \
+        else if (ret > 0) \
+            link = link->left; \
+        else \
+            return name##_entry(link); \
+    } \
+    return NULL; \
+} \
+static inline name##_node_t * name##_lower_bound(const name##_t * t, const K * key) \
+{ \
+    os_typed_rbt_link_t * bound = NULL; \
+    os_typed_rbt_link_t * link = t->root; \
+    while (NULL != link) { \
+        if (CMP(&name##_entry(link)->data, key) >= 0) { \
+            bound = link; \
+            link = link->left; \
+        } else { \
+            link = link->right; \
+        } \
+    } \
+    return name##_entry(bound); \
+} \
+static inline name##_node_t * name##_erase_node(name##_t * t, name##_node_t * node) \
+{ \
+    name##_node_t * next = name##_entry(os_typed_rbt_next(&node->link)); \
+    os_typed_rbt_erase(&t->root, &node->link); \
+    OS_TYPED_FREE(node); \
+    --t->size; \
+    return next; \
+} \
+static inline bool name##_erase(name##_t * t, const K * key) \
+{ \
+    name##_node_t * node = name##_find(t, key); \
+    if (NULL == node) \
+        return false; \
+    name##_erase_node(t, node); \
+    return true; \
+} \
+static inline name##_node_t * name##_first(const name##_t * t) \
+{ \
+    return NULL == t->root ? NULL : name##_entry(os_typed_rbt_minimum(t->root)); \
+} \
+static inline name##_node_t * name##_last(const name##_t * t) \
+{ \
+    return NULL == t->root ? NULL : name##_entry(os_typed_rbt_maximum(t->root)); \
+} \
+static inline name##_node_t * name##_next(const name##_node_t * node) \
+{ \
+    return name##_entry(os_typed_rbt_next(&node->link)); \
+} \
+static inline name##_node_t * name##_prev(const name##_node_t * node) \
+{ \
+    return name##_entry(os_typed_rbt_prev(&node->link)); \
+} \
+static inline K * name##_data(name##_node_t * node) \
+{ \
+    return &node->data; \
+} \
+static inline int name##_foreach(const name##_t * t, int (*visitor)(const K * data, void * ctx), void * ctx) \
+{ \
+    os_typed_rbt_link_t * link = NULL == t->root ? NULL : os_typed_rbt_minimum(t->root); \
+    while (NULL != link) { \
+        OS_PREFETCH(link->right); \
+        int ret = visitor(&name##_entry(link)->data, ctx); \
+        if (0 != ret) \
+            return ret; \
+        link = os_typed_rbt_next(link); \
+    } \
+    return 0; \
+}
+
+#endif
@@ -0,0 +1,431 @@
+﻿#include "os_hash.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OS_HASH_USE_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline unsigned os_hash_ctz(uint32_t bits)
+{
+    unsigned long idx = 0;
+    _BitScanForward(&idx, bits);
+    return (unsigned)idx;
+}
+#else
+#define os_hash_ctz(bits) ((unsigned)__builtin_ctz(bits))
+#endif
+
+#define OS_HASH_GROUP_WIDTH   16u                 // 每组槽位数, 一次SSE2比较
+#define OS_HASH_GROUP_LOAD    14u                 // 每组平均最多元素数(7/8)
+#define OS_HASH_CTRL_EMPTY    0x80u               // 空槽位控制字节
+#define OS_HASH_MIGRATE_STEP  2u                  // 每次修改操作迁移的组数
+#define OS_HASH_NPOS          ((size_t)-1)
+
+// 控制字节: 最高位为1表示空, 否则低7位保存哈希值的低7位
+// overflow: 插入时越过该组(组已满)的元素个数, 为0时查找可以在该组停止; 删除时沿探测路径递减, 无需墓碑
+typedef struct _os_hash_table_t {
+    size_t groups;            // 组数, 2的幂
+    size_t size;              // 元素个数
+    uint8_t * ctrl;           // 控制字节
+    uint32_t * overflow;      // 每组溢出计数
+    char * slots;             // 元素数组
+} os_hash_table_t;
+
+struct _os_hash_t {
+    size_t elem_size;         // 元素大小
+    os_hash_func hash;        // 哈希函数
+    os_hash_equal equal;      // 判等函数
+    os_hash_table_t cur;      // 当前表, 新元素只插入此表
+    os_hash_table_t old;      // 扩容中尚未迁移完的旧表
+    size_t migrate_pos;       // 旧表下一个待迁移的组
+    size_t pending_groups;    // 迁移期间推迟的扩容目标组数, 0表示没有
+    os_allocator_t allocator; // 分配器, 哈希表本身和槽位数组经由它申请
+};
+
+// 默认哈希函数
+static uint64_t os_hash_bytes(const void * data, size_t size);
+// 默认判等函数
+static bool os_hash_bytes_equal(const void * data1, const void * data2, size_t size);
+// 计算元素最终的哈希值
+static inline uint64_t os_hash_value(const os_hash_t * h, const void * data);
+// 组内与h2匹配的槽位掩码
+static inline uint32_t os_hash_match(const uint8_t * ctrl, uint8_t h2);
+// 组内空槽位掩码
+static inline uint32_t os_hash_match_empty(const uint8_t * ctrl);
+// 指定组数的表占用的字节数
+static size_t os_hash_table_bytes(size_t elem_size, size_t groups);
+// 创建指定组数的表
+static bool os_hash_table_init(const os_hash_t * h, os_hash_table_t * table, size_t groups);
+// 释放表
+static void os_hash_table_free(const os_hash_t * h, os_hash_table_t * table);
+// 在表中查找, 返回槽位下标
+static size_t os_hash_table_find(const os_hash_t * h, const os_hash_table_t * table, const void * data, uint64_t hv);
+// 向表中放入不存在的元素
+static void os_hash_table_put(const os_hash_t * h, os_hash_table_t * table, const void * data, uint64_t hv);
+// 删除表中的槽位
+static void os_hash_table_remove(os_hash_table_t * table, size_t pos, uint64_t hv);
+// 从旧表迁移最多steps个组
+static void os_hash_migrate(os_hash_t * h, size_t steps);
+// 切换到指定组数的新表
+static bool os_hash_grow(os_hash_t * h, size_t groups);
+
+os_hash_t * os_hash_create(const size_t elem_size, os_hash_func hash, os_hash_equal equal)
+{
+    return os_hash_create_ex(elem_size, hash, equal, NULL);
+}
+
+os_hash_t * os_hash_create_ex(const size_t elem_size, os_hash_func hash, os_hash_equal equal, const os_allocator_t * allocator)
+{
+    if (0u == elem_size)
+        return NULL;
+
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_hash_t * h = (os_hash_t *)os_allocator_calloc(allocator, sizeof(os_hash_t));
+    if (NULL == h)
+        return NULL;
+
+    h->allocator = *allocator;
+    h->elem_size = elem_size;
+    h->hash = hash ? hash : os_hash_bytes;
+    h->equal = equal ? equal : os_hash_bytes_equal;
+
+    return h;
+}
+
+void os_hash_destroy(os_hash_t ** h)
+{
+    if (NULL == h || NULL == *h)
+        return;
+
+    os_hash_clear(*h);
+
+    os_allocator_t allocator = (*h)->allocator;
+    os_allocator_free(&allocator, *h, sizeof(os_hash_t));
+    *h = NULL;
+}
+
+void os_hash_clear(os_hash_t * h)
+{
+    if (NULL == h)
+        return;
+
+    os_hash_table_free(h, &h->cur);
+    os_hash_table_free(h, &h->old);
+    h->migrate_pos = 0u;
+    h->pending_groups = 0u;
+}
+
+size_t os_hash_size(const os_hash_t * h)
+{
+    return h ? h->cur.size + h->old.size : 0u;
+}
+
+bool os_hash_empty(const os_hash_t * h)
+{
+    return 0u == os_hash_size(h);
+}
+
+bool os_hash_reserve(os_hash_t * h, const size_t count)
+{
+    if (NULL == h)
+        return false;
+
+    size_t groups = 1u;
+    while (groups * OS_HASH_GROUP_LOAD < count)
+        groups <<= 1;
+
+    if (groups <= h->cur.groups)
+        return true;
+
+    // 迁移未完成时不能再切换新表, 记下目标, 由后续操作按步迁移完后再扩容, 避免一次迁移整个旧表
+    if (NULL != h->old.slots) {
+        if (groups > h->pending_groups)
+            h->pending_groups = groups;
+        return true;
+    }
+
+    return os_hash_grow(h, groups);
+}
+
+bool os_hash_insert(os_hash_t * h, const void * data)
+{
+    if (NULL == h || NULL == data)
+        return false;
+
+    uint64_t hv = os_hash_value(h, data);
+    if (OS_HASH_NPOS != os_hash_table_find(h, &h->cur, data, hv) ||
+        OS_HASH_NPOS != os_hash_table_find(h, &h->old, data, hv))
+        return true;
+
+    os_hash_migrate(h, OS_HASH_MIGRATE_STEP);
+
+    if (h->cur.size + h->old.size + 1 > h->cur.groups * OS_HASH_GROUP_LOAD) {
+        // 扩容后当前表还能再插入约一半容量的元素, 而旧表每次插入迁移OS_HASH_MIGRATE_STEP组,
+        // 只靠插入不会在迁移完成前再次装满; 这里只是兜底, 迁移剩余的组
+        if (NULL != h->old.slots)
+            os_hash_migrate(h, h->old.groups - h->migrate_pos);
+        if (h->cur.size + h->old.size + 1 > h->cur.groups * OS_HASH_GROUP_LOAD
+            && !os_hash_grow(h, h->cur.groups ? h->cur.groups * 2 : 1u))
+            return false;
+    }
+
+    os_hash_table_put(h, &h->cur, data, hv);
+
+    return true;
+}
+
+bool os_hash_erase(os_hash_t * h, const void * data)
+{
+    if (NULL == h || NULL == data)
+        return false;
+
+    uint64_t hv = os_hash_value(h, data);
+    size_t pos = os_hash_table_find(h, &h->cur, data, hv);
+    if (OS_HASH_NPOS != pos) {
+        os_hash_table_remove(&h->cur, pos, hv);
+    } else {
+        pos = os_hash_table_find(h, &h->old, data, hv);
+        if (OS_HASH_NPOS == pos)
+            return false;
+        os_hash_table_remove(&h->old, pos, hv);
+    }
+
+    os_hash_migrate(h, OS_HASH_MIGRATE_STEP);
+
+    return true;
+}
+
+void * os_hash_find(const os_hash_t * h, const void * data)
+{
+    if (NULL == h || NULL == data)
+        return NULL;
+
+    uint64_t hv = os_hash_value(h, data);
+    size_t pos = os_hash_table_find(h, &h->cur, data, hv);
+    if (OS_HASH_NPOS != pos)
+        return h->cur.slots + pos * h->elem_size;
+
+    pos = os_hash_table_find(h, &h->old, data, hv);
+    if (OS_HASH_NPOS != pos)
+        return h->old.slots + pos * h->elem_size;
+
+    return NULL;
+}
+
+uint64_t os_hash_bytes(const void * data, size_t size)
+{
+    const unsigned char * bytes = (const unsigned char *)data;
+    uint64_t hv = 0x9E3779B97F4A7C15ull ^ (uint64_t)size;
+    while (size >= 8u) {
+        uint64_t word;
+        memcpy(&word, bytes, 8u);
+        hv = (hv ^ word) * 0xBF58476D1CE4E5B9ull;
+        hv ^= hv >> 29;
+        bytes += 8;
+        size -= 8u;
+    }
+
+    uint64_t tail = 0u;
+    memcpy(&tail, bytes, size);
+    hv = (hv ^ tail) * 0x94D049BB133111EBull;
+
+    return hv;
+}
+
+bool os_hash_bytes_equal(const void * data1, const void * data2, size_t size)
+{
+    return 0 == memcmp(data1, data2, size);
+}
+
+uint64_t os_hash_value(const os_hash_t * h, const void * data)
+{
+    // 对用户哈希值再做一次混合, 避免低质量哈希(如整数原值)集中在少数组
+    uint64_t hv = h->hash(data, h->elem_size);
+    hv ^= hv >> 33;
+    hv *= 0xFF51AFD7ED558CCDull;
+    hv ^= hv >> 33;
+    hv *= 0xC4CEB9FE1A85EC53ull;
+    hv ^= hv >> 33;
+
+    return hv;
+}
+
+#if defined(OS_HASH_USE_SSE2)
+
+uint32_t os_hash_match(const uint8_t * ctrl, const uint8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+}
+
+uint32_t os_hash_match_empty(const uint8_t * ctrl)
+{
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+}
+
+#else
+
+uint32_t os_hash_match(const uint8_t * ctrl, const uint8_t h2)
+{
+    uint32_t bits = 0u;
+    for (unsigned i = 0; i < OS_HASH_GROUP_WIDTH; i++) {
+        if (ctrl[i] == h2)
+            bits |= 1u << i;
+    }
+    return bits;
+}
+
+uint32_t os_hash_match_empty(const uint8_t * ctrl)
+{
+    uint32_t bits = 0u;
+    for (unsigned i = 0; i < OS_HASH_GROUP_WIDTH; i++) {
+        if (ctrl[i] & OS_HASH_CTRL_EMPTY)
+            bits |= 1u << i;
+    }
+    return bits;
+}
+
+#endif
+
+size_t os_hash_table_bytes(const size_t elem_size, const size_t groups)
+{
+    size_t slots = groups * OS_HASH_GROUP_WIDTH;
+    size_t slot_bytes = (slots * elem_size + OS_HASH_GROUP_WIDTH - 1) / OS_HASH_GROUP_WIDTH * OS_HASH_GROUP_WIDTH;
+    return slot_bytes + slots + groups * sizeof(uint32_t);
+}
+
+bool os_hash_table_init(const os_hash_t * h, os_hash_table_t * table, const size_t groups)
+{
+    size_t slots = groups * OS_HASH_GROUP_WIDTH;
+    size_t slot_bytes = (slots * h->elem_size + OS_HASH_GROUP_WIDTH - 1) / OS_HASH_GROUP_WIDTH * OS_HASH_GROUP_WIDTH;
+    char * mem = (char *)os_allocator_alloc(&h->allocator, os_hash_table_bytes(h->elem_size, groups));
+    if (NULL == mem)
+        return false;
+
+    table->groups = groups;
+    table->size = 0u;
+    table->slots = mem;
+    table->ctrl = (uint8_t *)(mem + slot_bytes);
+    table->overflow = (uint32_t *)(mem + slot_bytes + slots);
+    memset(table->ctrl, OS_HASH_CTRL_EMPTY, slots);
+    memset(table->overflow, 0, groups * sizeof(uint32_t));
+
+    return true;
+}
+
+void os_hash_table_free(const os_hash_t * h, os_hash_table_t * table)
+{
+    if (NULL != table->slots)
+        os_allocator_free(&h->allocator, table->slots, os_hash_table_bytes(h->elem_size, table->groups));
+    memset(table, 0, sizeof(os_hash_table_t));
+}
+
+size_t os_hash_table_find(const os_hash_t * h, const os_hash_table_t * table, const void * data, const uint64_t hv)
+{
+    if (0u == table->size)
+        return OS_HASH_NPOS;
+
+    size_t mask = table->groups - 1;
+    size_t group = (size_t)(hv >> 7) & mask;
+    uint8_t h2 = (uint8_t)(hv & 0x7F);
+    for (size_t step = 1; step <= table->groups; step++) {
+        const uint8_t * ctrl = table->ctrl + group * OS_HASH_GROUP_WIDTH;
+        uint32_t bits = os_hash_match(ctrl, h2);
+        while (bits) {
+            size_t pos = group * OS_HASH_GROUP_WIDTH + os_hash_ctz(bits);
+            if (h->equal(table->slots + pos * h->elem_size, data, h->elem_size))
+                return pos;
+            bits &= bits - 1;
+        }
+        if (0u == table->overflow[group])
+            break;
+        group = (group + step) & mask;
+    }
+
+    return OS_HASH_NPOS;
+}
+
+void os_hash_table_put(const os_hash_t * h, os_hash_table_t * table, const void * data, const uint64_t hv)
+{
+    size_t mask = table->groups - 1;
+    size_t group = (size_t)(hv >> 7) & mask;
+    for (size_t step = 1; step <= table->groups; step++) {
+        uint8_t * ctrl = table->ctrl + group * OS_HASH_GROUP_WIDTH;
+        uint32_t bits = os_hash_match_empty(ctrl);
+        if (bits) {
+            size_t idx = os_hash_ctz(bits);
+            ctrl[idx] = (uint8_t)(hv & 0x7F);
+            memcpy(table->slots + (group * OS_HASH_GROUP_WIDTH + idx) * h->elem_size, data, h->elem_size);
+            ++table->size;
+            return;
+        }
+        ++table->overflow[group];
+        group = (group + step) & mask;
+    }
+}
+
+void os_hash_table_remove(os_hash_table_t * table, const size_t pos, const uint64_t hv)
+{
+    size_t mask = table->groups - 1;
+    size_t target = pos / OS_HASH_GROUP_WIDTH;
+    size_t group = (size_t)(hv >> 7) & mask;
+    for (size_t step = 1; group != target; step++) {
+        --table->overflow[group];
+        group = (group + step) & mask;
+    }
+
+    table->ctrl[pos] = OS_HASH_CTRL_EMPTY;
+    --table->size;
+}
+
+void os_hash_migrate(os_hash_t * h, size_t steps)
+{
+    os_hash_table_t * old = &h->old;
+    while (0u != old->size && h->migrate_pos < old->groups && steps-- > 0u) {
+        size_t base = h->migrate_pos * OS_HASH_GROUP_WIDTH;
+        uint32_t bits = os_hash_match_empty(old->ctrl + base) ^ 0xFFFFu;
+        while (bits) {
+            size_t pos = base + os_hash_ctz(bits);
+            const char * data = old->slots + pos * h->elem_size;
+            os_hash_table_put(h, &h->cur, data, os_hash_value(h, data));
+            old->ctrl[pos] = OS_HASH_CTRL_EMPTY;
+            --old->size;
+            bits &= bits - 1;
+        }
+        ++h->migrate_pos;
+    }
+
+    if (NULL != old->slots && 0u == old->size) {
+        os_hash_table_free(h, old);
+        h->migrate_pos = 0u;
+
+        // 迁移期间推迟的扩容; 申请失败时放弃, 之后由插入按需扩容
+        size_t groups = h->pending_groups;
+        h->pending_groups = 0u;
+        if (groups > h->cur.groups)
+            os_hash_grow(h, groups);
+    }
+}
+
+bool os_hash_grow(os_hash_t * h, const size_t groups)
+{
+    os_hash_table_t table;
+    if (!os_hash_table_init(h, &table, groups))
+        return false;
+
+    // 调用方保证上一次扩容已经迁移完成
+    h->old = h->cur;
+    h->cur = table;
+    h->migrate_pos = 0u;
+    if (0u == h->old.size)
+        os_hash_table_free(h, &h->old);
+
+    return true;
+}
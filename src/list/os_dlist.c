@@ -1,35 +1,147 @@
 ﻿#include "os_dlist.h"
+#include "os_mempool.h"
+#include "os_mapfile.h"
+#include "os_stats.h"
 
 #include <string.h>
-#include <malloc.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#define OS_DLIST_SNAPSHOT_MAGIC       "OSDLIST\0"
+#define OS_DLIST_SNAPSHOT_VERSION     1u
+#define OS_DLIST_SNAPSHOT_BYTE_ORDER  0x01020304u           // 按本机字节序写入, 读出不一致说明文件来自字节序不同的机器
+#define OS_DLIST_SNAPSHOT_DATA_OFFSET OS_CACHE_LINE_SIZE    // 元素区起始偏移, 映射按页对齐, 元素区因此按缓存行对齐
+
+// 只读接口(按位置定位)也要累计统计, 只经由原子的OS_STATS_ADD修改
+#define OS_DLIST_STATS(lst)           (((os_dlist_t *)(lst))->stats)
 
 struct _os_dlist_node_t {
     os_dlist_node_t * next;  // 下一个节点
     os_dlist_node_t * prev;  // 上一个节点
+    uint32_t owner;          // 所属链表编号, 0表示已释放
+    uint32_t gen;            // 分配时的代数
     char data[0];            // 数据
 };
 
+// 展开模式下每个块连续存放多个元素
+typedef struct _os_dlist_block_t os_dlist_block_t;
+
+struct _os_dlist_block_t {
+    os_dlist_block_t * next; // 下一个块
+    os_dlist_block_t * prev; // 上一个块
+    size_t count;            // 元素个数
+    char data[0];            // 元素
+};
+
 struct _os_dlist_t {
     size_t size;            // 链表长度
     size_t elem_size;       // 元素大小
     size_t node_size;       // 节点大小
+    size_t unroll;          // 每个块的元素个数, 0表示每个节点一个元素
     os_dlist_node_t * head; // 头节点
     os_dlist_node_t * tail; // 尾节点
+    os_dlist_block_t * first; // 展开模式的首个块
+    os_dlist_block_t * last;  // 展开模式的末尾块
+    os_mempool_t * pool;    // 节点池
+    os_allocator_t allocator; // 分配器, 链表本身和节点池经由它申请
+    uint32_t id;            // 链表编号, 全局唯一
+    uint32_t gen;           // 最近一次分配节点的代数
+    uint32_t clear_gen;     // 最近一次清空时的代数, 不晚于它的句柄指向的内存可能已释放
+#if defined(OS_ENABLE_STATS)
+    os_stats_t stats;       // 运行统计
+    size_t detached_bytes;  // 展开模式下os_dlist_remove_if返回、尚未释放的独立节点字节数, 清空时不计为释放
+#endif
 };
 
-// 检测是否存在某个节点
-static bool os_dlist_exist(const os_dlist_t * lst, const os_dlist_node_t * node);
+// 快照文件头, 其后是按链表顺序连续存放的元素, 文件中不含任何指针
+typedef struct _os_dlist_snapshot_header_t {
+    char magic[8];          // 文件标识
+    uint32_t version;       // 格式版本
+    uint32_t byte_order;    // 字节序标记
+    uint64_t elem_size;     // 元素大小
+    uint64_t count;         // 元素个数
+    uint64_t data_offset;   // 元素区相对文件起始的偏移
+} os_dlist_snapshot_header_t;
+
+// 映射的快照, 只读
+struct _os_dlist_view_t {
+    os_mapfile_t * map;     // 文件映射
+    const char * elems;     // 元素区
+    size_t elem_size;       // 元素大小
+    size_t count;           // 元素个数
+};
+
+// 写入快照时的遍历参数
+typedef struct _os_dlist_writer_t {
+    FILE * fp;              // 快照文件
+    size_t elem_size;       // 元素大小
+} os_dlist_writer_t;
+
+typedef struct _os_dlist_match_t {
+    const void * data;      // 要删除的数据
+    size_t size;            // 元素大小
+} os_dlist_match_t;
+
+// 链表编号生成器, 0保留给已释放的节点
+static atomic_uint os_dlist_next_id = 1u;
+
+// os_dlist_delete_ex的删除条件
+static bool os_dlist_match(const void * data, void * ctx);
+// 查找从head开始的非递减段, 返回段尾
+static os_dlist_node_t * os_dlist_run(os_dlist_t * lst, os_dlist_node_t * head, os_dlist_compare compare);
+// 稳定合并两个有序段并接在prev之后, 同时修复prev指针, 返回合并后的尾
+static os_dlist_node_t * os_dlist_merge_run(os_dlist_t * lst, os_dlist_node_t * a, os_dlist_node_t * b, os_dlist_compare compare,
+                                            os_dlist_node_t * prev, os_dlist_node_t ** link);
+// 展开模式: 查找pos所在的块, off返回块内下标
+static os_dlist_block_t * os_dlist_block_find(const os_dlist_t * lst, size_t pos, size_t * off);
+// 展开模式: 在prev之后接入新块, prev为NULL时作为首个块
+static os_dlist_block_t * os_dlist_block_new(os_dlist_t * lst, os_dlist_block_t * prev);
+// 展开模式: 摘除并释放块
+static void os_dlist_block_free(os_dlist_t * lst, os_dlist_block_t * block);
+// 展开模式: 在pos处插入count个元素
+static bool os_dlist_unrolled_insert(os_dlist_t * lst, size_t pos, const void * data, size_t count);
+// 展开模式: 删除满足条件的元素, 相邻的块能放下时合并; removed非NULL时把删除的元素拷入独立节点串成链
+static size_t os_dlist_unrolled_remove_if(os_dlist_t * lst, os_dlist_predicate pred, void * ctx, os_dlist_node_t ** removed);
+// 展开模式: 稳定排序, 元素拷入临时缓冲区归并后写回各块, 内存不足时返回false
+static bool os_dlist_unrolled_sort(os_dlist_t * lst, os_dlist_compare compare);
+// 向快照文件写入一个元素, 失败时停止遍历
+static int os_dlist_snapshot_write(void * data, void * ctx);
+// 创建链表, unroll为0时每个节点一个元素, allocator为NULL时使用默认分配器
+static os_dlist_t * os_dlist_new(size_t elem_size, size_t unroll, size_t chunk_size, const os_allocator_t * allocator);
+// 分配节点并打上归属标记
+static os_dlist_node_t * os_dlist_alloc_node(os_dlist_t * lst);
+// 释放节点并清除归属标记
+static void os_dlist_free_node(os_dlist_t * lst, os_dlist_node_t * node);
 
 os_dlist_t * os_dlist_create(const size_t elem_size)
 {
-    os_dlist_t * lst = (os_dlist_t *)calloc(1, sizeof(os_dlist_t));
-    if (NULL == lst)
-        return NULL;
+    return os_dlist_create_pool(elem_size, 0u);
+}
 
-    lst->elem_size = elem_size;
-    lst->node_size = sizeof(os_dlist_node_t) + elem_size;
+os_dlist_t * os_dlist_create_pool(const size_t elem_size, const size_t chunk_size)
+{
+    return os_dlist_new(elem_size, 0u, chunk_size, NULL);
+}
 
-    return lst;
+os_dlist_t * os_dlist_create_ex(const size_t elem_size, const os_allocator_t * allocator)
+{
+    return os_dlist_new(elem_size, 0u, 0u, allocator);
+}
+
+os_dlist_t * os_dlist_create_unrolled(const size_t elem_size, const size_t elems_per_node)
+{
+    return os_dlist_create_unrolled_ex(elem_size, elems_per_node, NULL);
+}
+
+os_dlist_t * os_dlist_create_unrolled_ex(const size_t elem_size, const size_t elems_per_node, const os_allocator_t * allocator)
+{
+    if (elems_per_node < 2u)
+        return os_dlist_create_ex(elem_size, allocator);
+
+    if (0u == elem_size)
+        return NULL;
+
+    return os_dlist_new(elem_size, elems_per_node, 0u, allocator);
 }
 
 void os_dlist_destroy(os_dlist_t ** lst)
@@ -38,8 +150,10 @@ void os_dlist_destroy(os_dlist_t ** lst)
         return;
 
     os_dlist_clear(*lst);
+    os_mempool_destroy(&(*lst)->pool);
 
-    free(*lst);
+    os_allocator_t allocator = (*lst)->allocator;
+    os_allocator_free(&allocator, *lst, sizeof(os_dlist_t));
     *lst = NULL;
 }
 
@@ -48,14 +162,15 @@ void os_dlist_clear(os_dlist_t * lst)
     if (NULL == lst)
         return;
 
-    os_dlist_node_t * node = NULL;
-    while (NULL != lst->head) {
-        node = lst->head;
-        lst->head = node->next;
-        free(node);
-        --lst->size;
-    }
+    // 节点全部来自节点池, 整块释放即可
+    os_mempool_clear(lst->pool);
+    OS_STATS_RELEASE(lst->stats, sizeof(os_dlist_t) + lst->detached_bytes, lst->node_size);
+    lst->head = NULL;
     lst->tail = NULL;
+    lst->first = NULL;
+    lst->last = NULL;
+    lst->size = 0ul;
+    lst->clear_gen = lst->gen;
 }
 
 bool os_dlist_empty(os_dlist_t * lst)
@@ -79,11 +194,16 @@ bool os_dlist_add(os_dlist_t * lst, void * data)
     if (NULL == lst)
         return false;
 
-    os_dlist_node_t * node = (os_dlist_node_t *)calloc(1, lst->node_size);
+    if (0u != lst->unroll)
+        return os_dlist_unrolled_insert(lst, lst->size, data, 1u);
+
+    os_dlist_node_t * node = os_dlist_alloc_node(lst);
     if (NULL == node)
         return false;
 
     memcpy(node->data, data, lst->elem_size);
+    node->next = NULL;
+    node->prev = NULL;
 
     if (NULL == lst->head) {
         lst->head = node;
@@ -94,20 +214,34 @@ bool os_dlist_add(os_dlist_t * lst, void * data)
         lst->tail = node;
     }
     ++lst->size;
+    OS_STATS_SIZE(lst->stats, lst->size);
 
     return true;
 }
 
+bool os_dlist_add_n(os_dlist_t * lst, const void * data, const size_t count)
+{
+    if (NULL == lst)
+        return false;
+
+    return os_dlist_insert_n(lst, lst->size, data, count);
+}
+
 bool os_dlist_insert(os_dlist_t * lst, size_t pos, void * data)
 {
     if (NULL == lst || NULL == data)
         return false;
 
-    os_dlist_node_t * node = (os_dlist_node_t *)calloc(1, lst->node_size);
+    if (0u != lst->unroll)
+        return os_dlist_unrolled_insert(lst, pos, data, 1u);
+
+    os_dlist_node_t * node = os_dlist_alloc_node(lst);
     if (NULL == node)
         return false;
 
     memcpy(node->data, data, lst->elem_size);
+    node->next = NULL;
+    node->prev = NULL;
 
     if (0 == lst->size) {
         lst->head = node;
@@ -122,6 +256,7 @@ bool os_dlist_insert(os_dlist_t * lst, size_t pos, void * data)
         lst->tail = node;
     } else {
         os_dlist_node_t * tmp = lst->head;
+        OS_STATS_ADD(lst->stats, scan_steps, pos - 1);
         for (size_t i = 0; i < pos - 1; i++)
             tmp = tmp->next;
         node->next = tmp->next;
@@ -131,39 +266,94 @@ bool os_dlist_insert(os_dlist_t * lst, size_t pos, void * data)
     }
 
     lst->size++;
+    OS_STATS_SIZE(lst->stats, lst->size);
 
     return true;
 }
 
-os_dlist_node_t * os_dlist_delete(os_dlist_t * lst, os_dlist_node_t * node)
+bool os_dlist_insert_n(os_dlist_t * lst, const size_t pos, const void * data, const size_t count)
 {
-    if (NULL == lst || NULL == node)
-        return NULL;
+    if (NULL == lst || NULL == data)
+        return false;
 
-    os_dlist_node_t * tmp = NULL;
-    if (node == lst->head) {
-        tmp = lst->head->next;
-        lst->head = lst->head->next;
-        if (NULL == lst->head)
-            lst->tail = NULL;
-        else
-            lst->head->prev = NULL;
-    } else if (node == lst->tail) {
-        lst->tail = lst->tail->prev;
-        if (NULL != lst->tail)
-            lst->tail->next = NULL;
-    } else {
-        if (!os_dlist_exist(lst, node))
-            return NULL;
-        tmp = node->next;
-        node->next->prev = node->prev;
-        node->prev->next = node->next;
+    if (0u == count)
+        return true;
+
+    if (0u != lst->unroll)
+        return os_dlist_unrolled_insert(lst, pos, data, count);
+
+    // 一次预留全部节点, 之后的分配不会失败
+    if (!os_mempool_reserve(lst->pool, count))
+        return false;
+
+    // 先在本地串成链, 最后一次性接入
+    const char * src = (const char *)data;
+    os_dlist_node_t * first = NULL;
+    os_dlist_node_t * last = NULL;
+    os_dlist_node_t ** link = &first;
+    for (size_t i = 0; i < count; i++) {
+        os_dlist_node_t * node = os_dlist_alloc_node(lst);
+        memcpy(node->data, src, lst->elem_size);
+        src += lst->elem_size;
+        node->prev = last;
+        *link = node;
+        link = &node->next;
+        last = node;
     }
+
+    // 找到插入位置的后继节点, 从较近的一端查找
+    os_dlist_node_t * next = NULL;
+    if (pos < lst->size) {
+        if (pos <= lst->size / 2) {
+            next = lst->head;
+            OS_STATS_ADD(lst->stats, scan_steps, pos);
+            for (size_t i = 0; i < pos; i++)
+                next = next->next;
+        } else {
+            next = lst->tail;
+            OS_STATS_ADD(lst->stats, scan_steps, lst->size - 1 - pos);
+            for (size_t i = lst->size - 1; i > pos; i--)
+                next = next->prev;
+        }
+    }
+
+    os_dlist_node_t * prev = NULL == next ? lst->tail : next->prev;
+    first->prev = prev;
+    last->next = next;
+    if (NULL == prev)
+        lst->head = first;
+    else
+        prev->next = first;
+    if (NULL == next)
+        lst->tail = last;
+    else
+        next->prev = last;
+    lst->size += count;
+    OS_STATS_SIZE(lst->stats, lst->size);
+
+    return true;
+}
+
+bool os_dlist_delete(os_dlist_t * lst, const os_dlist_handle_t handle)
+{
+    os_dlist_node_t * node = os_dlist_handle_node(lst, handle);
+    if (NULL == node)
+        return false;
+
+    os_dlist_node_t * next = node->next;
+    if (NULL == node->prev)
+        lst->head = next;
+    else
+        node->prev->next = next;
+    if (NULL == next)
+        lst->tail = node->prev;
+    else
+        next->prev = node->prev;
     --lst->size;
 
-    free(node);
+    os_dlist_free_node(lst, node);
 
-    return tmp;
+    return true;
 }
 
 bool os_dlist_delete_ex(os_dlist_t * lst, void * data)
@@ -171,16 +361,84 @@ bool os_dlist_delete_ex(os_dlist_t * lst, void * data)
     if (NULL == lst || NULL == data)
         return true;
 
+    os_dlist_match_t match = { data, lst->elem_size };
+    os_dlist_remove_if(lst, os_dlist_match, &match, NULL);
+
+    return true;
+}
+
+size_t os_dlist_remove_if(os_dlist_t * lst, os_dlist_predicate pred, void * ctx, os_dlist_node_t ** removed)
+{
+    if (NULL != removed)
+        *removed = NULL;
+
+    if (NULL == lst || NULL == pred)
+        return 0u;
+
+    if (0u != lst->unroll)
+        return os_dlist_unrolled_remove_if(lst, pred, ctx, removed);
+
+    size_t count = 0u;
+    os_dlist_node_t * out = NULL;
     os_dlist_node_t * node = lst->head;
-    while (node) {
-        if (0 != memcmp(node->data, data, lst->elem_size)) {
-            node = node->next;
+    while (NULL != node) {
+        os_dlist_node_t * next = node->next;
+        OS_STATS_ADD(lst->stats, scan_steps, 1);
+        OS_STATS_ADD(lst->stats, compares, 1);
+        if (!pred(node->data, ctx)) {
+            node = next;
             continue;
         }
-        node = os_dlist_delete(lst, node);
+
+        if (NULL == node->prev)
+            lst->head = next;
+        else
+            node->prev->next = next;
+        if (NULL == next)
+            lst->tail = node->prev;
+        else
+            next->prev = node->prev;
+        ++count;
+
+        if (NULL != removed) {
+            // 移出的节点不再属于链表, 但内存仍在节点池中
+            node->owner = 0u;
+            node->prev = out;
+            node->next = NULL;
+            if (NULL == out)
+                *removed = node;
+            else
+                out->next = node;
+            out = node;
+        } else {
+            os_dlist_free_node(lst, node);
+        }
+        node = next;
     }
+    lst->size -= count;
 
-    return true;
+    return count;
+}
+
+void os_dlist_free_nodes(os_dlist_t * lst, os_dlist_node_t * nodes)
+{
+    if (NULL == lst)
+        return;
+
+    while (NULL != nodes) {
+        os_dlist_node_t * next = nodes->next;
+        // 展开模式移出的元素不在节点池中, 由分配器直接申请
+        if (0u != lst->unroll) {
+            size_t bytes = sizeof(os_dlist_node_t) + lst->elem_size;
+            os_allocator_free(&lst->allocator, nodes, bytes);
+            OS_STATS_FREE(lst->stats, 1, bytes);
+#if defined(OS_ENABLE_STATS)
+            lst->detached_bytes -= bytes;
+#endif
+        } else
+            os_dlist_free_node(lst, nodes);
+        nodes = next;
+    }
 }
 
 os_dlist_node_t * os_dlist_head(os_dlist_t * lst)
@@ -208,14 +466,715 @@ void * os_dlist_getdata(const os_dlist_node_t * node)
     return node ? (void *)node->data : NULL;
 }
 
-bool os_dlist_exist(const os_dlist_t * lst, const os_dlist_node_t * node)
+bool os_dlist_sort(os_dlist_t * lst, os_dlist_compare compare)
+{
+    if (NULL == lst || NULL == compare)
+        return false;
+
+    if (lst->size < 2u)
+        return true;
+
+    if (0u != lst->unroll)
+        return os_dlist_unrolled_sort(lst, compare);
+
+    // 自底向上的自然归并: 每一趟把相邻的两个有序段合并, 直到只剩一段
+    // 每一趟都重新接好prev指针, 结束时链表已完整
+    size_t runs = 0u;
+    do {
+        os_dlist_node_t * head = lst->head;
+        os_dlist_node_t * tail = NULL;
+        os_dlist_node_t ** link = &lst->head;
+        runs = 0u;
+        while (NULL != head) {
+            os_dlist_node_t * a = head;
+            os_dlist_node_t * a_end = os_dlist_run(lst, a, compare);
+            os_dlist_node_t * b = a_end->next;
+            a_end->next = NULL;
+            ++runs;
+            if (NULL == b) {
+                *link = a;
+                a->prev = tail;
+                tail = a_end;
+                break;
+            }
+
+            os_dlist_node_t * b_end = os_dlist_run(lst, b, compare);
+            head = b_end->next;
+            b_end->next = NULL;
+            tail = os_dlist_merge_run(lst, a, b, compare, tail, link);
+            link = &tail->next;
+        }
+        lst->tail = tail;
+    } while (runs > 1u);
+
+    return true;
+}
+
+int os_dlist_foreach(const os_dlist_t * lst, os_dlist_visitor visitor, void * ctx)
+{
+    if (NULL == lst || NULL == visitor)
+        return 0;
+
+    // 块内元素多, 只预取下一个块; 节点按OS_PREFETCH的约定预取后继的后继
+    int ret = 0;
+    if (0u != lst->unroll) {
+        for (os_dlist_block_t * block = lst->first; NULL != block; block = block->next) {
+            OS_PREFETCH(block->next);
+            char * data = block->data;
+            for (size_t i = 0u; i < block->count; ++i, data += lst->elem_size) {
+                ret = visitor(data, ctx);
+                if (0 != ret)
+                    return ret;
+            }
+        }
+        return 0;
+    }
+
+    os_dlist_node_t * node = lst->head;
+    while (NULL != node) {
+        os_dlist_node_t * next = node->next;
+        if (NULL != next)
+            OS_PREFETCH(next->next);
+        ret = visitor(node->data, ctx);
+        if (0 != ret)
+            break;
+        node = next;
+    }
+
+    return ret;
+}
+
+int os_dlist_foreach_reverse(const os_dlist_t * lst, os_dlist_visitor visitor, void * ctx)
+{
+    if (NULL == lst || NULL == visitor)
+        return 0;
+
+    int ret = 0;
+    if (0u != lst->unroll) {
+        for (os_dlist_block_t * block = lst->last; NULL != block; block = block->prev) {
+            OS_PREFETCH(block->prev);
+            char * data = block->data + block->count * lst->elem_size;
+            for (size_t i = block->count; i > 0u; --i) {
+                data -= lst->elem_size;
+                ret = visitor(data, ctx);
+                if (0 != ret)
+                    return ret;
+            }
+        }
+        return 0;
+    }
+
+    os_dlist_node_t * node = lst->tail;
+    while (NULL != node) {
+        os_dlist_node_t * prev = node->prev;
+        if (NULL != prev)
+            OS_PREFETCH(prev->prev);
+        ret = visitor(node->data, ctx);
+        if (0 != ret)
+            break;
+        node = prev;
+    }
+
+    return ret;
+}
+
+os_dlist_cursor_t os_dlist_cursor(const os_dlist_t * lst, const size_t pos)
+{
+    os_dlist_cursor_t cur = { lst, NULL, 0u };
+    if (NULL == lst || pos >= lst->size)
+        return cur;
+
+    if (0u != lst->unroll) {
+        cur.node = os_dlist_block_find(lst, pos, &cur.index);
+        return cur;
+    }
+
+    os_dlist_node_t * node = NULL;
+    if (pos <= lst->size / 2) {
+        node = lst->head;
+        OS_STATS_ADD(OS_DLIST_STATS(lst), scan_steps, pos);
+        for (size_t i = 0; i < pos; i++)
+            node = node->next;
+    } else {
+        node = lst->tail;
+        OS_STATS_ADD(OS_DLIST_STATS(lst), scan_steps, lst->size - 1 - pos);
+        for (size_t i = lst->size - 1; i > pos; i--)
+            node = node->prev;
+    }
+    cur.node = node;
+
+    return cur;
+}
+
+bool os_dlist_cursor_valid(const os_dlist_cursor_t * cur)
 {
-    os_dlist_node_t * tmp = lst->head;
-    while (tmp) {
-        if (tmp == node)
-            return true;
-        tmp = tmp->next;
+    return cur ? (NULL != cur->node) : false;
+}
+
+void * os_dlist_cursor_get(const os_dlist_cursor_t * cur)
+{
+    if (NULL == cur || NULL == cur->node)
+        return NULL;
+
+    if (0u == cur->lst->unroll)
+        return ((os_dlist_node_t *)cur->node)->data;
+
+    return ((os_dlist_block_t *)cur->node)->data + cur->index * cur->lst->elem_size;
+}
+
+bool os_dlist_cursor_next(os_dlist_cursor_t * cur)
+{
+    if (NULL == cur || NULL == cur->node)
+        return false;
+
+    if (0u == cur->lst->unroll) {
+        cur->node = ((os_dlist_node_t *)cur->node)->next;
+        return NULL != cur->node;
     }
 
+    // 块不会为空, 下一个块的首元素即为后继
+    os_dlist_block_t * block = (os_dlist_block_t *)cur->node;
+    if (++cur->index < block->count)
+        return true;
+
+    cur->node = block->next;
+    cur->index = 0u;
+
+    return NULL != cur->node;
+}
+
+bool os_dlist_cursor_prev(os_dlist_cursor_t * cur)
+{
+    if (NULL == cur || NULL == cur->node)
+        return false;
+
+    if (0u == cur->lst->unroll) {
+        cur->node = ((os_dlist_node_t *)cur->node)->prev;
+        return NULL != cur->node;
+    }
+
+    if (cur->index > 0u) {
+        cur->index--;
+        return true;
+    }
+
+    os_dlist_block_t * block = ((os_dlist_block_t *)cur->node)->prev;
+    cur->node = block;
+    cur->index = block ? block->count - 1 : 0u;
+
+    return NULL != block;
+}
+
+void * os_dlist_cursor_span(os_dlist_cursor_t * cur, size_t * count)
+{
+    if (NULL == cur || NULL == cur->node || NULL == count)
+        return NULL;
+
+    if (0u == cur->lst->unroll) {
+        os_dlist_node_t * node = (os_dlist_node_t *)cur->node;
+        cur->node = node->next;
+        *count = 1u;
+        return node->data;
+    }
+
+    os_dlist_block_t * block = (os_dlist_block_t *)cur->node;
+    void * data = block->data + cur->index * cur->lst->elem_size;
+    *count = block->count - cur->index;
+    cur->node = block->next;
+    cur->index = 0u;
+
+    return data;
+}
+
+os_dlist_handle_t os_dlist_get_handle(const os_dlist_node_t * node)
+{
+    os_dlist_handle_t handle = { (os_dlist_node_t *)node, node ? node->owner : 0u, node ? node->gen : 0u };
+    return handle;
+}
+
+os_dlist_node_t * os_dlist_handle_node(const os_dlist_t * lst, const os_dlist_handle_t handle)
+{
+    if (NULL == lst || NULL == handle.node || 0u != lst->unroll || handle.owner != lst->id)
+        return NULL;
+
+    // 代数按32位回绕比较: 只接受上次清空之后、当前代数及以前分配的节点, 这些节点的内存仍在节点池中
+    if ((int32_t)(handle.gen - lst->clear_gen) <= 0 || (int32_t)(handle.gen - lst->gen) > 0)
+        return NULL;
+
+    if (handle.node->owner != lst->id || handle.node->gen != handle.gen)
+        return NULL;
+
+    return handle.node;
+}
+
+bool os_dlist_stats(const os_dlist_t * lst, os_stats_t * stats)
+{
+    if (NULL == stats)
+        return false;
+
+    memset(stats, 0, sizeof(os_stats_t));
+#if defined(OS_ENABLE_STATS)
+    if (NULL == lst)
+        return false;
+
+    os_stats_load(stats, &lst->stats);
+    return true;
+#else
     return false;
+#endif
+}
+
+bool os_dlist_save(const os_dlist_t * lst, const char * path)
+{
+    if (NULL == lst || NULL == path)
+        return false;
+
+    // 不能原地重写: 截断会使映射旧文件的快照访问越界
+    char * tmp_path = NULL;
+    FILE * fp = os_mapfile_create(path, &tmp_path);
+    if (NULL == fp)
+        return false;
+
+    char head[OS_DLIST_SNAPSHOT_DATA_OFFSET];
+    os_dlist_snapshot_header_t header;
+    memset(head, 0, sizeof(head));
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, OS_DLIST_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = OS_DLIST_SNAPSHOT_VERSION;
+    header.byte_order = OS_DLIST_SNAPSHOT_BYTE_ORDER;
+    header.elem_size = (uint64_t)lst->elem_size;
+    header.count = (uint64_t)lst->size;
+    header.data_offset = OS_DLIST_SNAPSHOT_DATA_OFFSET;
+    memcpy(head, &header, sizeof(header));
+
+    os_dlist_writer_t writer = { fp, lst->elem_size };
+    bool ok = 1u == fwrite(head, sizeof(head), 1u, fp) && 0 == os_dlist_foreach(lst, os_dlist_snapshot_write, &writer);
+
+    return os_mapfile_commit(fp, tmp_path, path, ok);
+}
+
+os_dlist_view_t * os_dlist_map(const char * path, const size_t elem_size)
+{
+    if (NULL == path || 0u == elem_size)
+        return NULL;
+
+    os_mapfile_t * map = os_mapfile_open(path);
+    if (NULL == map)
+        return NULL;
+
+    // 只检查文件头和长度, 耗时与元素个数无关
+    os_dlist_snapshot_header_t header;
+    const char * base = (const char *)os_mapfile_data(map);
+    size_t size = os_mapfile_size(map);
+    if (size < sizeof(header)) {
+        os_mapfile_close(&map);
+        return NULL;
+    }
+    memcpy(&header, base, sizeof(header));
+    if (0 != memcmp(header.magic, OS_DLIST_SNAPSHOT_MAGIC, sizeof(header.magic))
+        || OS_DLIST_SNAPSHOT_VERSION != header.version
+        || OS_DLIST_SNAPSHOT_BYTE_ORDER != header.byte_order
+        || elem_size != header.elem_size
+        || OS_DLIST_SNAPSHOT_DATA_OFFSET != header.data_offset
+        || header.data_offset > size
+        || header.count > (size - header.data_offset) / elem_size) {
+        os_mapfile_close(&map);
+        return NULL;
+    }
+
+    os_dlist_view_t * view = (os_dlist_view_t *)calloc(1, sizeof(os_dlist_view_t));
+    if (NULL == view) {
+        os_mapfile_close(&map);
+        return NULL;
+    }
+
+    view->map = map;
+    view->elems = base + header.data_offset;
+    view->elem_size = elem_size;
+    view->count = (size_t)header.count;
+
+    return view;
+}
+
+void os_dlist_unmap(os_dlist_view_t ** view)
+{
+    if (NULL == view || NULL == *view)
+        return;
+
+    os_mapfile_close(&(*view)->map);
+    free(*view);
+    *view = NULL;
+}
+
+size_t os_dlist_view_size(const os_dlist_view_t * view)
+{
+    return view ? view->count : 0u;
+}
+
+const void * os_dlist_view_at(const os_dlist_view_t * view, const size_t pos)
+{
+    if (NULL == view || pos >= view->count)
+        return NULL;
+
+    return view->elems + pos * view->elem_size;
+}
+
+int os_dlist_view_foreach(const os_dlist_view_t * view, os_dlist_view_visitor visitor, void * ctx)
+{
+    if (NULL == view || NULL == visitor)
+        return 0;
+
+    int ret = 0;
+    const char * data = view->elems;
+    for (size_t i = 0u; i < view->count; ++i, data += view->elem_size) {
+        ret = visitor(data, ctx);
+        if (0 != ret)
+            break;
+    }
+
+    return ret;
+}
+
+bool os_dlist_match(const void * data, void * ctx)
+{
+    os_dlist_match_t * match = (os_dlist_match_t *)ctx;
+    return 0 == memcmp(data, match->data, match->size);
+}
+
+os_dlist_node_t * os_dlist_run(os_dlist_t * lst, os_dlist_node_t * head, os_dlist_compare compare)
+{
+    while (NULL != head->next) {
+        OS_STATS_ADD(lst->stats, compares, 1);
+        if (compare(head->next->data, head->data))
+            break;
+        head = head->next;
+    }
+
+    return head;
+}
+
+os_dlist_node_t * os_dlist_merge_run(os_dlist_t * lst, os_dlist_node_t * a, os_dlist_node_t * b, os_dlist_compare compare,
+                                     os_dlist_node_t * prev, os_dlist_node_t ** link)
+{
+    // 相等时取a中的节点, 保证稳定
+    while (NULL != a && NULL != b) {
+        os_dlist_node_t * node = NULL;
+        OS_STATS_ADD(lst->stats, compares, 1);
+        if (compare(b->data, a->data)) {
+            node = b;
+            b = b->next;
+        } else {
+            node = a;
+            a = a->next;
+        }
+        node->prev = prev;
+        *link = node;
+        link = &node->next;
+        prev = node;
+    }
+
+    // 剩余部分整体接上, 其内部的prev指针仍然有效
+    os_dlist_node_t * rest = NULL != a ? a : b;
+    rest->prev = prev;
+    *link = rest;
+    while (NULL != rest->next)
+        rest = rest->next;
+
+    return rest;
+}
+
+os_dlist_block_t * os_dlist_block_find(const os_dlist_t * lst, size_t pos, size_t * off)
+{
+    os_dlist_block_t * block = NULL;
+    if (pos <= lst->size / 2) {
+        block = lst->first;
+        while (pos >= block->count) {
+            OS_STATS_ADD(OS_DLIST_STATS(lst), scan_steps, 1);
+            pos -= block->count;
+            block = block->next;
+        }
+    } else {
+        // 从尾部向前, 换算成距离末尾的元素个数
+        size_t back = lst->size - pos;
+        block = lst->last;
+        while (back > block->count) {
+            OS_STATS_ADD(OS_DLIST_STATS(lst), scan_steps, 1);
+            back -= block->count;
+            block = block->prev;
+        }
+        pos = block->count - back;
+    }
+
+    *off = pos;
+    return block;
+}
+
+os_dlist_block_t * os_dlist_block_new(os_dlist_t * lst, os_dlist_block_t * prev)
+{
+    os_dlist_block_t * block = (os_dlist_block_t *)os_mempool_alloc(lst->pool);
+    if (NULL == block)
+        return NULL;
+    OS_STATS_ALLOC(lst->stats, 1, lst->node_size);
+
+    block->count = 0u;
+    block->prev = prev;
+    block->next = NULL == prev ? lst->first : prev->next;
+    if (NULL == block->next)
+        lst->last = block;
+    else
+        block->next->prev = block;
+    if (NULL == prev)
+        lst->first = block;
+    else
+        prev->next = block;
+
+    return block;
+}
+
+void os_dlist_block_free(os_dlist_t * lst, os_dlist_block_t * block)
+{
+    if (NULL == block->prev)
+        lst->first = block->next;
+    else
+        block->prev->next = block->next;
+    if (NULL == block->next)
+        lst->last = block->prev;
+    else
+        block->next->prev = block->prev;
+
+    os_mempool_free(lst->pool, block);
+    OS_STATS_FREE(lst->stats, 1, lst->node_size);
+}
+
+bool os_dlist_unrolled_insert(os_dlist_t * lst, size_t pos, const void * data, const size_t count)
+{
+    if (NULL == data)
+        return false;
+
+    if (pos > lst->size)
+        pos = lst->size;
+
+    size_t off = 0u;
+    os_dlist_block_t * block = NULL;
+    if (pos == lst->size) {
+        block = lst->last;
+        off = block ? block->count : 0u;
+    } else {
+        block = os_dlist_block_find(lst, pos, &off);
+        // 位于块首时优先放入前一个块的尾部, 避免搬移整个块
+        if (0u == off && NULL != block->prev) {
+            block = block->prev;
+            off = block->count;
+        }
+    }
+
+    size_t es = lst->elem_size;
+    if (NULL != block && block->count + count <= lst->unroll) {
+        char * addr = block->data + off * es;
+        memmove(addr + count * es, addr, (block->count - off) * es);
+        memcpy(addr, data, count * es);
+        block->count += count;
+        lst->size += count;
+        OS_STATS_SIZE(lst->stats, lst->size);
+        return true;
+    }
+
+    // 块放不下: off之后的元素拆到新块, 新数据先填满当前块再依次接入新块
+    size_t rest = NULL != block ? block->count - off : 0u;
+    size_t room = NULL != block ? lst->unroll - off : 0u;
+    size_t blocks = (count > room ? (count - room + lst->unroll - 1) / lst->unroll : 0u) + (0u != rest ? 1u : 0u);
+    if (!os_mempool_reserve(lst->pool, blocks))
+        return false;
+
+    if (0u != rest) {
+        os_dlist_block_t * tail = os_dlist_block_new(lst, block);
+        memcpy(tail->data, block->data + off * es, rest * es);
+        tail->count = rest;
+        block->count = off;
+    }
+
+    const char * src = (const char *)data;
+    size_t left = count;
+    while (0u != left) {
+        if (NULL == block || lst->unroll == block->count)
+            block = os_dlist_block_new(lst, block);
+        size_t n = lst->unroll - block->count;
+        if (n > left)
+            n = left;
+        memcpy(block->data + block->count * es, src, n * es);
+        block->count += n;
+        src += n * es;
+        left -= n;
+    }
+    lst->size += count;
+    OS_STATS_SIZE(lst->stats, lst->size);
+
+    return true;
+}
+
+size_t os_dlist_unrolled_remove_if(os_dlist_t * lst, os_dlist_predicate pred, void * ctx, os_dlist_node_t ** removed)
+{
+    size_t count = 0u;
+    size_t es = lst->elem_size;
+    os_dlist_node_t * out = NULL;
+    os_dlist_block_t * block = lst->first;
+    while (NULL != block) {
+        os_dlist_block_t * next = block->next;
+
+        // 块内原地压缩
+        size_t kept = 0u;
+        OS_STATS_ADD(lst->stats, scan_steps, 1);
+        OS_STATS_ADD(lst->stats, compares, block->count);
+        for (size_t i = 0; i < block->count; i++) {
+            char * addr = block->data + i * es;
+            if (pred(addr, ctx)) {
+                if (NULL == removed)
+                    continue;
+                // 元素移出块后没有节点承载, 拷入独立节点; 内存不足时元素留在链表中
+                os_dlist_node_t * node = (os_dlist_node_t *)os_allocator_alloc(&lst->allocator, sizeof(os_dlist_node_t) + es);
+                if (NULL != node) {
+                    OS_STATS_ALLOC(lst->stats, 1, sizeof(os_dlist_node_t) + es);
+#if defined(OS_ENABLE_STATS)
+                    lst->detached_bytes += sizeof(os_dlist_node_t) + es;
+#endif
+                    memcpy(node->data, addr, es);
+                    node->owner = 0u;
+                    node->gen = 0u;
+                    node->prev = out;
+                    node->next = NULL;
+                    if (NULL == out)
+                        *removed = node;
+                    else
+                        out->next = node;
+                    out = node;
+                    continue;
+                }
+            }
+            if (kept != i)
+                memcpy(block->data + kept * es, addr, es);
+            kept++;
+        }
+        count += block->count - kept;
+        block->count = kept;
+
+        if (0u == kept) {
+            os_dlist_block_free(lst, block);
+        } else if (NULL != block->prev && block->prev->count + kept <= lst->unroll) {
+            os_dlist_block_t * prev = block->prev;
+            memcpy(prev->data + prev->count * es, block->data, kept * es);
+            prev->count += kept;
+            os_dlist_block_free(lst, block);
+        }
+        block = next;
+    }
+    lst->size -= count;
+
+    return count;
+}
+
+bool os_dlist_unrolled_sort(os_dlist_t * lst, os_dlist_compare compare)
+{
+    size_t es = lst->elem_size;
+    size_t bytes = lst->size * es;
+    // 临时缓冲区, 按os_allocator.h的约定直接使用malloc
+    char * buf = (char *)malloc(2u * bytes);
+    if (NULL == buf)
+        return false;
+
+    char * src = buf;
+    char * dst = buf + bytes;
+    char * pos = src;
+    for (os_dlist_block_t * block = lst->first; NULL != block; block = block->next) {
+        memcpy(pos, block->data, block->count * es);
+        pos += block->count * es;
+    }
+
+    // 自底向上归并, 每一趟在两个缓冲区之间交替; 相等时取左段的元素, 保证稳定
+    size_t n = lst->size;
+    for (size_t width = 1u; width < n; width *= 2u) {
+        for (size_t lo = 0u; lo < n; lo += 2u * width) {
+            size_t mid = n - lo > width ? lo + width : n;
+            size_t hi = n - mid > width ? mid + width : n;
+            size_t i = lo;
+            size_t j = mid;
+            char * out = dst + lo * es;
+            while (i < mid && j < hi) {
+                OS_STATS_ADD(lst->stats, compares, 1);
+                if (compare(src + j * es, src + i * es))
+                    memcpy(out, src + j++ * es, es);
+                else
+                    memcpy(out, src + i++ * es, es);
+                out += es;
+            }
+            memcpy(out, src + i * es, (mid - i) * es);
+            out += (mid - i) * es;
+            memcpy(out, src + j * es, (hi - j) * es);
+        }
+        char * tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    // 各块的元素个数不变, 按顺序写回
+    pos = src;
+    for (os_dlist_block_t * block = lst->first; NULL != block; block = block->next) {
+        memcpy(block->data, pos, block->count * es);
+        pos += block->count * es;
+    }
+    free(buf);
+
+    return true;
+}
+
+int os_dlist_snapshot_write(void * data, void * ctx)
+{
+    os_dlist_writer_t * writer = (os_dlist_writer_t *)ctx;
+    return 1u == fwrite(data, writer->elem_size, 1u, writer->fp) ? 0 : -1;
+}
+
+os_dlist_t * os_dlist_new(const size_t elem_size, const size_t unroll, const size_t chunk_size, const os_allocator_t * allocator)
+{
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_dlist_t * lst = (os_dlist_t *)os_allocator_calloc(allocator, sizeof(os_dlist_t));
+    if (NULL == lst)
+        return NULL;
+
+    lst->elem_size = elem_size;
+    lst->unroll = unroll;
+    lst->node_size = 0u != unroll ? sizeof(os_dlist_block_t) + unroll * elem_size : sizeof(os_dlist_node_t) + elem_size;
+    lst->allocator = *allocator;
+    lst->pool = os_mempool_create_ex(lst->node_size, chunk_size, allocator);
+    if (NULL == lst->pool) {
+        os_allocator_free(allocator, lst, sizeof(os_dlist_t));
+        return NULL;
+    }
+    OS_STATS_ALLOC(lst->stats, 1, sizeof(os_dlist_t));
+
+    do {
+        lst->id = (uint32_t)atomic_fetch_add(&os_dlist_next_id, 1u);
+    } while (0u == lst->id);
+
+    return lst;
+}
+
+os_dlist_node_t * os_dlist_alloc_node(os_dlist_t * lst)
+{
+    os_dlist_node_t * node = (os_dlist_node_t *)os_mempool_alloc(lst->pool);
+    if (NULL == node)
+        return NULL;
+
+    node->owner = lst->id;
+    node->gen = ++lst->gen;
+    OS_STATS_ALLOC(lst->stats, 1, lst->node_size);
+
+    return node;
+}
+
+void os_dlist_free_node(os_dlist_t * lst, os_dlist_node_t * node)
+{
+    node->owner = 0u;
+    os_mempool_free(lst->pool, node);
+    OS_STATS_FREE(lst->stats, 1, lst->node_size);
 }
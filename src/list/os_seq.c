@@ -0,0 +1,486 @@
+﻿#include "os_seq.h"
+#include "os_mempool.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#define OS_SEQ_FANOUT      32u    // 内部节点最多的子节点数
+#define OS_SEQ_LEAF_BYTES  1024u  // 叶子数据区的字节数
+#define OS_SEQ_LEAF_MIN    16u    // 叶子最少容纳的元素个数
+#define OS_SEQ_MAX_DEPTH   32u    // 内部节点最多的层数
+
+typedef struct _os_seq_inner_t os_seq_inner_t;
+
+// 叶子按顺序串成双链表, 游标沿链表移动
+struct _os_seq_leaf_t {
+    os_seq_leaf_t * prev;    // 前一个叶子
+    os_seq_leaf_t * next;    // 后一个叶子
+    size_t count;            // 元素个数
+    char data[0];            // 元素
+};
+
+// 内部节点记录每棵子树的元素个数, 按位置查找时逐层扣减
+struct _os_seq_inner_t {
+    size_t count;                      // 子节点个数
+    size_t sizes[OS_SEQ_FANOUT];       // 子树的元素个数
+    void * children[OS_SEQ_FANOUT];    // 子节点, 最底层内部节点的子节点为叶子
+};
+
+struct _os_seq_t {
+    size_t size;                 // 序列长度
+    size_t elem_size;            // 元素大小
+    size_t leaf_cap;             // 叶子容量
+    size_t height;               // 内部节点层数, 0表示根为叶子
+    void * root;                 // 根节点
+    os_seq_leaf_t * head;        // 首个叶子
+    os_seq_leaf_t * tail;        // 末尾叶子
+    os_mempool_t * leaf_pool;    // 叶子池
+    os_mempool_t * inner_pool;   // 内部节点池
+    os_allocator_t allocator;    // 分配器, 序列本身和节点池经由它申请
+};
+
+// 自根到叶子的查找路径
+typedef struct _os_seq_path_t {
+    os_seq_inner_t * nodes[OS_SEQ_MAX_DEPTH];  // 经过的内部节点
+    size_t slots[OS_SEQ_MAX_DEPTH];            // 在各内部节点中选择的子节点
+} os_seq_path_t;
+
+// 查找pos所在的叶子, insert为true时位于子树末尾的位置留在该子树
+static os_seq_leaf_t * os_seq_descend(const os_seq_t * seq, size_t pos, bool insert, os_seq_path_t * path, size_t * off);
+// 获取子树的元素个数
+static size_t os_seq_total(const void * node, bool is_leaf);
+// 在叶子的off处放入数据
+static void os_seq_leaf_put(const os_seq_t * seq, os_seq_leaf_t * leaf, size_t off, const void * data);
+// 将叶子从叶子链表中摘除并释放
+static void os_seq_leaf_free(os_seq_t * seq, os_seq_leaf_t * leaf);
+// 在内部节点的slot处插入子节点
+static void os_seq_inner_insert(os_seq_inner_t * inner, size_t slot, void * child, size_t size);
+// 删除内部节点slot处的子节点
+static void os_seq_inner_remove(os_seq_inner_t * inner, size_t slot);
+// 叶子已满时分裂插入, 并向上传递分裂
+static bool os_seq_insert_split(os_seq_t * seq, os_seq_path_t * path, os_seq_leaf_t * leaf, size_t off, const void * data);
+// 删除后自底向上回收空节点, 合并过小的相邻节点
+static void os_seq_rebalance(os_seq_t * seq, os_seq_path_t * path, os_seq_leaf_t * leaf);
+
+os_seq_t * os_seq_create(const size_t elem_size)
+{
+    return os_seq_create_ex(elem_size, NULL);
+}
+
+os_seq_t * os_seq_create_ex(const size_t elem_size, const os_allocator_t * allocator)
+{
+    if (0u == elem_size)
+        return NULL;
+
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_seq_t * seq = (os_seq_t *)os_allocator_calloc(allocator, sizeof(os_seq_t));
+    if (NULL == seq)
+        return NULL;
+
+    seq->allocator = *allocator;
+    seq->elem_size = elem_size;
+    seq->leaf_cap = OS_SEQ_LEAF_BYTES / elem_size;
+    if (seq->leaf_cap < OS_SEQ_LEAF_MIN)
+        seq->leaf_cap = OS_SEQ_LEAF_MIN;
+
+    seq->leaf_pool = os_mempool_create_ex(sizeof(os_seq_leaf_t) + seq->leaf_cap * elem_size, 0u, allocator);
+    seq->inner_pool = os_mempool_create_ex(sizeof(os_seq_inner_t), 0u, allocator);
+    if (NULL == seq->leaf_pool || NULL == seq->inner_pool) {
+        os_mempool_destroy(&seq->leaf_pool);
+        os_mempool_destroy(&seq->inner_pool);
+        os_allocator_free(allocator, seq, sizeof(os_seq_t));
+        return NULL;
+    }
+
+    return seq;
+}
+
+void os_seq_destroy(os_seq_t ** seq)
+{
+    if (NULL == seq || NULL == *seq)
+        return;
+
+    os_mempool_destroy(&(*seq)->leaf_pool);
+    os_mempool_destroy(&(*seq)->inner_pool);
+
+    os_allocator_t allocator = (*seq)->allocator;
+    os_allocator_free(&allocator, *seq, sizeof(os_seq_t));
+    *seq = NULL;
+}
+
+void os_seq_clear(os_seq_t * seq)
+{
+    if (NULL == seq)
+        return;
+
+    // 节点全部来自节点池, 整块释放即可
+    os_mempool_clear(seq->leaf_pool);
+    os_mempool_clear(seq->inner_pool);
+    seq->size = 0u;
+    seq->height = 0u;
+    seq->root = NULL;
+    seq->head = NULL;
+    seq->tail = NULL;
+}
+
+bool os_seq_empty(const os_seq_t * seq)
+{
+    return seq ? (0u == seq->size) : true;
+}
+
+size_t os_seq_size(const os_seq_t * seq)
+{
+    return seq ? seq->size : 0u;
+}
+
+bool os_seq_add(os_seq_t * seq, const void * data)
+{
+    if (NULL == seq)
+        return false;
+
+    return os_seq_insert(seq, seq->size, data);
+}
+
+bool os_seq_insert(os_seq_t * seq, size_t pos, const void * data)
+{
+    if (NULL == seq || NULL == data)
+        return false;
+
+    if (pos > seq->size)
+        pos = seq->size;
+
+    if (NULL == seq->root) {
+        os_seq_leaf_t * leaf = (os_seq_leaf_t *)os_mempool_alloc(seq->leaf_pool);
+        if (NULL == leaf)
+            return false;
+        leaf->prev = NULL;
+        leaf->next = NULL;
+        leaf->count = 0u;
+        seq->root = leaf;
+        seq->head = leaf;
+        seq->tail = leaf;
+    }
+
+    os_seq_path_t path;
+    size_t off = 0u;
+    os_seq_leaf_t * leaf = os_seq_descend(seq, pos, true, &path, &off);
+    if (leaf->count == seq->leaf_cap)
+        return os_seq_insert_split(seq, &path, leaf, off, data);
+
+    os_seq_leaf_put(seq, leaf, off, data);
+    for (size_t i = 0; i < seq->height; i++)
+        path.nodes[i]->sizes[path.slots[i]]++;
+    seq->size++;
+
+    return true;
+}
+
+bool os_seq_erase(os_seq_t * seq, const size_t pos)
+{
+    if (NULL == seq || pos >= seq->size)
+        return false;
+
+    if (1u == seq->size) {
+        os_seq_clear(seq);
+        return true;
+    }
+
+    os_seq_path_t path;
+    size_t off = 0u;
+    os_seq_leaf_t * leaf = os_seq_descend(seq, pos, false, &path, &off);
+    memmove(leaf->data + off * seq->elem_size, leaf->data + (off + 1) * seq->elem_size,
+            (leaf->count - off - 1) * seq->elem_size);
+    leaf->count--;
+    for (size_t i = 0; i < seq->height; i++)
+        path.nodes[i]->sizes[path.slots[i]]--;
+    seq->size--;
+
+    os_seq_rebalance(seq, &path, leaf);
+
+    return true;
+}
+
+void * os_seq_at(const os_seq_t * seq, const size_t pos)
+{
+    if (NULL == seq || pos >= seq->size)
+        return NULL;
+
+    size_t off = 0u;
+    os_seq_leaf_t * leaf = os_seq_descend(seq, pos, false, NULL, &off);
+
+    return leaf->data + off * seq->elem_size;
+}
+
+os_seq_cursor_t os_seq_cursor(const os_seq_t * seq, const size_t pos)
+{
+    os_seq_cursor_t cur = { seq, NULL, 0u };
+    if (NULL == seq || pos >= seq->size)
+        return cur;
+
+    cur.leaf = os_seq_descend(seq, pos, false, NULL, &cur.index);
+
+    return cur;
+}
+
+bool os_seq_cursor_valid(const os_seq_cursor_t * cur)
+{
+    return cur ? (NULL != cur->leaf) : false;
+}
+
+void * os_seq_cursor_get(const os_seq_cursor_t * cur)
+{
+    if (NULL == cur || NULL == cur->leaf)
+        return NULL;
+
+    return cur->leaf->data + cur->index * cur->seq->elem_size;
+}
+
+bool os_seq_cursor_next(os_seq_cursor_t * cur)
+{
+    if (NULL == cur || NULL == cur->leaf)
+        return false;
+
+    if (++cur->index < cur->leaf->count)
+        return true;
+
+    // 叶子不会为空, 下一个叶子的首元素即为后继
+    cur->leaf = cur->leaf->next;
+    cur->index = 0u;
+
+    return NULL != cur->leaf;
+}
+
+bool os_seq_cursor_prev(os_seq_cursor_t * cur)
+{
+    if (NULL == cur || NULL == cur->leaf)
+        return false;
+
+    if (cur->index > 0u) {
+        cur->index--;
+        return true;
+    }
+
+    cur->leaf = cur->leaf->prev;
+    cur->index = cur->leaf ? cur->leaf->count - 1 : 0u;
+
+    return NULL != cur->leaf;
+}
+
+os_seq_leaf_t * os_seq_descend(const os_seq_t * seq, size_t pos, const bool insert, os_seq_path_t * path, size_t * off)
+{
+    void * node = seq->root;
+    for (size_t level = 0; level < seq->height; level++) {
+        os_seq_inner_t * inner = (os_seq_inner_t *)node;
+        size_t slot = 0u;
+        while (slot + 1 < inner->count && (insert ? pos > inner->sizes[slot] : pos >= inner->sizes[slot])) {
+            pos -= inner->sizes[slot];
+            slot++;
+        }
+        if (NULL != path) {
+            path->nodes[level] = inner;
+            path->slots[level] = slot;
+        }
+        node = inner->children[slot];
+    }
+
+    *off = pos;
+    return (os_seq_leaf_t *)node;
+}
+
+size_t os_seq_total(const void * node, const bool is_leaf)
+{
+    if (is_leaf)
+        return ((const os_seq_leaf_t *)node)->count;
+
+    const os_seq_inner_t * inner = (const os_seq_inner_t *)node;
+    size_t total = 0u;
+    for (size_t i = 0; i < inner->count; i++)
+        total += inner->sizes[i];
+
+    return total;
+}
+
+void os_seq_leaf_put(const os_seq_t * seq, os_seq_leaf_t * leaf, const size_t off, const void * data)
+{
+    char * addr = leaf->data + off * seq->elem_size;
+    memmove(addr + seq->elem_size, addr, (leaf->count - off) * seq->elem_size);
+    memcpy(addr, data, seq->elem_size);
+    leaf->count++;
+}
+
+void os_seq_leaf_free(os_seq_t * seq, os_seq_leaf_t * leaf)
+{
+    if (NULL == leaf->prev)
+        seq->head = leaf->next;
+    else
+        leaf->prev->next = leaf->next;
+    if (NULL == leaf->next)
+        seq->tail = leaf->prev;
+    else
+        leaf->next->prev = leaf->prev;
+
+    os_mempool_free(seq->leaf_pool, leaf);
+}
+
+void os_seq_inner_insert(os_seq_inner_t * inner, const size_t slot, void * child, const size_t size)
+{
+    size_t move = inner->count - slot;
+    memmove(inner->sizes + slot + 1, inner->sizes + slot, move * sizeof(size_t));
+    memmove(inner->children + slot + 1, inner->children + slot, move * sizeof(void *));
+    inner->sizes[slot] = size;
+    inner->children[slot] = child;
+    inner->count++;
+}
+
+void os_seq_inner_remove(os_seq_inner_t * inner, const size_t slot)
+{
+    size_t move = inner->count - slot - 1;
+    memmove(inner->sizes + slot, inner->sizes + slot + 1, move * sizeof(size_t));
+    memmove(inner->children + slot, inner->children + slot + 1, move * sizeof(void *));
+    inner->count--;
+}
+
+bool os_seq_insert_split(os_seq_t * seq, os_seq_path_t * path, os_seq_leaf_t * leaf, const size_t off, const void * data)
+{
+    // 自底向上连续已满的内部节点都要分裂, 全部满时根也要分裂
+    size_t splits = 0u;
+    while (splits < seq->height && OS_SEQ_FANOUT == path->nodes[seq->height - 1 - splits]->count)
+        splits++;
+    size_t inners = splits == seq->height ? splits + 1 : splits;
+    if (seq->height + 1 >= OS_SEQ_MAX_DEPTH && splits == seq->height)
+        return false;
+
+    // 先预留全部节点, 之后的修改不会失败, 保证失败时序列不变
+    if (!os_mempool_reserve(seq->leaf_pool, 1u) || !os_mempool_reserve(seq->inner_pool, inners))
+        return false;
+
+    // 叶子对半分裂, 新叶子接在其后
+    os_seq_leaf_t * right = (os_seq_leaf_t *)os_mempool_alloc(seq->leaf_pool);
+    size_t mid = leaf->count / 2;
+    right->count = leaf->count - mid;
+    memcpy(right->data, leaf->data + mid * seq->elem_size, right->count * seq->elem_size);
+    leaf->count = mid;
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (NULL == leaf->next)
+        seq->tail = right;
+    else
+        leaf->next->prev = right;
+    leaf->next = right;
+
+    if (off > mid)
+        os_seq_leaf_put(seq, right, off - mid, data);
+    else
+        os_seq_leaf_put(seq, leaf, off, data);
+    seq->size++;
+
+    // left分裂出了split, 需要在父节点中插入split
+    void * left = leaf;
+    void * split = right;
+    bool is_leaf = true;
+    for (size_t level = seq->height; level-- > 0;) {
+        os_seq_inner_t * inner = path->nodes[level];
+        size_t slot = path->slots[level];
+        if (NULL == split) {
+            inner->sizes[slot]++;
+            continue;
+        }
+
+        size_t split_size = os_seq_total(split, is_leaf);
+        inner->sizes[slot] = os_seq_total(left, is_leaf);
+        if (inner->count < OS_SEQ_FANOUT) {
+            os_seq_inner_insert(inner, slot + 1, split, split_size);
+            split = NULL;
+            continue;
+        }
+
+        // 内部节点对半分裂
+        size_t half = OS_SEQ_FANOUT / 2;
+        os_seq_inner_t * sibling = (os_seq_inner_t *)os_mempool_alloc(seq->inner_pool);
+        sibling->count = inner->count - half;
+        memcpy(sibling->sizes, inner->sizes + half, sibling->count * sizeof(size_t));
+        memcpy(sibling->children, inner->children + half, sibling->count * sizeof(void *));
+        inner->count = half;
+        if (slot + 1 <= half)
+            os_seq_inner_insert(inner, slot + 1, split, split_size);
+        else
+            os_seq_inner_insert(sibling, slot + 1 - half, split, split_size);
+
+        left = inner;
+        split = sibling;
+        is_leaf = false;
+    }
+
+    if (NULL != split) {
+        os_seq_inner_t * root = (os_seq_inner_t *)os_mempool_alloc(seq->inner_pool);
+        root->count = 2u;
+        root->sizes[0] = os_seq_total(left, is_leaf);
+        root->sizes[1] = os_seq_total(split, is_leaf);
+        root->children[0] = left;
+        root->children[1] = split;
+        seq->root = root;
+        seq->height++;
+    }
+
+    return true;
+}
+
+void os_seq_rebalance(os_seq_t * seq, os_seq_path_t * path, os_seq_leaf_t * leaf)
+{
+    void * child = leaf;
+    bool is_leaf = true;
+    for (size_t level = seq->height; level-- > 0;) {
+        os_seq_inner_t * inner = path->nodes[level];
+        size_t slot = path->slots[level];
+        size_t cap = is_leaf ? seq->leaf_cap : OS_SEQ_FANOUT;
+        size_t count = is_leaf ? ((os_seq_leaf_t *)child)->count : ((os_seq_inner_t *)child)->count;
+        if (count >= cap / 4)
+            break;
+
+        if (0u == count) {
+            if (is_leaf)
+                os_seq_leaf_free(seq, (os_seq_leaf_t *)child);
+            else
+                os_mempool_free(seq->inner_pool, child);
+            os_seq_inner_remove(inner, slot);
+        } else if (inner->count > 1) {
+            // 与相邻节点合并, 右边并入左边
+            size_t lo = slot > 0 ? slot - 1 : slot;
+            if (is_leaf) {
+                os_seq_leaf_t * a = (os_seq_leaf_t *)inner->children[lo];
+                os_seq_leaf_t * b = (os_seq_leaf_t *)inner->children[lo + 1];
+                if (a->count + b->count > cap)
+                    break;
+                memcpy(a->data + a->count * seq->elem_size, b->data, b->count * seq->elem_size);
+                a->count += b->count;
+                os_seq_leaf_free(seq, b);
+            } else {
+                os_seq_inner_t * a = (os_seq_inner_t *)inner->children[lo];
+                os_seq_inner_t * b = (os_seq_inner_t *)inner->children[lo + 1];
+                if (a->count + b->count > cap)
+                    break;
+                memcpy(a->sizes + a->count, b->sizes, b->count * sizeof(size_t));
+                memcpy(a->children + a->count, b->children, b->count * sizeof(void *));
+                a->count += b->count;
+                os_mempool_free(seq->inner_pool, b);
+            }
+            inner->sizes[lo] += inner->sizes[lo + 1];
+            os_seq_inner_remove(inner, lo + 1);
+        } else {
+            break;
+        }
+
+        child = inner;
+        is_leaf = false;
+    }
+
+    // 根只剩一个子节点时降低高度
+    while (0u != seq->height && 1u == ((os_seq_inner_t *)seq->root)->count) {
+        os_seq_inner_t * root = (os_seq_inner_t *)seq->root;
+        seq->root = root->children[0];
+        seq->height--;
+        os_mempool_free(seq->inner_pool, root);
+    }
+}
@@ -1,31 +1,55 @@
 ﻿#include "os_slist.h"
+#include "os_mempool.h"
+#include "os_stats.h"
 
 #include <string.h>
-#include <malloc.h>
 
 struct _os_slist_node_t {
     os_slist_node_t * next;  // 下一个节点
     char data[0];            // 数据
 };
 
+typedef struct _os_slist_match_t {
+    void * data;                // 要删除的数据
+    os_slist_compare compare;   // 比较函数
+} os_slist_match_t;
+
 struct _os_slist_t {
     size_t size;            // 链表长度
     size_t node_size;       // 节点大小
     size_t elem_size;       // 元素大小
     os_slist_node_t * head; // 头节点
     os_slist_node_t * tail; // 尾节点
+    os_mempool_t * pool;    // 节点池
+    os_allocator_t allocator; // 分配器, 链表本身和节点池经由它申请
+#if defined(OS_ENABLE_STATS)
+    os_stats_t stats;       // 运行统计
+#endif
 };
 
+// 创建链表, allocator为NULL时使用默认分配器
+static os_slist_t * os_slist_new(size_t elem_size, size_t chunk_size, const os_allocator_t * allocator);
+// os_slist_delete_ex的删除条件
+static bool os_slist_match(const void * data, void * ctx);
+// 查找从head开始的非递减段, 返回段尾
+static os_slist_node_t * os_slist_run(os_slist_t * lst, os_slist_node_t * head, os_slist_compare compare);
+// 稳定合并两个有序段, 返回合并后的头, tail返回尾
+static os_slist_node_t * os_slist_merge_run(os_slist_t * lst, os_slist_node_t * a, os_slist_node_t * b,
+                                            os_slist_compare compare, os_slist_node_t ** tail);
+
 os_slist_t * os_slist_create(const size_t elem_size)
 {
-    os_slist_t * lst = (os_slist_t *)calloc(1, sizeof(os_slist_t));
-    if (NULL == lst)
-        return NULL;
+    return os_slist_create_pool(elem_size, 0u);
+}
 
-    lst->elem_size = elem_size;
-    lst->node_size = sizeof(os_slist_node_t) + elem_size;
+os_slist_t * os_slist_create_pool(const size_t elem_size, const size_t chunk_size)
+{
+    return os_slist_new(elem_size, chunk_size, NULL);
+}
 
-    return lst;
+os_slist_t * os_slist_create_ex(const size_t elem_size, const os_allocator_t * allocator)
+{
+    return os_slist_new(elem_size, 0u, allocator);
 }
 
 void os_slist_destroy(os_slist_t ** lst)
@@ -34,8 +58,10 @@ void os_slist_destroy(os_slist_t ** lst)
         return;
 
     os_slist_clear(*lst);
+    os_mempool_destroy(&(*lst)->pool);
 
-    free(*lst);
+    os_allocator_t allocator = (*lst)->allocator;
+    os_allocator_free(&allocator, *lst, sizeof(os_slist_t));
     *lst = NULL;
 }
 
@@ -44,13 +70,12 @@ void os_slist_clear(os_slist_t * lst)
     if (NULL == lst)
         return;
 
-    os_slist_node_t * node = NULL;
-    while (NULL != lst->head) {
-        node = lst->head;
-        lst->head = node->next;
-        free(node);
-        --lst->size;
-    }
+    // 节点全部来自节点池, 整块释放即可
+    os_mempool_clear(lst->pool);
+    OS_STATS_RELEASE(lst->stats, sizeof(os_slist_t), lst->node_size);
+    lst->head = NULL;
+    lst->tail = NULL;
+    lst->size = 0u;
 }
 
 bool os_slist_empty(const os_slist_t * lst)
@@ -71,11 +96,12 @@ bool os_slist_add(os_slist_t * lst, void * data)
     if (NULL == lst)
         return false;
 
-    os_slist_node_t * node = (os_slist_node_t *)calloc(1, lst->node_size);
+    os_slist_node_t * node = (os_slist_node_t *)os_mempool_alloc(lst->pool);
     if (NULL == node)
         return false;
 
     memcpy(node->data, data, lst->elem_size);
+    node->next = NULL;
 
     if (NULL == lst->head) {
         lst->head = node;
@@ -86,6 +112,46 @@ bool os_slist_add(os_slist_t * lst, void * data)
     }
 
     ++lst->size;
+    OS_STATS_ALLOC(lst->stats, 1, lst->node_size);
+    OS_STATS_SIZE(lst->stats, lst->size);
+
+    return true;
+}
+
+bool os_slist_add_n(os_slist_t * lst, const void * data, const size_t count)
+{
+    if (NULL == lst || NULL == data)
+        return false;
+
+    if (0u == count)
+        return true;
+
+    // 一次预留全部节点, 之后的分配不会失败
+    if (!os_mempool_reserve(lst->pool, count))
+        return false;
+
+    // 先在本地串成链, 最后一次性接到尾部
+    const char * src = (const char *)data;
+    os_slist_node_t * first = NULL;
+    os_slist_node_t ** link = &first;
+    os_slist_node_t * node = NULL;
+    for (size_t i = 0; i < count; i++) {
+        node = (os_slist_node_t *)os_mempool_alloc(lst->pool);
+        memcpy(node->data, src, lst->elem_size);
+        src += lst->elem_size;
+        *link = node;
+        link = &node->next;
+    }
+    node->next = NULL;
+
+    if (NULL == lst->tail)
+        lst->head = first;
+    else
+        lst->tail->next = first;
+    lst->tail = node;
+    lst->size += count;
+    OS_STATS_ALLOC(lst->stats, count, count * lst->node_size);
+    OS_STATS_SIZE(lst->stats, lst->size);
 
     return true;
 }
@@ -98,17 +164,19 @@ bool os_slist_insert(os_slist_t * lst, size_t pos, void * data)
     if (pos >= lst->size)
         return os_slist_add(lst, data);
 
-    os_slist_node_t * node = (os_slist_node_t *)calloc(1, lst->node_size);
+    os_slist_node_t * node = (os_slist_node_t *)os_mempool_alloc(lst->pool);
     if (NULL == node)
         return false;
 
     memcpy(node->data, data, lst->elem_size);
+    node->next = NULL;
 
     if (0ul == pos) {
         node->next = lst->head;
         lst->head = node;
     } else {
         os_slist_node_t * tmp = lst->head;
+        OS_STATS_ADD(lst->stats, scan_steps, pos - 1);
         while (pos > 1) {
             tmp = tmp->next;
             pos--;
@@ -118,6 +186,8 @@ bool os_slist_insert(os_slist_t * lst, size_t pos, void * data)
     }
 
     ++lst->size;
+    OS_STATS_ALLOC(lst->stats, 1, lst->node_size);
+    OS_STATS_SIZE(lst->stats, lst->size);
 
     return true;
 }
@@ -130,13 +200,17 @@ os_slist_node_t * os_slist_delete(os_slist_t * lst, os_slist_node_t * node)
     os_slist_node_t * tmp = lst->head;
     if (node == tmp) {
         lst->head = tmp->next;
-        free(node);
+        if (NULL == lst->head)
+            lst->tail = NULL;
+        os_mempool_free(lst->pool, node);
+        OS_STATS_FREE(lst->stats, 1, lst->node_size);
         --lst->size;
         return lst->head;
     }
 
     os_slist_node_t * res = NULL;
     while (tmp->next) {
+        OS_STATS_ADD(lst->stats, scan_steps, 1);
         if (tmp->next != node) {
             tmp = tmp->next;
             continue;
@@ -144,8 +218,11 @@ os_slist_node_t * os_slist_delete(os_slist_t * lst, os_slist_node_t * node)
 
         res = tmp->next->next;
         tmp->next = res;
+        if (node == lst->tail)
+            lst->tail = tmp;
         --lst->size;
-        free(node);
+        os_mempool_free(lst->pool, node);
+        OS_STATS_FREE(lst->stats, 1, lst->node_size);
         break;
     }
 
@@ -157,16 +234,68 @@ bool os_slist_delete_ex(os_slist_t * lst, void * data, os_slist_compare compare)
     if (NULL == lst || NULL == data)
         return true;
 
-    os_slist_node_t * node = lst->head;
-    while (node) {
-        if (!compare(node->data, data)) {
-            node = node->next;
+    if (NULL == compare)
+        return false;
+
+    os_slist_match_t match = { data, compare };
+    os_slist_remove_if(lst, os_slist_match, &match, NULL);
+
+    return true;
+}
+
+size_t os_slist_remove_if(os_slist_t * lst, os_slist_predicate pred, void * ctx, os_slist_node_t ** removed)
+{
+    if (NULL != removed)
+        *removed = NULL;
+
+    if (NULL == lst || NULL == pred)
+        return 0u;
+
+    // link指向当前节点的前驱中的next字段, 删除时无需回头查找前驱
+    size_t count = 0u;
+    os_slist_node_t * last = NULL;
+    os_slist_node_t ** link = &lst->head;
+    os_slist_node_t ** out = removed;
+    os_slist_node_t * node = NULL;
+    while (NULL != (node = *link)) {
+        OS_STATS_ADD(lst->stats, scan_steps, 1);
+        OS_STATS_ADD(lst->stats, compares, 1);
+        if (!pred(node->data, ctx)) {
+            last = node;
+            link = &node->next;
             continue;
         }
-        node = os_slist_delete(lst, node);
+
+        *link = node->next;
+        ++count;
+        if (NULL != out) {
+            *out = node;
+            out = &node->next;
+        } else {
+            os_mempool_free(lst->pool, node);
+            OS_STATS_FREE(lst->stats, 1, lst->node_size);
+        }
     }
 
-    return true;
+    if (NULL != out)
+        *out = NULL;
+    lst->tail = last;
+    lst->size -= count;
+
+    return count;
+}
+
+void os_slist_free_nodes(os_slist_t * lst, os_slist_node_t * nodes)
+{
+    if (NULL == lst)
+        return;
+
+    while (NULL != nodes) {
+        os_slist_node_t * next = nodes->next;
+        os_mempool_free(lst->pool, nodes);
+        OS_STATS_FREE(lst->stats, 1, lst->node_size);
+        nodes = next;
+    }
 }
 
 os_slist_node_t * os_slist_head(const os_slist_t * lst)
@@ -215,10 +344,19 @@ os_slist_t * os_slist_merge(os_slist_t * lst1, os_slist_t * lst2, os_slist_compa
     if (NULL == lst2 || 0u == lst2->size)
         return lst1;
 
+    // lst2的节点归lst1所有, 节点池一并转移
+    if (!os_mempool_merge(lst1->pool, lst2->pool))
+        return NULL;
+    OS_STATS_MOVE(lst1->stats, lst2->stats, sizeof(os_slist_t), lst1->node_size);
+    OS_STATS_SIZE(lst1->stats, lst1->size + lst2->size);
+
     if (NULL == compare) {
         lst1->tail->next = lst2->head;
         lst1->tail = lst2->tail;
         lst1->size += lst2->size;
+        lst2->head = NULL;
+        lst2->tail = NULL;
+        lst2->size = 0u;
         return lst1;
     }
 
@@ -229,6 +367,7 @@ os_slist_t * os_slist_merge(os_slist_t * lst1, os_slist_t * lst2, os_slist_compa
     os_slist_node_t * tmp = NULL;
     os_slist_node_t * node = NULL;
     while (head1 && head2) {
+        OS_STATS_ADD(lst1->stats, compares, 1);
         if (compare(head1->data, head2->data)) {
             node = head1;
             head1 = head1->next;
@@ -256,6 +395,154 @@ os_slist_t * os_slist_merge(os_slist_t * lst1, os_slist_t * lst2, os_slist_compa
 
     lst1->head = head;
     lst1->size += lst2->size;
+    lst2->head = NULL;
+    lst2->tail = NULL;
+    lst2->size = 0u;
 
     return lst1;
 }
+
+bool os_slist_sort(os_slist_t * lst, os_slist_compare compare)
+{
+    if (NULL == lst || NULL == compare)
+        return false;
+
+    if (lst->size < 2u)
+        return true;
+
+    // 自底向上的自然归并: 每一趟把相邻的两个有序段合并, 直到只剩一段
+    size_t runs = 0u;
+    do {
+        os_slist_node_t * head = lst->head;
+        os_slist_node_t * tail = NULL;
+        os_slist_node_t ** link = &lst->head;
+        runs = 0u;
+        while (NULL != head) {
+            os_slist_node_t * a = head;
+            os_slist_node_t * a_end = os_slist_run(lst, a, compare);
+            os_slist_node_t * b = a_end->next;
+            a_end->next = NULL;
+            ++runs;
+            if (NULL == b) {
+                *link = a;
+                tail = a_end;
+                break;
+            }
+
+            os_slist_node_t * b_end = os_slist_run(lst, b, compare);
+            head = b_end->next;
+            b_end->next = NULL;
+            *link = os_slist_merge_run(lst, a, b, compare, &tail);
+            link = &tail->next;
+        }
+        lst->tail = tail;
+    } while (runs > 1u);
+
+    return true;
+}
+
+bool os_slist_stats(const os_slist_t * lst, os_stats_t * stats)
+{
+    if (NULL == stats)
+        return false;
+
+    memset(stats, 0, sizeof(os_stats_t));
+#if defined(OS_ENABLE_STATS)
+    if (NULL == lst)
+        return false;
+
+    *stats = lst->stats;
+    return true;
+#else
+    return false;
+#endif
+}
+
+int os_slist_foreach(const os_slist_t * lst, os_slist_visitor visitor, void * ctx)
+{
+    if (NULL == lst || NULL == visitor)
+        return 0;
+
+    // 按OS_PREFETCH的约定预取后继的后继
+    int ret = 0;
+    os_slist_node_t * node = lst->head;
+    while (NULL != node) {
+        os_slist_node_t * next = node->next;
+        if (NULL != next)
+            OS_PREFETCH(next->next);
+        ret = visitor(node->data, ctx);
+        if (0 != ret)
+            break;
+        node = next;
+    }
+
+    return ret;
+}
+
+os_slist_node_t * os_slist_run(os_slist_t * lst, os_slist_node_t * head, os_slist_compare compare)
+{
+    while (NULL != head->next) {
+        OS_STATS_ADD(lst->stats, compares, 1);
+        if (compare(head->next->data, head->data))
+            break;
+        head = head->next;
+    }
+
+    return head;
+}
+
+os_slist_node_t * os_slist_merge_run(os_slist_t * lst, os_slist_node_t * a, os_slist_node_t * b,
+                                     os_slist_compare compare, os_slist_node_t ** tail)
+{
+    // 相等时取a中的节点, 保证稳定
+    os_slist_node_t * head = NULL;
+    os_slist_node_t ** link = &head;
+    while (NULL != a && NULL != b) {
+        OS_STATS_ADD(lst->stats, compares, 1);
+        if (compare(b->data, a->data)) {
+            *link = b;
+            link = &b->next;
+            b = b->next;
+        } else {
+            *link = a;
+            link = &a->next;
+            a = a->next;
+        }
+    }
+
+    os_slist_node_t * rest = NULL != a ? a : b;
+    *link = rest;
+    while (NULL != rest->next)
+        rest = rest->next;
+    *tail = rest;
+
+    return head;
+}
+
+os_slist_t * os_slist_new(const size_t elem_size, const size_t chunk_size, const os_allocator_t * allocator)
+{
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_slist_t * lst = (os_slist_t *)os_allocator_calloc(allocator, sizeof(os_slist_t));
+    if (NULL == lst)
+        return NULL;
+
+    lst->elem_size = elem_size;
+    lst->node_size = sizeof(os_slist_node_t) + elem_size;
+    lst->allocator = *allocator;
+    lst->pool = os_mempool_create_ex(lst->node_size, chunk_size, allocator);
+    if (NULL == lst->pool) {
+        os_allocator_free(allocator, lst, sizeof(os_slist_t));
+        return NULL;
+    }
+    OS_STATS_ALLOC(lst->stats, 1, sizeof(os_slist_t));
+
+    return lst;
+}
+
+bool os_slist_match(const void * data, void * ctx)
+{
+    os_slist_match_t * match = (os_slist_match_t *)ctx;
+    return match->compare(data, match->data);
+}
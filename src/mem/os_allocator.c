@@ -0,0 +1,198 @@
+﻿#include "os_allocator.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OS_ARENA_ALIGN          (2 * sizeof(void *))  // 分配对齐, 与malloc保持一致
+#define OS_ARENA_DEFAULT_BLOCK  65536u                // 默认内存块字节数
+
+#define OS_ARENA_ROUND_UP(n, a) (((n) + (a) - 1) / (a) * (a))
+
+typedef struct _os_arena_block_t os_arena_block_t;
+
+struct _os_arena_block_t {
+    os_arena_block_t * next;    // 上一个申请的内存块
+};
+
+struct _os_arena_t {
+    size_t block_size;          // 默认内存块的可用字节数
+    os_arena_block_t * blocks;  // 已申请的默认大小内存块, 最近申请的在前, 首个块在末尾
+    os_arena_block_t * large;   // 超过块大小的申请单独占用的内存块
+    char * cursor;              // 当前块未使用区域起始
+    char * limit;               // 当前块未使用区域结束
+    size_t used;                // 已分配的字节数
+};
+
+#define OS_ARENA_BLOCK_HDR OS_ARENA_ROUND_UP(sizeof(os_arena_block_t), OS_ARENA_ALIGN)
+
+// 默认分配器
+static void * os_allocator_malloc(void * ctx, size_t size);
+static void os_allocator_release(void * ctx, void * ptr, size_t size);
+// 内存区分配器的alloc
+static void * os_arena_allocator_alloc(void * ctx, size_t size);
+// 申请可用字节数为size的内存块并设为当前块
+static bool os_arena_grow(os_arena_t * arena, size_t size);
+// 释放链表上的全部内存块
+static void os_arena_free_blocks(os_arena_block_t * block);
+
+static const os_allocator_t os_allocator_malloc_free = { os_allocator_malloc, os_allocator_release, NULL };
+
+const os_allocator_t * os_allocator_default(void)
+{
+    return &os_allocator_malloc_free;
+}
+
+void * os_allocator_alloc(const os_allocator_t * allocator, const size_t size)
+{
+    if (NULL == allocator)
+        allocator = &os_allocator_malloc_free;
+
+    return allocator->alloc(allocator->ctx, size);
+}
+
+void * os_allocator_calloc(const os_allocator_t * allocator, const size_t size)
+{
+    void * ptr = os_allocator_alloc(allocator, size);
+    if (NULL != ptr)
+        memset(ptr, 0, size);
+
+    return ptr;
+}
+
+void os_allocator_free(const os_allocator_t * allocator, void * ptr, const size_t size)
+{
+    if (NULL == allocator)
+        allocator = &os_allocator_malloc_free;
+
+    if (NULL != ptr && NULL != allocator->free)
+        allocator->free(allocator->ctx, ptr, size);
+}
+
+os_arena_t * os_arena_create(const size_t block_size)
+{
+    os_arena_t * arena = (os_arena_t *)calloc(1, sizeof(os_arena_t));
+    if (NULL == arena)
+        return NULL;
+
+    arena->block_size = OS_ARENA_ROUND_UP(block_size ? block_size : OS_ARENA_DEFAULT_BLOCK, OS_ARENA_ALIGN);
+
+    return arena;
+}
+
+void os_arena_destroy(os_arena_t ** arena)
+{
+    if (NULL == arena || NULL == *arena)
+        return;
+
+    os_arena_free_blocks((*arena)->blocks);
+    os_arena_free_blocks((*arena)->large);
+
+    free(*arena);
+    *arena = NULL;
+}
+
+void os_arena_reset(os_arena_t * arena)
+{
+    if (NULL == arena)
+        return;
+
+    os_arena_free_blocks(arena->large);
+    arena->large = NULL;
+    arena->used = 0u;
+    if (NULL == arena->blocks)
+        return;
+
+    // 首个块按默认大小申请, 保留它, 其余块逐个释放
+    while (NULL != arena->blocks->next) {
+        os_arena_block_t * block = arena->blocks;
+        arena->blocks = block->next;
+        free(block);
+    }
+
+    arena->cursor = (char *)arena->blocks + OS_ARENA_BLOCK_HDR;
+    arena->limit = arena->cursor + arena->block_size;
+}
+
+void * os_arena_alloc(os_arena_t * arena, const size_t size)
+{
+    if (NULL == arena || size > SIZE_MAX - OS_ARENA_ALIGN)
+        return NULL;
+
+    size_t bytes = OS_ARENA_ROUND_UP(size ? size : 1u, OS_ARENA_ALIGN);
+    if ((size_t)(arena->limit - arena->cursor) < bytes) {
+        // 大块单独申请, 挂在large上, 当前块剩余空间继续使用
+        if (bytes > arena->block_size) {
+            if (bytes > SIZE_MAX - OS_ARENA_BLOCK_HDR)
+                return NULL;
+            os_arena_block_t * block = (os_arena_block_t *)malloc(OS_ARENA_BLOCK_HDR + bytes);
+            if (NULL == block)
+                return NULL;
+            block->next = arena->large;
+            arena->large = block;
+            arena->used += bytes;
+            return (char *)block + OS_ARENA_BLOCK_HDR;
+        }
+
+        if (!os_arena_grow(arena, arena->block_size))
+            return NULL;
+    }
+
+    void * ptr = arena->cursor;
+    arena->cursor += bytes;
+    arena->used += bytes;
+
+    return ptr;
+}
+
+size_t os_arena_used(const os_arena_t * arena)
+{
+    return arena ? arena->used : 0u;
+}
+
+os_allocator_t os_arena_allocator(os_arena_t * arena)
+{
+    os_allocator_t allocator = { os_arena_allocator_alloc, NULL, arena };
+    return allocator;
+}
+
+void * os_allocator_malloc(void * ctx, const size_t size)
+{
+    return malloc(size);
+}
+
+void os_allocator_release(void * ctx, void * ptr, const size_t size)
+{
+    free(ptr);
+}
+
+void * os_arena_allocator_alloc(void * ctx, const size_t size)
+{
+    return os_arena_alloc((os_arena_t *)ctx, size);
+}
+
+bool os_arena_grow(os_arena_t * arena, const size_t size)
+{
+    if (size > SIZE_MAX - OS_ARENA_BLOCK_HDR)
+        return false;
+
+    os_arena_block_t * block = (os_arena_block_t *)malloc(OS_ARENA_BLOCK_HDR + size);
+    if (NULL == block)
+        return false;
+
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->cursor = (char *)block + OS_ARENA_BLOCK_HDR;
+    arena->limit = arena->cursor + size;
+
+    return true;
+}
+
+void os_arena_free_blocks(os_arena_block_t * block)
+{
+    while (NULL != block) {
+        os_arena_block_t * next = block->next;
+        free(block);
+        block = next;
+    }
+}
@@ -0,0 +1,222 @@
+﻿#include "os_epoch.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#define OS_EPOCH_TLS __declspec(thread)
+#else
+#include <sched.h>
+#define OS_EPOCH_TLS _Thread_local
+#endif
+
+#define OS_EPOCH_STRIPES     64u   // 读者计数条带个数, 线程数不超过该值时各线程独占一个缓存行
+#define OS_EPOCH_MIN_RETIRED 64u   // 待释放数组的初始容量
+
+// 每个条带独占一个缓存行, 按纪元奇偶分别计数
+typedef struct _os_epoch_stripe_t {
+    atomic_size_t active[2];  // 处于读区间的读者个数
+    char pad[OS_CACHE_LINE_SIZE - 2 * sizeof(atomic_size_t)];
+} os_epoch_stripe_t;
+
+// 待释放的对象
+typedef struct _os_epoch_list_t {
+    void ** objs;     // 对象数组
+    size_t count;     // 对象个数
+    size_t capacity;  // 数组容量
+} os_epoch_list_t;
+
+// 写者推进纪元前, 上一次推进时登记的对象必须已经释放, 因此读者最多分布在相邻的两个纪元,
+// 用纪元的奇偶区分即可; 旧纪元的计数归零后, 推进前摘除的对象对所有读者都不可达
+struct _os_epoch_t {
+    atomic_uint current;          // 当前纪元
+    char pad[OS_CACHE_LINE_SIZE - sizeof(atomic_uint)];
+    os_epoch_stripe_t * stripes;  // 读者计数条带, 按缓存行对齐
+    void * stripes_mem;           // 条带数组的原始内存
+    os_epoch_free free_fn;        // 释放回调
+    void * ctx;                   // 用户数据
+    os_epoch_list_t pending;      // 当前纪元摘除的对象
+    os_epoch_list_t waiting;      // 上一纪元摘除的对象, 等待旧纪元的读者离开
+};
+
+static atomic_uint os_epoch_next_stripe = 0u;
+static OS_EPOCH_TLS unsigned os_epoch_self_stripe = 0u;  // 本线程的条带序号+1, 0表示尚未分配
+
+// 本线程的条带序号, 首次调用时轮流分配
+static unsigned os_epoch_stripe(void);
+// 统计纪元奇偶为parity的读者个数
+static size_t os_epoch_active(const os_epoch_t * epoch, unsigned parity);
+// 等待纪元奇偶为parity的读者全部离开
+static void os_epoch_wait(const os_epoch_t * epoch, unsigned parity);
+// 释放列表中的全部对象
+static void os_epoch_flush(os_epoch_t * epoch, os_epoch_list_t * list);
+// 推进纪元, 当前纪元摘除的对象转为等待状态
+static unsigned os_epoch_advance(os_epoch_t * epoch);
+// 让出处理器
+static void os_epoch_yield(void);
+
+os_epoch_t * os_epoch_create(os_epoch_free free_fn, void * ctx)
+{
+    if (NULL == free_fn)
+        return NULL;
+
+    os_epoch_t * epoch = (os_epoch_t *)calloc(1, sizeof(os_epoch_t));
+    if (NULL == epoch)
+        return NULL;
+
+    // 多申请一个条带用于对齐
+    epoch->stripes_mem = calloc(OS_EPOCH_STRIPES + 1u, sizeof(os_epoch_stripe_t));
+    if (NULL == epoch->stripes_mem) {
+        free(epoch);
+        return NULL;
+    }
+
+    uintptr_t addr = (uintptr_t)epoch->stripes_mem;
+    addr = (addr + OS_CACHE_LINE_SIZE - 1u) & ~(uintptr_t)(OS_CACHE_LINE_SIZE - 1u);
+    epoch->stripes = (os_epoch_stripe_t *)addr;
+    for (unsigned i = 0u; i < OS_EPOCH_STRIPES; ++i) {
+        atomic_init(&epoch->stripes[i].active[0], 0u);
+        atomic_init(&epoch->stripes[i].active[1], 0u);
+    }
+    atomic_init(&epoch->current, 0u);
+    epoch->free_fn = free_fn;
+    epoch->ctx = ctx;
+
+    return epoch;
+}
+
+void os_epoch_destroy(os_epoch_t ** epoch)
+{
+    if (NULL == epoch || NULL == *epoch)
+        return;
+
+    os_epoch_flush(*epoch, &(*epoch)->waiting);
+    os_epoch_flush(*epoch, &(*epoch)->pending);
+    free((*epoch)->waiting.objs);
+    free((*epoch)->pending.objs);
+    free((*epoch)->stripes_mem);
+    free(*epoch);
+    *epoch = NULL;
+}
+
+unsigned os_epoch_enter(os_epoch_t * epoch)
+{
+    unsigned stripe = os_epoch_stripe();
+    os_epoch_stripe_t * s = &epoch->stripes[stripe];
+    for (;;) {
+        unsigned parity = atomic_load(&epoch->current) & 1u;
+        atomic_fetch_add(&s->active[parity], 1u);
+        // 计数前纪元已被推进时, 写者可能已经认为该奇偶的读者全部离开, 需要重新登记
+        if ((atomic_load(&epoch->current) & 1u) == parity)
+            return stripe << 1 | parity;
+        atomic_fetch_sub(&s->active[parity], 1u);
+    }
+}
+
+void os_epoch_leave(os_epoch_t * epoch, unsigned ticket)
+{
+    atomic_fetch_sub_explicit(&epoch->stripes[ticket >> 1].active[ticket & 1u], 1u, memory_order_release);
+}
+
+void os_epoch_retire(os_epoch_t * epoch, void * obj)
+{
+    if (NULL == epoch || NULL == obj)
+        return;
+
+    os_epoch_list_t * list = &epoch->pending;
+    if (list->count == list->capacity) {
+        size_t capacity = 0u == list->capacity ? OS_EPOCH_MIN_RETIRED : list->capacity * 2u;
+        void ** objs = (void **)realloc(list->objs, capacity * sizeof(void *));
+        if (NULL == objs) {
+            // 内存不足时退化为同步等待, 等读者全部离开后直接释放
+            os_epoch_synchronize(epoch);
+            epoch->free_fn(obj, epoch->ctx);
+            return;
+        }
+        list->objs = objs;
+        list->capacity = capacity;
+    }
+    list->objs[list->count++] = obj;
+}
+
+void os_epoch_reclaim(os_epoch_t * epoch)
+{
+    if (NULL == epoch)
+        return;
+
+    unsigned current = atomic_load(&epoch->current);
+    if (0u != epoch->waiting.count && 0u == os_epoch_active(epoch, (current - 1u) & 1u))
+        os_epoch_flush(epoch, &epoch->waiting);
+
+    if (0u == epoch->waiting.count && 0u != epoch->pending.count) {
+        unsigned old = os_epoch_advance(epoch);
+        if (0u == os_epoch_active(epoch, old & 1u))
+            os_epoch_flush(epoch, &epoch->waiting);
+    }
+}
+
+void os_epoch_synchronize(os_epoch_t * epoch)
+{
+    if (NULL == epoch)
+        return;
+
+    // 先等上一纪元的读者, 再推进纪元并等当前纪元的读者, 推进后进入的读者看不到已摘除的对象
+    unsigned current = atomic_load(&epoch->current);
+    os_epoch_wait(epoch, (current - 1u) & 1u);
+    os_epoch_flush(epoch, &epoch->waiting);
+
+    unsigned old = os_epoch_advance(epoch);
+    os_epoch_wait(epoch, old & 1u);
+    os_epoch_flush(epoch, &epoch->waiting);
+}
+
+unsigned os_epoch_stripe(void)
+{
+    if (0u == os_epoch_self_stripe)
+        os_epoch_self_stripe = atomic_fetch_add_explicit(&os_epoch_next_stripe, 1u, memory_order_relaxed) % OS_EPOCH_STRIPES + 1u;
+
+    return os_epoch_self_stripe - 1u;
+}
+
+size_t os_epoch_active(const os_epoch_t * epoch, unsigned parity)
+{
+    size_t active = 0u;
+    for (unsigned i = 0u; i < OS_EPOCH_STRIPES; ++i)
+        active += atomic_load((atomic_size_t *)&epoch->stripes[i].active[parity]);
+
+    return active;
+}
+
+void os_epoch_wait(const os_epoch_t * epoch, unsigned parity)
+{
+    while (0u != os_epoch_active(epoch, parity))
+        os_epoch_yield();
+}
+
+void os_epoch_flush(os_epoch_t * epoch, os_epoch_list_t * list)
+{
+    for (size_t i = 0u; i < list->count; ++i)
+        epoch->free_fn(list->objs[i], epoch->ctx);
+    list->count = 0u;
+}
+
+unsigned os_epoch_advance(os_epoch_t * epoch)
+{
+    // waiting此时为空, 交换数组即可
+    os_epoch_list_t tmp = epoch->waiting;
+    epoch->waiting = epoch->pending;
+    epoch->pending = tmp;
+
+    return atomic_fetch_add(&epoch->current, 1u);
+}
+
+void os_epoch_yield(void)
+{
+#if defined(WIN32) || defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
@@ -0,0 +1,255 @@
+﻿#include "os_mapfile.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+#include <process.h>
+#else
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct _os_mapfile_t {
+    const void * data;  // 映射起始地址
+    size_t size;        // 映射字节数
+#if defined(WIN32) || defined(_WIN32)
+    HANDLE file;        // 文件句柄
+    HANDLE mapping;     // 映射对象句柄
+#endif
+};
+
+// 建立映射, 成功时填写data和size
+static bool os_mapfile_map(os_mapfile_t * map, const char * path);
+// 解除映射
+static void os_mapfile_unmap(os_mapfile_t * map);
+// 创建并打开tmp_path指向的临时文件, tmp_path以path加后缀组成
+static FILE * os_mapfile_open_temp(char * tmp_path);
+// 把已写入的数据落盘
+static bool os_mapfile_sync(FILE * fp);
+// 用tmp_path替换path
+static bool os_mapfile_replace(const char * tmp_path, const char * path);
+
+#define OS_MAPFILE_TEMP_SUFFIX ".tmpXXXXXX"  // 临时文件后缀, X由进程号和计数组成的数字替换
+#define OS_MAPFILE_TEMP_TRIES  100           // 临时文件重名时的重试次数
+
+os_mapfile_t * os_mapfile_open(const char * path)
+{
+    if (NULL == path)
+        return NULL;
+
+    os_mapfile_t * map = (os_mapfile_t *)calloc(1, sizeof(os_mapfile_t));
+    if (NULL == map)
+        return NULL;
+
+    if (!os_mapfile_map(map, path)) {
+        free(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+void os_mapfile_close(os_mapfile_t ** map)
+{
+    if (NULL == map || NULL == *map)
+        return;
+
+    os_mapfile_unmap(*map);
+    free(*map);
+    *map = NULL;
+}
+
+const void * os_mapfile_data(const os_mapfile_t * map)
+{
+    return map ? map->data : NULL;
+}
+
+size_t os_mapfile_size(const os_mapfile_t * map)
+{
+    return map ? map->size : 0u;
+}
+
+FILE * os_mapfile_create(const char * path, char ** tmp_path)
+{
+    if (NULL == path || NULL == tmp_path)
+        return NULL;
+
+    // 临时文件与目标在同一目录, 替换时只改目录项, 不复制数据
+    size_t len = strlen(path);
+    char * tmp = (char *)malloc(len + sizeof(OS_MAPFILE_TEMP_SUFFIX));
+    if (NULL == tmp)
+        return NULL;
+    memcpy(tmp, path, len);
+    memcpy(tmp + len, OS_MAPFILE_TEMP_SUFFIX, sizeof(OS_MAPFILE_TEMP_SUFFIX));
+
+    FILE * fp = os_mapfile_open_temp(tmp);
+    if (NULL == fp) {
+        free(tmp);
+        return NULL;
+    }
+
+    *tmp_path = tmp;
+    return fp;
+}
+
+bool os_mapfile_commit(FILE * fp, char * tmp_path, const char * path, bool ok)
+{
+    if (NULL == fp || NULL == tmp_path)
+        return false;
+
+    ok = ok && NULL != path && os_mapfile_sync(fp);
+    ok = 0 == fclose(fp) && ok;
+    ok = ok && os_mapfile_replace(tmp_path, path);
+    if (!ok)
+        remove(tmp_path);
+    free(tmp_path);
+
+    return ok;
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+bool os_mapfile_map(os_mapfile_t * map, const char * path)
+{
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == map->file)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(map->file, &size) || 0 == size.QuadPart || (unsigned long long)size.QuadPart > SIZE_MAX) {
+        CloseHandle(map->file);
+        return false;
+    }
+
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (NULL == map->mapping) {
+        CloseHandle(map->file);
+        return false;
+    }
+
+    map->data = MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (NULL == map->data) {
+        CloseHandle(map->mapping);
+        CloseHandle(map->file);
+        return false;
+    }
+    map->size = (size_t)size.QuadPart;
+
+    return true;
+}
+
+void os_mapfile_unmap(os_mapfile_t * map)
+{
+    UnmapViewOfFile(map->data);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+}
+
+FILE * os_mapfile_open_temp(char * tmp_path)
+{
+    // 后缀中的X换成进程号和计数, CREATE_NEW保证不覆盖已有文件
+    static volatile LONG counter = 0;
+    char * x = tmp_path + strlen(tmp_path) - 6;
+    for (int i = 0; i < OS_MAPFILE_TEMP_TRIES; ++i) {
+        unsigned long id = ((unsigned long)_getpid() * 31u + (unsigned long)InterlockedIncrement(&counter)) % 1000000ul;
+        sprintf(x, "%06lu", id);
+        HANDLE file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (INVALID_HANDLE_VALUE != file) {
+            CloseHandle(file);
+            return fopen(tmp_path, "wb");
+        }
+        if (ERROR_FILE_EXISTS != GetLastError())
+            break;
+    }
+
+    return NULL;
+}
+
+bool os_mapfile_sync(FILE * fp)
+{
+    return 0 == fflush(fp) && FlushFileBuffers((HANDLE)_get_osfhandle(_fileno(fp)));
+}
+
+bool os_mapfile_replace(const char * tmp_path, const char * path)
+{
+    // 目标文件仍被映射时替换会失败, 旧文件保持不变
+    return MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+#else
+
+bool os_mapfile_map(os_mapfile_t * map, const char * path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size <= 0 || (unsigned long long)st.st_size > SIZE_MAX) {
+        close(fd);
+        return false;
+    }
+
+    // 映射建立后文件描述符不再需要
+    void * data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data)
+        return false;
+
+    map->data = data;
+    map->size = (size_t)st.st_size;
+
+    return true;
+}
+
+void os_mapfile_unmap(os_mapfile_t * map)
+{
+    munmap((void *)map->data, map->size);
+}
+
+FILE * os_mapfile_open_temp(char * tmp_path)
+{
+    // 后缀中的X换成进程号和计数, O_EXCL保证不覆盖已有文件; 权限与fopen创建的文件相同
+    static atomic_uint counter = 0u;
+    char * x = tmp_path + strlen(tmp_path) - 6;
+    for (int i = 0; i < OS_MAPFILE_TEMP_TRIES; ++i) {
+        unsigned long id = ((unsigned long)getpid() * 31u + atomic_fetch_add(&counter, 1u)) % 1000000ul;
+        sprintf(x, "%06lu", id);
+        int fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, 0666);
+        if (fd < 0) {
+            if (EEXIST == errno)
+                continue;
+            break;
+        }
+
+        FILE * fp = fdopen(fd, "wb");
+        if (NULL == fp) {
+            close(fd);
+            remove(tmp_path);
+        }
+        return fp;
+    }
+
+    return NULL;
+}
+
+bool os_mapfile_sync(FILE * fp)
+{
+    return 0 == fflush(fp) && 0 == fsync(fileno(fp));
+}
+
+bool os_mapfile_replace(const char * tmp_path, const char * path)
+{
+    // rename只替换目录项, 映射旧文件的进程继续持有旧inode
+    return 0 == rename(tmp_path, path);
+}
+
+#endif
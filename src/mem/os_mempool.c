@@ -0,0 +1,215 @@
+﻿#include "os_mempool.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define OS_MEMPOOL_ALIGN          (2 * sizeof(void *))  // 对象对齐, 与malloc保持一致
+#define OS_MEMPOOL_MIN_CHUNK      16u                   // 首个内存块的对象个数
+#define OS_MEMPOOL_DEFAULT_CHUNK  1024u                 // 默认内存块的最大对象个数
+
+#define OS_MEMPOOL_ROUND_UP(n, a) (((n) + (a) - 1) / (a) * (a))
+
+typedef struct _os_mempool_chunk_t os_mempool_chunk_t;
+typedef struct _os_mempool_slot_t os_mempool_slot_t;
+
+struct _os_mempool_chunk_t {
+    os_mempool_chunk_t * next;  // 下一个内存块
+    size_t size;                // 内存块字节数, 归还分配器时使用
+};
+
+struct _os_mempool_slot_t {
+    os_mempool_slot_t * next;   // 下一个空闲对象
+};
+
+struct _os_mempool_t {
+    size_t obj_size;                // 对象大小(已对齐)
+    size_t chunk_size;              // 内存块最大对象个数
+    os_allocator_t allocator;       // 分配器
+    size_t next_count;              // 下一个内存块的对象个数
+    os_mempool_chunk_t * chunks;    // 已分配的内存块
+    os_mempool_slot_t * free_list;  // 已归还的对象
+    size_t free_count;              // 已归还的对象个数
+    char * cursor;                  // 当前内存块未使用区域起始
+    char * limit;                   // 当前内存块未使用区域结束
+};
+
+#define OS_MEMPOOL_CHUNK_HDR OS_MEMPOOL_ROUND_UP(sizeof(os_mempool_chunk_t), OS_MEMPOOL_ALIGN)
+
+// 申请容纳count个对象的内存块, 默认块的大小按倍数增长直到chunk_size
+static bool os_mempool_grow(os_mempool_t * pool, size_t count);
+
+os_mempool_t * os_mempool_create(const size_t obj_size, const size_t chunk_size)
+{
+    return os_mempool_create_ex(obj_size, chunk_size, NULL);
+}
+
+os_mempool_t * os_mempool_create_ex(const size_t obj_size, const size_t chunk_size, const os_allocator_t * allocator)
+{
+    if (0u == obj_size)
+        return NULL;
+
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_mempool_t * pool = (os_mempool_t *)os_allocator_calloc(allocator, sizeof(os_mempool_t));
+    if (NULL == pool)
+        return NULL;
+
+    pool->allocator = *allocator;
+    size_t size = obj_size < sizeof(os_mempool_slot_t) ? sizeof(os_mempool_slot_t) : obj_size;
+    pool->obj_size = OS_MEMPOOL_ROUND_UP(size, OS_MEMPOOL_ALIGN);
+    pool->chunk_size = chunk_size ? chunk_size : OS_MEMPOOL_DEFAULT_CHUNK;
+    pool->next_count = pool->chunk_size < OS_MEMPOOL_MIN_CHUNK ? pool->chunk_size : OS_MEMPOOL_MIN_CHUNK;
+
+    return pool;
+}
+
+void os_mempool_destroy(os_mempool_t ** pool)
+{
+    if (NULL == pool || NULL == *pool)
+        return;
+
+    os_mempool_clear(*pool);
+
+    os_allocator_t allocator = (*pool)->allocator;
+    os_allocator_free(&allocator, *pool, sizeof(os_mempool_t));
+    *pool = NULL;
+}
+
+void os_mempool_clear(os_mempool_t * pool)
+{
+    if (NULL == pool)
+        return;
+
+    // 区域式分配器不逐块归还, 由分配器整体释放
+    while (NULL != pool->allocator.free && NULL != pool->chunks) {
+        os_mempool_chunk_t * chunk = pool->chunks;
+        pool->chunks = chunk->next;
+        os_allocator_free(&pool->allocator, chunk, chunk->size);
+    }
+
+    pool->chunks = NULL;
+    pool->free_list = NULL;
+    pool->free_count = 0u;
+    pool->cursor = NULL;
+    pool->limit = NULL;
+    pool->next_count = pool->chunk_size < OS_MEMPOOL_MIN_CHUNK ? pool->chunk_size : OS_MEMPOOL_MIN_CHUNK;
+}
+
+void * os_mempool_alloc(os_mempool_t * pool)
+{
+    if (NULL == pool)
+        return NULL;
+
+    os_mempool_slot_t * slot = pool->free_list;
+    if (NULL != slot) {
+        pool->free_list = slot->next;
+        --pool->free_count;
+        return slot;
+    }
+
+    if (pool->cursor == pool->limit && !os_mempool_grow(pool, pool->next_count))
+        return NULL;
+
+    void * obj = pool->cursor;
+    pool->cursor += pool->obj_size;
+
+    return obj;
+}
+
+bool os_mempool_reserve(os_mempool_t * pool, const size_t count)
+{
+    if (NULL == pool)
+        return false;
+
+    size_t avail = pool->free_count + (size_t)(pool->limit - pool->cursor) / pool->obj_size;
+    if (avail >= count)
+        return true;
+
+    // 当前块剩余部分转为空闲对象(按地址顺序取出), 不足的部分由一个新块提供
+    while (pool->limit != pool->cursor) {
+        pool->limit -= pool->obj_size;
+        os_mempool_free(pool, pool->limit);
+    }
+
+    size_t need = count - avail;
+    return os_mempool_grow(pool, need > pool->next_count ? need : pool->next_count);
+}
+
+void os_mempool_free(os_mempool_t * pool, void * obj)
+{
+    if (NULL == pool || NULL == obj)
+        return;
+
+    os_mempool_slot_t * slot = (os_mempool_slot_t *)obj;
+    slot->next = pool->free_list;
+    pool->free_list = slot;
+    ++pool->free_count;
+}
+
+bool os_mempool_merge(os_mempool_t * dst, os_mempool_t * src)
+{
+    if (NULL == dst || NULL == src)
+        return false;
+
+    if (dst == src)
+        return true;
+
+    // 内存块最终由dst归还, 两者必须使用同一个分配器
+    if (dst->obj_size != src->obj_size || dst->allocator.alloc != src->allocator.alloc
+        || dst->allocator.free != src->allocator.free || dst->allocator.ctx != src->allocator.ctx)
+        return false;
+
+    // 源对象池当前块中未使用的部分转为空闲对象
+    while (src->cursor != src->limit) {
+        os_mempool_free(dst, src->cursor);
+        src->cursor += src->obj_size;
+    }
+
+    if (NULL != src->free_list) {
+        os_mempool_slot_t * last = src->free_list;
+        while (NULL != last->next)
+            last = last->next;
+        last->next = dst->free_list;
+        dst->free_list = src->free_list;
+        dst->free_count += src->free_count;
+    }
+
+    if (NULL != src->chunks) {
+        os_mempool_chunk_t * last = src->chunks;
+        while (NULL != last->next)
+            last = last->next;
+        last->next = dst->chunks;
+        dst->chunks = src->chunks;
+    }
+
+    src->chunks = NULL;
+    src->free_list = NULL;
+    src->free_count = 0u;
+    src->cursor = NULL;
+    src->limit = NULL;
+
+    return true;
+}
+
+bool os_mempool_grow(os_mempool_t * pool, const size_t count)
+{
+    if (count > (SIZE_MAX - OS_MEMPOOL_CHUNK_HDR) / pool->obj_size)
+        return false;
+
+    size_t size = OS_MEMPOOL_CHUNK_HDR + count * pool->obj_size;
+    os_mempool_chunk_t * chunk = (os_mempool_chunk_t *)os_allocator_alloc(&pool->allocator, size);
+    if (NULL == chunk)
+        return false;
+
+    chunk->size = size;
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    pool->cursor = (char *)chunk + OS_MEMPOOL_CHUNK_HDR;
+    pool->limit = pool->cursor + count * pool->obj_size;
+
+    if (pool->next_count < pool->chunk_size)
+        pool->next_count = pool->next_count * 2 < pool->chunk_size ? pool->next_count * 2 : pool->chunk_size;
+
+    return true;
+}
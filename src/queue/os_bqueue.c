@@ -0,0 +1,347 @@
+﻿#include "os_bqueue.h"
+#include "os_deque.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+
+typedef CRITICAL_SECTION os_bqueue_mutex_t;
+typedef CONDITION_VARIABLE os_bqueue_cond_t;
+typedef ULONGLONG os_bqueue_deadline_t;
+#else
+#include <time.h>
+#include <pthread.h>
+
+#if defined(__APPLE__)
+#define OS_BQUEUE_CLOCK CLOCK_REALTIME
+#else
+#define OS_BQUEUE_CLOCK CLOCK_MONOTONIC
+#endif
+
+typedef pthread_mutex_t os_bqueue_mutex_t;
+typedef pthread_cond_t os_bqueue_cond_t;
+typedef struct timespec os_bqueue_deadline_t;
+#endif
+
+// 数据存放在os_deque中, 互斥锁保护; 仅在有等待者时才唤醒, 无竞争时不会陷入内核
+struct _os_bqueue_t {
+    os_deque_t * items;           // 数据
+    size_t elem_size;             // 元素大小
+    size_t capacity;              // 容量, 0表示不限制
+    bool closed;                  // 是否已关闭
+    size_t pop_waiters;           // 等待数据的线程数
+    size_t push_waiters;          // 等待空位的线程数
+    os_bqueue_mutex_t lock;       // 互斥锁
+    os_bqueue_cond_t not_empty;   // 有数据可取
+    os_bqueue_cond_t not_full;    // 有空位可插入
+    os_allocator_t allocator;     // 分配器, 队列本身和数据块经由它申请
+};
+
+static bool os_bqueue_sync_init(os_bqueue_t * q);
+static void os_bqueue_sync_destroy(os_bqueue_t * q);
+static void os_bqueue_lock(os_bqueue_t * q);
+static void os_bqueue_unlock(os_bqueue_t * q);
+static void os_bqueue_signal(os_bqueue_cond_t * cond);
+static void os_bqueue_broadcast(os_bqueue_cond_t * cond);
+// 计算超时时刻
+static void os_bqueue_deadline(os_bqueue_deadline_t * deadline, int timeout_ms);
+// 等待条件变量, 超时返回false
+static bool os_bqueue_wait(os_bqueue_t * q, os_bqueue_cond_t * cond, const os_bqueue_deadline_t * deadline);
+
+os_bqueue_t * os_bqueue_create(const size_t elem_size, const size_t capacity)
+{
+    return os_bqueue_create_ex(elem_size, capacity, NULL);
+}
+
+os_bqueue_t * os_bqueue_create_ex(const size_t elem_size, const size_t capacity, const os_allocator_t * allocator)
+{
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_bqueue_t * q = (os_bqueue_t *)os_allocator_calloc(allocator, sizeof(os_bqueue_t));
+    if (NULL == q)
+        return NULL;
+
+    q->allocator = *allocator;
+    q->items = os_deque_create_ex(elem_size, allocator);
+    if (NULL == q->items) {
+        os_allocator_free(allocator, q, sizeof(os_bqueue_t));
+        return NULL;
+    }
+
+    if (!os_bqueue_sync_init(q)) {
+        os_deque_destroy(&q->items);
+        os_allocator_free(allocator, q, sizeof(os_bqueue_t));
+        return NULL;
+    }
+
+    q->elem_size = elem_size;
+    q->capacity = capacity;
+
+    return q;
+}
+
+void os_bqueue_destroy(os_bqueue_t ** q)
+{
+    if (NULL == q || NULL == *q)
+        return;
+
+    os_bqueue_sync_destroy(*q);
+    os_deque_destroy(&(*q)->items);
+
+    os_allocator_t allocator = (*q)->allocator;
+    os_allocator_free(&allocator, *q, sizeof(os_bqueue_t));
+    *q = NULL;
+}
+
+void os_bqueue_close(os_bqueue_t * q)
+{
+    if (NULL == q)
+        return;
+
+    os_bqueue_lock(q);
+    q->closed = true;
+    if (0u != q->pop_waiters)
+        os_bqueue_broadcast(&q->not_empty);
+    if (0u != q->push_waiters)
+        os_bqueue_broadcast(&q->not_full);
+    os_bqueue_unlock(q);
+}
+
+bool os_bqueue_closed(os_bqueue_t * q)
+{
+    if (NULL == q)
+        return true;
+
+    os_bqueue_lock(q);
+    bool closed = q->closed;
+    os_bqueue_unlock(q);
+
+    return closed;
+}
+
+size_t os_bqueue_size(os_bqueue_t * q)
+{
+    if (NULL == q)
+        return 0u;
+
+    os_bqueue_lock(q);
+    size_t size = os_deque_size(q->items);
+    os_bqueue_unlock(q);
+
+    return size;
+}
+
+OS_BQUEUE_RESULT_TYPE os_bqueue_push_wait(os_bqueue_t * q, const void * data, const int timeout_ms)
+{
+    if (NULL == q || NULL == data)
+        return OS_BQUEUE_ERROR;
+
+    os_bqueue_deadline_t deadline;
+    if (timeout_ms > 0)
+        os_bqueue_deadline(&deadline, timeout_ms);
+
+    os_bqueue_lock(q);
+    while (!q->closed && 0u != q->capacity && os_deque_size(q->items) >= q->capacity) {
+        if (0 == timeout_ms) {
+            os_bqueue_unlock(q);
+            return OS_BQUEUE_TIMEOUT;
+        }
+
+        ++q->push_waiters;
+        bool signaled = os_bqueue_wait(q, &q->not_full, timeout_ms > 0 ? &deadline : NULL);
+        --q->push_waiters;
+        if (!signaled && !q->closed && os_deque_size(q->items) >= q->capacity) {
+            os_bqueue_unlock(q);
+            return OS_BQUEUE_TIMEOUT;
+        }
+    }
+
+    if (q->closed) {
+        os_bqueue_unlock(q);
+        return OS_BQUEUE_CLOSED;
+    }
+
+    if (!os_deque_push_back(q->items, (void *)data)) {
+        os_bqueue_unlock(q);
+        return OS_BQUEUE_ERROR;
+    }
+
+    if (0u != q->pop_waiters)
+        os_bqueue_signal(&q->not_empty);
+    os_bqueue_unlock(q);
+
+    return OS_BQUEUE_OK;
+}
+
+OS_BQUEUE_RESULT_TYPE os_bqueue_pop_wait(os_bqueue_t * q, void * data, const int timeout_ms)
+{
+    if (NULL == q || NULL == data)
+        return OS_BQUEUE_ERROR;
+
+    os_bqueue_deadline_t deadline;
+    if (timeout_ms > 0)
+        os_bqueue_deadline(&deadline, timeout_ms);
+
+    os_bqueue_lock(q);
+    while (!q->closed && os_deque_empty(q->items)) {
+        if (0 == timeout_ms) {
+            os_bqueue_unlock(q);
+            return OS_BQUEUE_TIMEOUT;
+        }
+
+        ++q->pop_waiters;
+        bool signaled = os_bqueue_wait(q, &q->not_empty, timeout_ms > 0 ? &deadline : NULL);
+        --q->pop_waiters;
+        if (!signaled && !q->closed && os_deque_empty(q->items)) {
+            os_bqueue_unlock(q);
+            return OS_BQUEUE_TIMEOUT;
+        }
+    }
+
+    // 关闭后仍可取完剩余数据
+    if (os_deque_empty(q->items)) {
+        os_bqueue_unlock(q);
+        return OS_BQUEUE_CLOSED;
+    }
+
+    memcpy(data, os_deque_getdata(os_deque_front(q->items)), q->elem_size);
+    os_deque_pop_front(q->items);
+
+    if (0u != q->push_waiters)
+        os_bqueue_signal(&q->not_full);
+    os_bqueue_unlock(q);
+
+    return OS_BQUEUE_OK;
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+bool os_bqueue_sync_init(os_bqueue_t * q)
+{
+    InitializeCriticalSection(&q->lock);
+    InitializeConditionVariable(&q->not_empty);
+    InitializeConditionVariable(&q->not_full);
+    return true;
+}
+
+void os_bqueue_sync_destroy(os_bqueue_t * q)
+{
+    DeleteCriticalSection(&q->lock);
+}
+
+void os_bqueue_lock(os_bqueue_t * q)
+{
+    EnterCriticalSection(&q->lock);
+}
+
+void os_bqueue_unlock(os_bqueue_t * q)
+{
+    LeaveCriticalSection(&q->lock);
+}
+
+void os_bqueue_signal(os_bqueue_cond_t * cond)
+{
+    WakeConditionVariable(cond);
+}
+
+void os_bqueue_broadcast(os_bqueue_cond_t * cond)
+{
+    WakeAllConditionVariable(cond);
+}
+
+void os_bqueue_deadline(os_bqueue_deadline_t * deadline, const int timeout_ms)
+{
+    *deadline = GetTickCount64() + (ULONGLONG)timeout_ms;
+}
+
+bool os_bqueue_wait(os_bqueue_t * q, os_bqueue_cond_t * cond, const os_bqueue_deadline_t * deadline)
+{
+    DWORD wait_ms = INFINITE;
+    if (NULL != deadline) {
+        ULONGLONG now = GetTickCount64();
+        if (now >= *deadline)
+            return false;
+        wait_ms = (DWORD)(*deadline - now);
+    }
+
+    return SleepConditionVariableCS(cond, &q->lock, wait_ms) || ERROR_TIMEOUT != GetLastError();
+}
+
+#else
+
+bool os_bqueue_sync_init(os_bqueue_t * q)
+{
+    pthread_condattr_t attr;
+    if (0 != pthread_condattr_init(&attr))
+        return false;
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&attr, OS_BQUEUE_CLOCK);
+#endif
+
+    bool ok = false;
+    if (0 == pthread_mutex_init(&q->lock, NULL)) {
+        if (0 == pthread_cond_init(&q->not_empty, &attr)) {
+            if (0 == pthread_cond_init(&q->not_full, &attr))
+                ok = true;
+            else
+                pthread_cond_destroy(&q->not_empty);
+        }
+        if (!ok)
+            pthread_mutex_destroy(&q->lock);
+    }
+    pthread_condattr_destroy(&attr);
+
+    return ok;
+}
+
+void os_bqueue_sync_destroy(os_bqueue_t * q)
+{
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->lock);
+}
+
+void os_bqueue_lock(os_bqueue_t * q)
+{
+    pthread_mutex_lock(&q->lock);
+}
+
+void os_bqueue_unlock(os_bqueue_t * q)
+{
+    pthread_mutex_unlock(&q->lock);
+}
+
+void os_bqueue_signal(os_bqueue_cond_t * cond)
+{
+    pthread_cond_signal(cond);
+}
+
+void os_bqueue_broadcast(os_bqueue_cond_t * cond)
+{
+    pthread_cond_broadcast(cond);
+}
+
+void os_bqueue_deadline(os_bqueue_deadline_t * deadline, const int timeout_ms)
+{
+    clock_gettime(OS_BQUEUE_CLOCK, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec += 1;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+bool os_bqueue_wait(os_bqueue_t * q, os_bqueue_cond_t * cond, const os_bqueue_deadline_t * deadline)
+{
+    if (NULL == deadline)
+        return 0 == pthread_cond_wait(cond, &q->lock);
+
+    return 0 == pthread_cond_timedwait(cond, &q->lock, deadline);
+}
+
+#endif
@@ -1,31 +1,66 @@
 ﻿#include "os_deque.h"
+#include "os_stats.h"
 
 #include <stdint.h>
 #include <string.h>
-#include <malloc.h>
 
-struct _os_deque_node_t {
-    os_deque_node_t * next;  // 下一个节点
-    os_deque_node_t * prev;  // 上一个节点
-    char data[0];            // 节点内容
-};
+#define OS_DEQUE_BLOCK_BYTES  4096u   // 单个块的字节数
+#define OS_DEQUE_BLOCK_MIN    16u     // 单个块最少的元素个数
+#define OS_DEQUE_MAP_MIN      8u      // 块指针数组最小容量
 
+// 元素按块存储, 块指针数组向两端增长, os_deque_node_t即为元素地址
 struct _os_deque_t {
     size_t size;              // 队列长度
     size_t elem_size;         // 元素大小
-    size_t node_size;         // 节点大小
-    os_deque_node_t * head;   // 队列头
-    os_deque_node_t * tail;   // 队列尾
+    size_t block_elems;       // 每个块的元素个数
+    size_t block_size;        // 块大小
+    char ** map;              // 块指针数组
+    size_t map_size;          // 块指针数组容量
+    size_t first;             // 首元素相对map[0]起始的元素偏移
+    char * spare;             // 缓存的空闲块, 避免在块边界反复申请释放
+    os_allocator_t allocator; // 分配器, 队列本身、块和块指针数组经由它申请
+#if defined(OS_ENABLE_STATS)
+    os_stats_t stats;         // 运行统计, 按块和块指针数组的实际申请释放计数
+#endif
 };
 
+// 获取第index个元素的地址
+static inline char * os_deque_addr(const os_deque_t * q, size_t index);
+// 为pos所在的块申请内存
+static bool os_deque_fill_block(os_deque_t * q, size_t pos);
+// 为[lo, hi)范围内的空块申请内存, 失败时释放本次申请的块
+static bool os_deque_fill_blocks(os_deque_t * q, size_t lo, size_t hi);
+// 释放块
+static void os_deque_release_block(os_deque_t * q, size_t block);
+// 块指针数组两端各预留至少extra个块的空间
+static bool os_deque_grow_map(os_deque_t * q, size_t extra);
+// 将count个元素拷贝到从pos开始的位置, 按块分段拷贝
+static void os_deque_copy_in(os_deque_t * q, size_t pos, const void * data, size_t count);
+
 os_deque_t * os_deque_create(const size_t elem_size)
 {
-    os_deque_t * q = (os_deque_t *)calloc(1, sizeof(os_deque_t));
+    return os_deque_create_ex(elem_size, NULL);
+}
+
+os_deque_t * os_deque_create_ex(const size_t elem_size, const os_allocator_t * allocator)
+{
+    if (0u == elem_size)
+        return NULL;
+
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_deque_t * q = (os_deque_t *)os_allocator_calloc(allocator, sizeof(os_deque_t));
     if (NULL == q)
         return NULL;
 
+    q->allocator = *allocator;
     q->elem_size = elem_size;
-    q->node_size = sizeof(os_deque_node_t) + elem_size;
+    q->block_elems = OS_DEQUE_BLOCK_BYTES / elem_size;
+    if (q->block_elems < OS_DEQUE_BLOCK_MIN)
+        q->block_elems = OS_DEQUE_BLOCK_MIN;
+    q->block_size = q->block_elems * elem_size;
+    OS_STATS_ALLOC(q->stats, 1, sizeof(os_deque_t));
 
     return q;
 }
@@ -38,7 +73,14 @@ void os_deque_destroy(os_deque_t ** q)
     // 先清空
     os_deque_clear(*q);
 
-    free(*q);
+    if (NULL != (*q)->spare)
+        OS_STATS_FREE((*q)->stats, 1, (*q)->block_size);
+    if (NULL != (*q)->map)
+        OS_STATS_FREE((*q)->stats, 1, (*q)->map_size * sizeof(char *));
+    os_allocator_t allocator = (*q)->allocator;
+    os_allocator_free(&allocator, (*q)->spare, (*q)->block_size);
+    os_allocator_free(&allocator, (*q)->map, (*q)->map_size * sizeof(char *));
+    os_allocator_free(&allocator, *q, sizeof(os_deque_t));
     *q = NULL;
 }
 
@@ -47,13 +89,14 @@ void os_deque_clear(os_deque_t * q)
     if (NULL == q)
         return;
 
-    while (NULL != q->head) {
-        os_deque_node_t * head = q->head;
-        q->head = q->head->next;
-        free(head);
-        head = NULL;
-        --q->size;
+    if (0u != q->size) {
+        size_t last = (q->first + q->size - 1) / q->block_elems;
+        for (size_t i = q->first / q->block_elems; i <= last; i++)
+            os_deque_release_block(q, i);
     }
+
+    q->size = 0u;
+    q->first = q->map_size / 2 * q->block_elems;
 }
 
 bool os_deque_empty(os_deque_t * q)
@@ -71,21 +114,16 @@ bool os_deque_push_back(os_deque_t * q, void * data)
     if (NULL == q || NULL == data)
         return false;
 
-    os_deque_node_t * node = (os_deque_node_t *)calloc(1, q->node_size);
-    if (NULL == node)
+    if (q->first + q->size == q->map_size * q->block_elems && !os_deque_grow_map(q, 1u))
         return false;
 
-    memcpy(node->data, data, q->elem_size);
+    size_t pos = q->first + q->size;
+    if (!os_deque_fill_block(q, pos))
+        return false;
 
-    if (0u == q->size) { // 队列为空
-        q->head = node;
-        q->tail = node;
-    } else {
-        q->tail->next = node;
-        node->prev = q->tail;
-        q->tail = node;
-    }
+    memcpy(os_deque_addr(q, q->size), data, q->elem_size);
     ++q->size;
+    OS_STATS_SIZE(q->stats, q->size);
 
     return true;
 }
@@ -95,21 +133,71 @@ bool os_deque_push_front(os_deque_t * q, void * data)
     if (NULL == q || NULL == data)
         return false;
 
-    os_deque_node_t * node = (os_deque_node_t *)calloc(1, q->node_size);
-    if (NULL == node)
+    if (0u == q->first && !os_deque_grow_map(q, 1u))
         return false;
 
-    memcpy(node->data, data, q->elem_size);
+    if (!os_deque_fill_block(q, q->first - 1))
+        return false;
 
-    if (0u == q->size) {
-        q->head = node;
-        q->tail = node;
-    } else {
-        node->next = q->head;
-        q->head->prev = node;
-        q->head = node;
-    }
+    --q->first;
     ++q->size;
+    OS_STATS_SIZE(q->stats, q->size);
+    memcpy(os_deque_addr(q, 0u), data, q->elem_size);
+
+    return true;
+}
+
+bool os_deque_push_back_n(os_deque_t * q, const void * data, const size_t count)
+{
+    if (NULL == q || NULL == data)
+        return false;
+
+    if (0u == count)
+        return true;
+
+    size_t extra = (count + q->block_elems - 1) / q->block_elems + 1;
+    if (q->first + q->size + count > q->map_size * q->block_elems && !os_deque_grow_map(q, extra))
+        return false;
+
+    // 尾部所在的块可能已存在, 只申请其后的新块
+    size_t pos = q->first + q->size;
+    size_t lo = pos / q->block_elems;
+    if (NULL != q->map[lo])
+        ++lo;
+    if (!os_deque_fill_blocks(q, lo, (pos + count - 1) / q->block_elems + 1))
+        return false;
+
+    os_deque_copy_in(q, pos, data, count);
+    q->size += count;
+    OS_STATS_SIZE(q->stats, q->size);
+
+    return true;
+}
+
+bool os_deque_push_front_n(os_deque_t * q, const void * data, const size_t count)
+{
+    if (NULL == q || NULL == data)
+        return false;
+
+    if (0u == count)
+        return true;
+
+    size_t extra = (count + q->block_elems - 1) / q->block_elems + 1;
+    if (q->first < count && !os_deque_grow_map(q, extra))
+        return false;
+
+    // 头部所在的块可能已存在, 只申请其前的新块
+    size_t pos = q->first - count;
+    size_t hi = (q->first - 1) / q->block_elems + 1;
+    if (NULL != q->map[hi - 1])
+        --hi;
+    if (!os_deque_fill_blocks(q, pos / q->block_elems, hi))
+        return false;
+
+    os_deque_copy_in(q, pos, data, count);
+    q->first = pos;
+    q->size += count;
+    OS_STATS_SIZE(q->stats, q->size);
 
     return true;
 }
@@ -119,14 +207,15 @@ bool os_deque_pop_front(os_deque_t * q)
     if (NULL == q || 0u == q->size)
         return true;
 
-    os_deque_node_t * head = q->head;
-    q->head = q->head->next;
-    free(head);
+    size_t block = q->first / q->block_elems;
+    ++q->first;
     --q->size;
-    if (0u == q->size)
-        q->tail = NULL;
-    else
-        q->head->prev = NULL;
+    if (0u == q->size) {
+        os_deque_release_block(q, block);
+        q->first = q->map_size / 2 * q->block_elems;
+    } else if (0u == q->first % q->block_elems) {
+        os_deque_release_block(q, block);
+    }
 
     return true;
 }
@@ -136,29 +225,161 @@ bool os_deque_pop_back(os_deque_t * q)
     if (NULL == q || 0u == q->size)
         return true;
 
-    os_deque_node_t * tail = q->tail;
-    q->tail = q->tail->prev;
-    free(tail);
     --q->size;
-    if (0u == q->size)
-        q->head = NULL;
-    else
-        q->tail->next = NULL;
+    size_t pos = q->first + q->size;
+    if (0u == q->size) {
+        os_deque_release_block(q, pos / q->block_elems);
+        q->first = q->map_size / 2 * q->block_elems;
+    } else if (0u == pos % q->block_elems) {
+        os_deque_release_block(q, pos / q->block_elems);
+    }
 
     return true;
 }
 
 os_deque_node_t * os_deque_front(os_deque_t * q)
 {
-    return q ? q->head : NULL;
+    return (q && q->size) ? (os_deque_node_t *)os_deque_addr(q, 0u) : NULL;
 }
 
 os_deque_node_t * os_deque_back(os_deque_t * q)
 {
-    return q ? q->tail : NULL;
+    return (q && q->size) ? (os_deque_node_t *)os_deque_addr(q, q->size - 1) : NULL;
 }
 
 void * os_deque_getdata(const os_deque_node_t * node)
 {
-    return  node ? (void *)node->data : NULL;
+    return (void *)node;
+}
+
+void * os_deque_at(const os_deque_t * q, const size_t index)
+{
+    if (NULL == q || index >= q->size)
+        return NULL;
+
+    return os_deque_addr(q, index);
+}
+
+bool os_deque_stats(const os_deque_t * q, os_stats_t * stats)
+{
+    if (NULL == stats)
+        return false;
+
+    memset(stats, 0, sizeof(os_stats_t));
+#if defined(OS_ENABLE_STATS)
+    if (NULL == q)
+        return false;
+
+    *stats = q->stats;
+    return true;
+#else
+    return false;
+#endif
+}
+
+char * os_deque_addr(const os_deque_t * q, const size_t index)
+{
+    size_t pos = q->first + index;
+    return q->map[pos / q->block_elems] + (pos % q->block_elems) * q->elem_size;
+}
+
+bool os_deque_fill_block(os_deque_t * q, const size_t pos)
+{
+    size_t block = pos / q->block_elems;
+    if (NULL != q->map[block])
+        return true;
+
+    if (NULL != q->spare) {
+        q->map[block] = q->spare;
+        q->spare = NULL;
+    } else {
+        q->map[block] = (char *)os_allocator_alloc(&q->allocator, q->block_size);
+        if (NULL != q->map[block])
+            OS_STATS_ALLOC(q->stats, 1, q->block_size);
+    }
+
+    return NULL != q->map[block];
+}
+
+bool os_deque_fill_blocks(os_deque_t * q, const size_t lo, const size_t hi)
+{
+    for (size_t i = lo; i < hi; i++) {
+        if (os_deque_fill_block(q, i * q->block_elems))
+            continue;
+
+        while (i > lo)
+            os_deque_release_block(q, --i);
+        return false;
+    }
+
+    return true;
+}
+
+void os_deque_release_block(os_deque_t * q, const size_t block)
+{
+    if (NULL == q->spare)
+        q->spare = q->map[block];
+    else {
+        os_allocator_free(&q->allocator, q->map[block], q->block_size);
+        OS_STATS_FREE(q->stats, 1, q->block_size);
+    }
+    q->map[block] = NULL;
+}
+
+bool os_deque_grow_map(os_deque_t * q, const size_t extra)
+{
+    size_t used = 0u;
+    size_t lo = 0u;
+    if (0u != q->size) {
+        lo = q->first / q->block_elems;
+        used = (q->first + q->size - 1) / q->block_elems - lo + 1;
+    }
+
+    // 使用量不足一半且空间足够时在原数组内居中, 否则容量翻倍
+    if (used * 2 < q->map_size && used + 2 * extra <= q->map_size) {
+        size_t new_lo = (q->map_size - used) / 2;
+        memmove(q->map + new_lo, q->map + lo, used * sizeof(char *));
+        for (size_t i = 0; i < q->map_size; i++) {
+            if (i < new_lo || i >= new_lo + used)
+                q->map[i] = NULL;
+        }
+        q->first = new_lo * q->block_elems + (q->size ? q->first % q->block_elems : 0u);
+        return true;
+    }
+
+    size_t map_size = q->map_size ? q->map_size * 2 : OS_DEQUE_MAP_MIN;
+    if (map_size < used + 2 * extra)
+        map_size = used + 2 * extra;
+    char ** map = (char **)os_allocator_calloc(&q->allocator, map_size * sizeof(char *));
+    if (NULL == map)
+        return false;
+    OS_STATS_ALLOC(q->stats, 1, map_size * sizeof(char *));
+
+    size_t new_lo = (map_size - used) / 2;
+    if (0u != used)
+        memcpy(map + new_lo, q->map + lo, used * sizeof(char *));
+    q->first = new_lo * q->block_elems + (q->size ? q->first % q->block_elems : 0u);
+
+    if (NULL != q->map)
+        OS_STATS_FREE(q->stats, 1, q->map_size * sizeof(char *));
+    os_allocator_free(&q->allocator, q->map, q->map_size * sizeof(char *));
+    q->map = map;
+    q->map_size = map_size;
+
+    return true;
+}
+
+void os_deque_copy_in(os_deque_t * q, size_t pos, const void * data, size_t count)
+{
+    const char * src = (const char *)data;
+    while (0u != count) {
+        size_t offset = pos % q->block_elems;
+        size_t n = q->block_elems - offset;
+        if (n > count)
+            n = count;
+        memcpy(q->map[pos / q->block_elems] + offset * q->elem_size, src, n * q->elem_size);
+        src += n * q->elem_size;
+        pos += n;
+        count -= n;
+    }
 }
@@ -0,0 +1,200 @@
+﻿#include "os_mpmc_queue.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#define OS_MPMC_SLOT_ALIGN sizeof(atomic_size_t)
+
+// 槽位: seq == pos 可写入, seq == pos + 1 可读取
+typedef struct _os_mpmc_slot_t {
+    atomic_size_t seq;        // 序号
+    char data[0];             // 元素
+} os_mpmc_slot_t;
+
+// 结构体按缓存行对齐分配, 生产位置和消费位置各占一个缓存行
+struct _os_mpmc_queue_t {
+    size_t elem_size;         // 元素大小
+    size_t slot_size;         // 槽位大小
+    size_t mask;              // 容量-1
+    char * slots;             // 槽位数组
+    void * mem;               // 结构体的原始内存, 释放时使用
+    char pad0[OS_CACHE_LINE_SIZE - 3 * sizeof(size_t) - sizeof(char *) - sizeof(void *)];
+
+    atomic_size_t enqueue_pos; // 生产位置
+    char pad1[OS_CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+
+    atomic_size_t dequeue_pos; // 消费位置
+    os_allocator_t allocator;  // 分配器, 结构体和槽位数组经由它申请; 只在销毁时读取, 首个缓存行已放满
+    char pad2[OS_CACHE_LINE_SIZE - sizeof(atomic_size_t) - sizeof(os_allocator_t)];
+};
+
+static inline os_mpmc_slot_t * os_mpmc_queue_slot(const os_mpmc_queue_t * q, size_t pos)
+{
+    return (os_mpmc_slot_t *)(q->slots + (pos & q->mask) * q->slot_size);
+}
+
+// 从pos开始统计连续就绪的槽位个数, lag为槽位序号相对pos的偏差
+static size_t os_mpmc_queue_ready(const os_mpmc_queue_t * q, size_t pos, size_t lag, size_t n, intptr_t * diff);
+
+os_mpmc_queue_t * os_mpmc_queue_create(const size_t elem_size, const size_t capacity)
+{
+    return os_mpmc_queue_create_ex(elem_size, capacity, NULL);
+}
+
+os_mpmc_queue_t * os_mpmc_queue_create_ex(const size_t elem_size, const size_t capacity, const os_allocator_t * allocator)
+{
+    if (0u == elem_size || 0u == capacity)
+        return NULL;
+
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    size_t cap = 2u;
+    while (cap < capacity)
+        cap <<= 1;
+
+    // 分配器只保证基本对齐, 多申请一个缓存行后手动对齐
+    void * mem = os_allocator_calloc(allocator, sizeof(os_mpmc_queue_t) + OS_CACHE_LINE_SIZE);
+    if (NULL == mem)
+        return NULL;
+
+    uintptr_t addr = ((uintptr_t)mem + OS_CACHE_LINE_SIZE - 1u) & ~(uintptr_t)(OS_CACHE_LINE_SIZE - 1u);
+    os_mpmc_queue_t * q = (os_mpmc_queue_t *)addr;
+    q->mem = mem;
+    q->allocator = *allocator;
+    q->elem_size = elem_size;
+    q->slot_size = (sizeof(os_mpmc_slot_t) + elem_size + OS_MPMC_SLOT_ALIGN - 1) / OS_MPMC_SLOT_ALIGN * OS_MPMC_SLOT_ALIGN;
+    q->mask = cap - 1;
+    q->slots = (char *)os_allocator_alloc(allocator, cap * q->slot_size);
+    if (NULL == q->slots) {
+        os_allocator_free(allocator, mem, sizeof(os_mpmc_queue_t) + OS_CACHE_LINE_SIZE);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < cap; i++)
+        atomic_init(&os_mpmc_queue_slot(q, i)->seq, i);
+    atomic_init(&q->enqueue_pos, 0u);
+    atomic_init(&q->dequeue_pos, 0u);
+
+    return q;
+}
+
+void os_mpmc_queue_destroy(os_mpmc_queue_t ** q)
+{
+    if (NULL == q || NULL == *q)
+        return;
+
+    os_allocator_t allocator = (*q)->allocator;
+    os_allocator_free(&allocator, (*q)->slots, ((*q)->mask + 1) * (*q)->slot_size);
+    os_allocator_free(&allocator, (*q)->mem, sizeof(os_mpmc_queue_t) + OS_CACHE_LINE_SIZE);
+    *q = NULL;
+}
+
+size_t os_mpmc_queue_capacity(const os_mpmc_queue_t * q)
+{
+    return q ? q->mask + 1 : 0u;
+}
+
+size_t os_mpmc_queue_size(os_mpmc_queue_t * q)
+{
+    if (NULL == q)
+        return 0u;
+
+    size_t head = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    intptr_t size = (intptr_t)(tail - head);
+
+    return size > 0 ? (size_t)size : 0u;
+}
+
+bool os_mpmc_queue_push(os_mpmc_queue_t * q, const void * data)
+{
+    return 1u == os_mpmc_queue_push_n(q, data, 1u);
+}
+
+bool os_mpmc_queue_pop(os_mpmc_queue_t * q, void * data)
+{
+    return 1u == os_mpmc_queue_pop_n(q, data, 1u);
+}
+
+size_t os_mpmc_queue_push_n(os_mpmc_queue_t * q, const void * data, size_t n)
+{
+    if (NULL == q || NULL == data || 0u == n)
+        return 0u;
+
+    size_t cnt = 0u;
+    intptr_t diff = 0;
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        cnt = os_mpmc_queue_ready(q, pos, 0u, n, &diff);
+        if (0u == cnt) {
+            if (diff < 0) // 队列已满
+                return 0u;
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + cnt,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+
+    const char * src = (const char *)data;
+    for (size_t i = 0; i < cnt; i++) {
+        os_mpmc_slot_t * slot = os_mpmc_queue_slot(q, pos + i);
+        memcpy(slot->data, src + i * q->elem_size, q->elem_size);
+        atomic_store_explicit(&slot->seq, pos + i + 1, memory_order_release);
+    }
+
+    return cnt;
+}
+
+size_t os_mpmc_queue_pop_n(os_mpmc_queue_t * q, void * data, size_t n)
+{
+    if (NULL == q || NULL == data || 0u == n)
+        return 0u;
+
+    size_t cnt = 0u;
+    intptr_t diff = 0;
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        cnt = os_mpmc_queue_ready(q, pos, 1u, n, &diff);
+        if (0u == cnt) {
+            if (diff < 0) // 队列为空
+                return 0u;
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + cnt,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+
+    char * dst = (char *)data;
+    for (size_t i = 0; i < cnt; i++) {
+        os_mpmc_slot_t * slot = os_mpmc_queue_slot(q, pos + i);
+        memcpy(dst + i * q->elem_size, slot->data, q->elem_size);
+        atomic_store_explicit(&slot->seq, pos + i + q->mask + 1, memory_order_release);
+    }
+
+    return cnt;
+}
+
+size_t os_mpmc_queue_ready(const os_mpmc_queue_t * q, const size_t pos, const size_t lag, const size_t n, intptr_t * diff)
+{
+    size_t cnt = 0u;
+    while (cnt < n && cnt <= q->mask) {
+        os_mpmc_slot_t * slot = os_mpmc_queue_slot(q, pos + cnt);
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t d = (intptr_t)seq - (intptr_t)(pos + cnt + lag);
+        if (0 != d) {
+            if (0u == cnt)
+                *diff = d;
+            break;
+        }
+        cnt++;
+    }
+
+    return cnt;
+}
@@ -1,8 +1,9 @@
 ﻿#include "os_queue.h"
+#include "os_mempool.h"
+#include "os_stats.h"
 
 #include <stdint.h>
 #include <string.h>
-#include <malloc.h>
 #include <errno.h>
 
 struct _os_queue_node_t {
@@ -16,16 +17,36 @@ struct _os_queue_t {
     size_t node_size;         // 节点大小
     os_queue_node_t * head;   // 队列头
     os_queue_node_t * tail;   // 队列尾
+    os_mempool_t * pool;      // 节点池
+    os_allocator_t allocator; // 分配器, 队列本身和节点池经由它申请
+#if defined(OS_ENABLE_STATS)
+    os_stats_t stats;         // 运行统计
+#endif
 };
 
 os_queue_t * os_queue_create(const uint32_t elem_size)
 {
-    os_queue_t * q = (os_queue_t *)calloc(1, sizeof(os_queue_t));
+    return os_queue_create_ex(elem_size, NULL);
+}
+
+os_queue_t * os_queue_create_ex(const uint32_t elem_size, const os_allocator_t * allocator)
+{
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_queue_t * q = (os_queue_t *)os_allocator_calloc(allocator, sizeof(os_queue_t));
     if (NULL == q)
         return NULL;
 
     q->elem_size = elem_size;
     q->node_size = sizeof(os_queue_node_t) + elem_size;
+    q->allocator = *allocator;
+    q->pool = os_mempool_create_ex(q->node_size, 0u, allocator);
+    if (NULL == q->pool) {
+        os_allocator_free(allocator, q, sizeof(os_queue_t));
+        return NULL;
+    }
+    OS_STATS_ALLOC(q->stats, 1, sizeof(os_queue_t));
 
     return q;
 }
@@ -37,8 +58,10 @@ void os_queue_destroy(os_queue_t ** q)
 
     // 先清空
     os_queue_clear(*q);
+    os_mempool_destroy(&(*q)->pool);
 
-    free(*q);
+    os_allocator_t allocator = (*q)->allocator;
+    os_allocator_free(&allocator, *q, sizeof(os_queue_t));
     *q = NULL;
 }
 
@@ -47,13 +70,12 @@ void os_queue_clear(os_queue_t * q)
     if (NULL == q)
         return;
 
-    while (NULL != q->head) {
-        os_queue_node_t * head = q->head;
-        q->head = q->head->next;
-        free(head);
-        head = NULL;
-        --q->size;
-    }
+    // 节点全部来自节点池, 整块释放即可
+    os_mempool_clear(q->pool);
+    OS_STATS_RELEASE(q->stats, sizeof(os_queue_t), q->node_size);
+    q->head = NULL;
+    q->tail = NULL;
+    q->size = 0u;
 }
 
 bool os_queue_empty(os_queue_t * q)
@@ -71,11 +93,11 @@ bool os_queue_push(os_queue_t * q, void * data)
     if (NULL == q || NULL == data)
         return false;
 
-    os_queue_node_t * node = (os_queue_node_t *)malloc(sizeof(os_queue_node_t) + q->node_size);
+    os_queue_node_t * node = (os_queue_node_t *)os_mempool_alloc(q->pool);
     if (NULL == node)
         return false;
 
-    memcpy(node->data, data, q->node_size);
+    memcpy(node->data, data, q->elem_size);
     node->next = NULL;
     if (0 == q->size) { // 队列为空
         q->head = node;
@@ -85,6 +107,46 @@ bool os_queue_push(os_queue_t * q, void * data)
         q->tail = node;
     }
     ++q->size;
+    OS_STATS_ALLOC(q->stats, 1, q->node_size);
+    OS_STATS_SIZE(q->stats, q->size);
+
+    return true;
+}
+
+bool os_queue_push_n(os_queue_t * q, const void * data, const size_t count)
+{
+    if (NULL == q || NULL == data)
+        return false;
+
+    if (0u == count)
+        return true;
+
+    // 一次预留全部节点, 之后的分配不会失败
+    if (!os_mempool_reserve(q->pool, count))
+        return false;
+
+    // 先在本地串成链, 最后一次性接到队尾
+    const char * src = (const char *)data;
+    os_queue_node_t * first = NULL;
+    os_queue_node_t ** link = &first;
+    os_queue_node_t * node = NULL;
+    for (size_t i = 0; i < count; i++) {
+        node = (os_queue_node_t *)os_mempool_alloc(q->pool);
+        memcpy(node->data, src, q->elem_size);
+        src += q->elem_size;
+        *link = node;
+        link = &node->next;
+    }
+    node->next = NULL;
+
+    if (0u == q->size)
+        q->head = first;
+    else
+        q->tail->next = first;
+    q->tail = node;
+    q->size += count;
+    OS_STATS_ALLOC(q->stats, count, count * q->node_size);
+    OS_STATS_SIZE(q->stats, q->size);
 
     return true;
 }
@@ -96,7 +158,8 @@ bool os_queue_pop(os_queue_t * q)
 
     os_queue_node_t * head = q->head;
     q->head = q->head->next;
-    free(head);
+    os_mempool_free(q->pool, head);
+    OS_STATS_FREE(q->stats, 1, q->node_size);
     --q->size;
     if (0u == q->size)
         q->tail = NULL;
@@ -113,3 +176,41 @@ void * os_queue_getdata(const os_queue_node_t * node)
 {
     return  node ? (void *)node->data : NULL;
 }
+
+bool os_queue_stats(const os_queue_t * q, os_stats_t * stats)
+{
+    if (NULL == stats)
+        return false;
+
+    memset(stats, 0, sizeof(os_stats_t));
+#if defined(OS_ENABLE_STATS)
+    if (NULL == q)
+        return false;
+
+    *stats = q->stats;
+    return true;
+#else
+    return false;
+#endif
+}
+
+int os_queue_foreach(const os_queue_t * q, os_queue_visitor visitor, void * ctx)
+{
+    if (NULL == q || NULL == visitor)
+        return 0;
+
+    // 按OS_PREFETCH的约定预取后继的后继
+    int ret = 0;
+    os_queue_node_t * node = q->head;
+    while (NULL != node) {
+        os_queue_node_t * next = node->next;
+        if (NULL != next)
+            OS_PREFETCH(next->next);
+        ret = visitor(node->data, ctx);
+        if (0 != ret)
+            break;
+        node = next;
+    }
+
+    return ret;
+}
@@ -0,0 +1,182 @@
+﻿#include "os_spsc_queue.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+// head只由消费者写, tail只由生产者写, 两者放在不同的缓存行;
+// 结构体按缓存行对齐分配, 每组字段恰好占满一个缓存行
+struct _os_spsc_queue_t {
+    size_t elem_size;         // 元素大小
+    size_t mask;              // 容量-1
+    char * buffer;            // 元素数组
+    void * mem;               // 结构体的原始内存, 释放时使用
+    os_allocator_t allocator; // 分配器, 结构体和元素数组经由它申请
+    char pad0[OS_CACHE_LINE_SIZE - 2 * sizeof(size_t) - sizeof(char *) - sizeof(void *) - sizeof(os_allocator_t)];
+
+    atomic_size_t head;       // 消费位置
+    size_t tail_cache;        // 消费者缓存的生产位置
+    char pad1[OS_CACHE_LINE_SIZE - sizeof(atomic_size_t) - sizeof(size_t)];
+
+    atomic_size_t tail;       // 生产位置
+    size_t head_cache;        // 生产者缓存的消费位置
+    char pad2[OS_CACHE_LINE_SIZE - sizeof(atomic_size_t) - sizeof(size_t)];
+};
+
+// 从pos开始向环形缓冲区拷入n个元素
+static void os_spsc_queue_copy_in(os_spsc_queue_t * q, size_t pos, const char * data, size_t n);
+// 从pos开始从环形缓冲区拷出n个元素
+static void os_spsc_queue_copy_out(const os_spsc_queue_t * q, size_t pos, char * data, size_t n);
+
+os_spsc_queue_t * os_spsc_queue_create(const size_t elem_size, const size_t capacity)
+{
+    return os_spsc_queue_create_ex(elem_size, capacity, NULL);
+}
+
+os_spsc_queue_t * os_spsc_queue_create_ex(const size_t elem_size, const size_t capacity, const os_allocator_t * allocator)
+{
+    if (0u == elem_size || 0u == capacity)
+        return NULL;
+
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    size_t cap = 1u;
+    while (cap < capacity)
+        cap <<= 1;
+
+    // 分配器只保证基本对齐, 多申请一个缓存行后手动对齐
+    void * mem = os_allocator_calloc(allocator, sizeof(os_spsc_queue_t) + OS_CACHE_LINE_SIZE);
+    if (NULL == mem)
+        return NULL;
+
+    uintptr_t addr = ((uintptr_t)mem + OS_CACHE_LINE_SIZE - 1u) & ~(uintptr_t)(OS_CACHE_LINE_SIZE - 1u);
+    os_spsc_queue_t * q = (os_spsc_queue_t *)addr;
+    q->mem = mem;
+    q->allocator = *allocator;
+    q->buffer = (char *)os_allocator_alloc(allocator, cap * elem_size);
+    if (NULL == q->buffer) {
+        os_allocator_free(allocator, mem, sizeof(os_spsc_queue_t) + OS_CACHE_LINE_SIZE);
+        return NULL;
+    }
+
+    q->elem_size = elem_size;
+    q->mask = cap - 1;
+    atomic_init(&q->head, 0u);
+    atomic_init(&q->tail, 0u);
+
+    return q;
+}
+
+void os_spsc_queue_destroy(os_spsc_queue_t ** q)
+{
+    if (NULL == q || NULL == *q)
+        return;
+
+    os_allocator_t allocator = (*q)->allocator;
+    os_allocator_free(&allocator, (*q)->buffer, ((*q)->mask + 1) * (*q)->elem_size);
+    os_allocator_free(&allocator, (*q)->mem, sizeof(os_spsc_queue_t) + OS_CACHE_LINE_SIZE);
+    *q = NULL;
+}
+
+size_t os_spsc_queue_capacity(const os_spsc_queue_t * q)
+{
+    return q ? q->mask + 1 : 0u;
+}
+
+size_t os_spsc_queue_size(os_spsc_queue_t * q)
+{
+    if (NULL == q)
+        return 0u;
+
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+    return tail - head;
+}
+
+bool os_spsc_queue_empty(os_spsc_queue_t * q)
+{
+    return 0u == os_spsc_queue_size(q);
+}
+
+bool os_spsc_queue_try_push(os_spsc_queue_t * q, const void * data)
+{
+    return 1u == os_spsc_queue_push_n(q, data, 1u);
+}
+
+bool os_spsc_queue_try_pop(os_spsc_queue_t * q, void * data)
+{
+    return 1u == os_spsc_queue_pop_n(q, data, 1u);
+}
+
+size_t os_spsc_queue_push_n(os_spsc_queue_t * q, const void * data, size_t n)
+{
+    if (NULL == q || NULL == data || 0u == n)
+        return 0u;
+
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t free_cnt = q->mask + 1 - (tail - q->head_cache);
+    if (free_cnt < n) {
+        // 缓存不足时才读取消费者的位置
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        free_cnt = q->mask + 1 - (tail - q->head_cache);
+        if (0u == free_cnt)
+            return 0u;
+        if (n > free_cnt)
+            n = free_cnt;
+    }
+
+    os_spsc_queue_copy_in(q, tail, (const char *)data, n);
+    atomic_store_explicit(&q->tail, tail + n, memory_order_release);
+
+    return n;
+}
+
+size_t os_spsc_queue_pop_n(os_spsc_queue_t * q, void * data, size_t n)
+{
+    if (NULL == q || NULL == data || 0u == n)
+        return 0u;
+
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t used = q->tail_cache - head;
+    if (used < n) {
+        // 缓存不足时才读取生产者的位置
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        used = q->tail_cache - head;
+        if (0u == used)
+            return 0u;
+        if (n > used)
+            n = used;
+    }
+
+    os_spsc_queue_copy_out(q, head, (char *)data, n);
+    atomic_store_explicit(&q->head, head + n, memory_order_release);
+
+    return n;
+}
+
+void os_spsc_queue_copy_in(os_spsc_queue_t * q, const size_t pos, const char * data, const size_t n)
+{
+    size_t idx = pos & q->mask;
+    size_t first = q->mask + 1 - idx;
+    if (first > n)
+        first = n;
+
+    memcpy(q->buffer + idx * q->elem_size, data, first * q->elem_size);
+    if (first < n)
+        memcpy(q->buffer, data + first * q->elem_size, (n - first) * q->elem_size);
+}
+
+void os_spsc_queue_copy_out(const os_spsc_queue_t * q, const size_t pos, char * data, const size_t n)
+{
+    size_t idx = pos & q->mask;
+    size_t first = q->mask + 1 - idx;
+    if (first > n)
+        first = n;
+
+    memcpy(data, q->buffer + idx * q->elem_size, first * q->elem_size);
+    if (first < n)
+        memcpy(data + first * q->elem_size, q->buffer, (n - first) * q->elem_size);
+}
@@ -0,0 +1,473 @@
+﻿#include "os_btree.h"
+#include "os_mempool.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define OS_BTREE_NODE_BYTES  256u  // 默认节点元素区大小, 4个缓存行
+#define OS_BTREE_MIN_DEGREE  2u    // 最小度数, 即扇出4
+#define OS_BTREE_MAX_DEPTH   64    // 度数不小于2时树高不超过64
+
+typedef struct _os_btree_node_t os_btree_node_t;
+
+// 叶子只有元素区, 内部节点在元素区之后按指针对齐存放孩子指针
+struct _os_btree_node_t {
+    uint32_t count;     // 元素个数
+    uint32_t leaf;      // 是否为叶子
+    char data[0];       // 元素
+};
+
+struct _os_btree_t {
+    size_t size;                // 元素个数
+    size_t elem_size;           // 元素大小
+    size_t degree;              // 最小度数t, 非根节点元素个数在[t-1, 2t-1]
+    size_t max_keys;            // 节点最多元素个数2t-1
+    size_t child_offset;        // 孩子指针相对元素区的偏移
+    os_btree_node_t * root;     // 根节点
+    os_btree_compare cmp;       // 比较函数
+    os_mempool_t * leaf_pool;   // 叶子节点池
+    os_mempool_t * inner_pool;  // 内部节点池
+    os_allocator_t allocator;   // 分配器, B树本身和节点池经由它申请
+};
+
+// 节点内第i个元素
+static inline char * os_btree_elem(const os_btree_t * bt, const os_btree_node_t * node, size_t i);
+// 内部节点的孩子数组
+static inline os_btree_node_t ** os_btree_children(const os_btree_t * bt, const os_btree_node_t * node);
+// 节点内二分查找第一个不小于data的位置, found返回是否相等
+static size_t os_btree_search(const os_btree_t * bt, const os_btree_node_t * node, const void * data, bool * found);
+// 申请节点
+static os_btree_node_t * os_btree_new_node(os_btree_t * bt, bool leaf);
+// 释放节点
+static void os_btree_free_node(os_btree_t * bt, os_btree_node_t * node);
+// 分裂parent的第i个孩子, 孩子必须是满的
+static bool os_btree_split_child(os_btree_t * bt, os_btree_node_t * parent, size_t i);
+// 第i个孩子从左兄弟借一个元素
+static void os_btree_borrow_left(os_btree_t * bt, os_btree_node_t * parent, size_t i);
+// 第i个孩子从右兄弟借一个元素
+static void os_btree_borrow_right(os_btree_t * bt, os_btree_node_t * parent, size_t i);
+// 合并第i个和第i+1个孩子, 中间元素下移
+static void os_btree_merge(os_btree_t * bt, os_btree_node_t * parent, size_t i);
+
+os_btree_t * os_btree_create(size_t elem_size, os_btree_compare cmp)
+{
+    return os_btree_create_fanout(elem_size, cmp, 0u);
+}
+
+os_btree_t * os_btree_create_fanout(size_t elem_size, os_btree_compare cmp, size_t fanout)
+{
+    return os_btree_create_ex(elem_size, cmp, fanout, NULL);
+}
+
+os_btree_t * os_btree_create_ex(size_t elem_size, os_btree_compare cmp, size_t fanout, const os_allocator_t * allocator)
+{
+    if (0u == elem_size || NULL == cmp)
+        return NULL;
+
+    if (NULL == allocator)
+        allocator = os_allocator_default();
+
+    os_btree_t * bt = (os_btree_t *)os_allocator_calloc(allocator, sizeof(os_btree_t));
+    if (NULL == bt)
+        return NULL;
+
+    bt->allocator = *allocator;
+
+    if (0u == fanout)
+        fanout = OS_BTREE_NODE_BYTES / elem_size + 1u;
+
+    bt->elem_size = elem_size;
+    bt->degree = fanout / 2u < OS_BTREE_MIN_DEGREE ? OS_BTREE_MIN_DEGREE : fanout / 2u;
+    bt->max_keys = 2u * bt->degree - 1u;
+    bt->child_offset = (bt->max_keys * elem_size + sizeof(void *) - 1u) / sizeof(void *) * sizeof(void *);
+    bt->cmp = cmp;
+    bt->root = NULL;
+
+    size_t leaf_size = sizeof(os_btree_node_t) + bt->max_keys * elem_size;
+    size_t inner_size = sizeof(os_btree_node_t) + bt->child_offset + (bt->max_keys + 1u) * sizeof(os_btree_node_t *);
+    bt->leaf_pool = os_mempool_create_ex(leaf_size, 0u, allocator);
+    bt->inner_pool = os_mempool_create_ex(inner_size, 0u, allocator);
+    if (NULL == bt->leaf_pool || NULL == bt->inner_pool) {
+        os_mempool_destroy(&bt->leaf_pool);
+        os_mempool_destroy(&bt->inner_pool);
+        os_allocator_free(allocator, bt, sizeof(os_btree_t));
+        return NULL;
+    }
+
+    return bt;
+}
+
+void os_btree_destroy(os_btree_t ** bt)
+{
+    if (NULL == bt || NULL == *bt)
+        return;
+
+    os_mempool_destroy(&(*bt)->leaf_pool);
+    os_mempool_destroy(&(*bt)->inner_pool);
+
+    os_allocator_t allocator = (*bt)->allocator;
+    os_allocator_free(&allocator, *bt, sizeof(os_btree_t));
+    *bt = NULL;
+}
+
+void os_btree_clear(os_btree_t * bt)
+{
+    if (NULL == bt)
+        return;
+
+    os_mempool_clear(bt->leaf_pool);
+    os_mempool_clear(bt->inner_pool);
+    bt->root = NULL;
+    bt->size = 0u;
+}
+
+bool os_btree_insert(os_btree_t * bt, const void * data)
+{
+    if (NULL == bt || NULL == data)
+        return false;
+
+    if (NULL == bt->root) {
+        bt->root = os_btree_new_node(bt, true);
+        if (NULL == bt->root)
+            return false;
+    }
+
+    // 根满时先长高一层
+    if (bt->max_keys == bt->root->count) {
+        os_btree_node_t * root = os_btree_new_node(bt, false);
+        if (NULL == root)
+            return false;
+        os_btree_children(bt, root)[0] = bt->root;
+        if (!os_btree_split_child(bt, root, 0u)) {
+            os_btree_free_node(bt, root);
+            return false;
+        }
+        bt->root = root;
+    }
+
+    // 自顶向下预先分裂满节点, 到达叶子时一定有空位; 中途失败时已完成的分裂仍然合法
+    os_btree_node_t * node = bt->root;
+    for (;;) {
+        bool found = false;
+        size_t i = os_btree_search(bt, node, data, &found);
+        if (found)
+            return true;
+
+        if (node->leaf) {
+            memmove(os_btree_elem(bt, node, i + 1u), os_btree_elem(bt, node, i), (node->count - i) * bt->elem_size);
+            memcpy(os_btree_elem(bt, node, i), data, bt->elem_size);
+            ++node->count;
+            ++bt->size;
+            return true;
+        }
+
+        os_btree_node_t ** children = os_btree_children(bt, node);
+        if (bt->max_keys == children[i]->count) {
+            if (!os_btree_split_child(bt, node, i))
+                return false;
+            int ret = bt->cmp(os_btree_elem(bt, node, i), data, bt->elem_size);
+            if (0 == ret)
+                return true;
+            if (ret < 0)
+                ++i;
+        }
+        node = children[i];
+    }
+}
+
+bool os_btree_erase(os_btree_t * bt, const void * data)
+{
+    if (NULL == bt || NULL == data || NULL == bt->root)
+        return false;
+
+    // 自顶向下保证进入的孩子至少有t个元素, 叶子删除后不会少于t-1个
+    bool erased = false;
+    const void * key = data;
+    os_btree_node_t * node = bt->root;
+    for (;;) {
+        bool found = false;
+        size_t i = os_btree_search(bt, node, key, &found);
+        if (node->leaf) {
+            if (found) {
+                memmove(os_btree_elem(bt, node, i), os_btree_elem(bt, node, i + 1u), (node->count - i - 1u) * bt->elem_size);
+                --node->count;
+                erased = true;
+            }
+            break;
+        }
+
+        os_btree_node_t ** children = os_btree_children(bt, node);
+        if (found) {
+            os_btree_node_t * left = children[i];
+            os_btree_node_t * right = children[i + 1u];
+            if (left->count >= bt->degree) {
+                // 用前驱顶替, 再到左子树删除前驱
+                os_btree_node_t * pred = left;
+                while (!pred->leaf)
+                    pred = os_btree_children(bt, pred)[pred->count];
+                memcpy(os_btree_elem(bt, node, i), os_btree_elem(bt, pred, pred->count - 1u), bt->elem_size);
+                key = os_btree_elem(bt, node, i);
+                node = left;
+            } else if (right->count >= bt->degree) {
+                // 用后继顶替, 再到右子树删除后继
+                os_btree_node_t * succ = right;
+                while (!succ->leaf)
+                    succ = os_btree_children(bt, succ)[0];
+                memcpy(os_btree_elem(bt, node, i), os_btree_elem(bt, succ, 0u), bt->elem_size);
+                key = os_btree_elem(bt, node, i);
+                node = right;
+            } else {
+                os_btree_merge(bt, node, i);
+                node = left;
+            }
+            continue;
+        }
+
+        if (children[i]->count < bt->degree) {
+            if (i > 0u && children[i - 1u]->count >= bt->degree)
+                os_btree_borrow_left(bt, node, i);
+            else if (i < node->count && children[i + 1u]->count >= bt->degree)
+                os_btree_borrow_right(bt, node, i);
+            else if (i < node->count)
+                os_btree_merge(bt, node, i);
+            else
+                os_btree_merge(bt, node, --i);
+        }
+        node = children[i];
+    }
+
+    // 根的最后一个元素下移后降低一层
+    os_btree_node_t * root = bt->root;
+    if (0u == root->count) {
+        bt->root = root->leaf ? NULL : os_btree_children(bt, root)[0];
+        os_btree_free_node(bt, root);
+    }
+
+    if (erased)
+        --bt->size;
+
+    return erased;
+}
+
+void * os_btree_find(const os_btree_t * bt, const void * data)
+{
+    if (NULL == bt || NULL == data)
+        return NULL;
+
+    os_btree_node_t * node = bt->root;
+    while (NULL != node) {
+        bool found = false;
+        size_t i = os_btree_search(bt, node, data, &found);
+        if (found)
+            return os_btree_elem(bt, node, i);
+        if (node->leaf)
+            break;
+        node = os_btree_children(bt, node)[i];
+    }
+
+    return NULL;
+}
+
+size_t os_btree_size(const os_btree_t * bt)
+{
+    return bt ? bt->size : 0u;
+}
+
+bool os_btree_empty(const os_btree_t * bt)
+{
+    return bt ? 0u == bt->size : true;
+}
+
+int os_btree_foreach(const os_btree_t * bt, os_btree_visitor visitor, void * ctx)
+{
+    return os_btree_range(bt, NULL, NULL, visitor, ctx);
+}
+
+int os_btree_range(const os_btree_t * bt, const void * lo, const void * hi, os_btree_visitor visitor, void * ctx)
+{
+    if (NULL == bt || NULL == visitor || NULL == bt->root)
+        return 0;
+
+    // 栈中每层记录节点和下一个要访问的元素下标, 该下标左侧的孩子已访问完
+    os_btree_node_t * nodes[OS_BTREE_MAX_DEPTH];
+    size_t index[OS_BTREE_MAX_DEPTH];
+    int depth = 0;
+
+    // 沿lo的查找路径入栈, 在内部节点命中时不再下探
+    os_btree_node_t * node = bt->root;
+    for (;;) {
+        bool found = false;
+        size_t i = NULL == lo ? 0u : os_btree_search(bt, node, lo, &found);
+        nodes[depth] = node;
+        index[depth] = i;
+        ++depth;
+        if (node->leaf || found)
+            break;
+        node = os_btree_children(bt, node)[i];
+    }
+
+    int ret = 0;
+    while (depth > 0) {
+        node = nodes[depth - 1];
+        size_t i = index[depth - 1];
+        if (i >= node->count) {
+            --depth;
+            continue;
+        }
+
+        const char * elem = os_btree_elem(bt, node, i);
+        if (NULL != hi && bt->cmp(elem, hi, bt->elem_size) >= 0)
+            break;
+        index[depth - 1] = i + 1u;
+
+        // 内部节点访问元素前先预取右侧孩子, visitor的执行时间可以掩盖其访存延迟
+        os_btree_node_t * child = node->leaf ? NULL : os_btree_children(bt, node)[i + 1u];
+        OS_PREFETCH(child);
+        ret = visitor(elem, ctx);
+        if (0 != ret)
+            break;
+
+        while (NULL != child) {
+            nodes[depth] = child;
+            index[depth] = 0u;
+            ++depth;
+            child = child->leaf ? NULL : os_btree_children(bt, child)[0];
+        }
+    }
+
+    return ret;
+}
+
+char * os_btree_elem(const os_btree_t * bt, const os_btree_node_t * node, size_t i)
+{
+    return (char *)node->data + i * bt->elem_size;
+}
+
+os_btree_node_t ** os_btree_children(const os_btree_t * bt, const os_btree_node_t * node)
+{
+    return (os_btree_node_t **)((char *)node->data + bt->child_offset);
+}
+
+size_t os_btree_search(const os_btree_t * bt, const os_btree_node_t * node, const void * data, bool * found)
+{
+    size_t lo = 0u;
+    size_t hi = node->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2u;
+        int ret = bt->cmp(os_btree_elem(bt, node, mid), data, bt->elem_size);
+        if (ret < 0) {
+            lo = mid + 1u;
+        } else if (ret > 0) {
+            hi = mid;
+        } else {
+            *found = true;
+            return mid;
+        }
+    }
+
+    *found = false;
+    return lo;
+}
+
+os_btree_node_t * os_btree_new_node(os_btree_t * bt, bool leaf)
+{
+    os_btree_node_t * node = (os_btree_node_t *)os_mempool_alloc(leaf ? bt->leaf_pool : bt->inner_pool);
+    if (NULL == node)
+        return NULL;
+
+    node->count = 0u;
+    node->leaf = leaf ? 1u : 0u;
+
+    return node;
+}
+
+void os_btree_free_node(os_btree_t * bt, os_btree_node_t * node)
+{
+    os_mempool_free(node->leaf ? bt->leaf_pool : bt->inner_pool, node);
+}
+
+bool os_btree_split_child(os_btree_t * bt, os_btree_node_t * parent, size_t i)
+{
+    os_btree_node_t ** children = os_btree_children(bt, parent);
+    os_btree_node_t * full = children[i];
+    os_btree_node_t * sibling = os_btree_new_node(bt, 0u != full->leaf);
+    if (NULL == sibling)
+        return false;
+
+    // 后t-1个元素移到新节点, 中间元素上移到parent
+    size_t t = bt->degree;
+    memcpy(os_btree_elem(bt, sibling, 0u), os_btree_elem(bt, full, t), (t - 1u) * bt->elem_size);
+    if (!full->leaf)
+        memcpy(os_btree_children(bt, sibling), os_btree_children(bt, full) + t, t * sizeof(os_btree_node_t *));
+    sibling->count = (uint32_t)(t - 1u);
+    full->count = (uint32_t)(t - 1u);
+
+    memmove(children + i + 2u, children + i + 1u, (parent->count - i) * sizeof(os_btree_node_t *));
+    children[i + 1u] = sibling;
+    memmove(os_btree_elem(bt, parent, i + 1u), os_btree_elem(bt, parent, i), (parent->count - i) * bt->elem_size);
+    memcpy(os_btree_elem(bt, parent, i), os_btree_elem(bt, full, t - 1u), bt->elem_size);
+    ++parent->count;
+
+    return true;
+}
+
+void os_btree_borrow_left(os_btree_t * bt, os_btree_node_t * parent, size_t i)
+{
+    os_btree_node_t ** children = os_btree_children(bt, parent);
+    os_btree_node_t * child = children[i];
+    os_btree_node_t * left = children[i - 1u];
+
+    // parent的分隔元素下移到child头部, left的最后一个元素上移
+    memmove(os_btree_elem(bt, child, 1u), os_btree_elem(bt, child, 0u), child->count * bt->elem_size);
+    memcpy(os_btree_elem(bt, child, 0u), os_btree_elem(bt, parent, i - 1u), bt->elem_size);
+    if (!child->leaf) {
+        os_btree_node_t ** dst = os_btree_children(bt, child);
+        memmove(dst + 1, dst, (child->count + 1u) * sizeof(os_btree_node_t *));
+        dst[0] = os_btree_children(bt, left)[left->count];
+    }
+    memcpy(os_btree_elem(bt, parent, i - 1u), os_btree_elem(bt, left, left->count - 1u), bt->elem_size);
+
+    ++child->count;
+    --left->count;
+}
+
+void os_btree_borrow_right(os_btree_t * bt, os_btree_node_t * parent, size_t i)
+{
+    os_btree_node_t ** children = os_btree_children(bt, parent);
+    os_btree_node_t * child = children[i];
+    os_btree_node_t * right = children[i + 1u];
+
+    // parent的分隔元素下移到child尾部, right的第一个元素上移
+    memcpy(os_btree_elem(bt, child, child->count), os_btree_elem(bt, parent, i), bt->elem_size);
+    memcpy(os_btree_elem(bt, parent, i), os_btree_elem(bt, right, 0u), bt->elem_size);
+    memmove(os_btree_elem(bt, right, 0u), os_btree_elem(bt, right, 1u), (right->count - 1u) * bt->elem_size);
+    if (!child->leaf) {
+        os_btree_node_t ** src = os_btree_children(bt, right);
+        os_btree_children(bt, child)[child->count + 1u] = src[0];
+        memmove(src, src + 1, right->count * sizeof(os_btree_node_t *));
+    }
+
+    ++child->count;
+    --right->count;
+}
+
+void os_btree_merge(os_btree_t * bt, os_btree_node_t * parent, size_t i)
+{
+    os_btree_node_t ** children = os_btree_children(bt, parent);
+    os_btree_node_t * left = children[i];
+    os_btree_node_t * right = children[i + 1u];
+
+    memcpy(os_btree_elem(bt, left, left->count), os_btree_elem(bt, parent, i), bt->elem_size);
+    memcpy(os_btree_elem(bt, left, left->count + 1u), os_btree_elem(bt, right, 0u), right->count * bt->elem_size);
+    if (!left->leaf)
+        memcpy(os_btree_children(bt, left) + left->count + 1u, os_btree_children(bt, right),
+               (right->count + 1u) * sizeof(os_btree_node_t *));
+    left->count += right->count + 1u;
+
+    memmove(os_btree_elem(bt, parent, i), os_btree_elem(bt, parent, i + 1u), (parent->count - i - 1u) * bt->elem_size);
+    memmove(children + i + 1u, children + i + 2u, (parent->count - i - 1u) * sizeof(os_btree_node_t *));
+    --parent->count;
+
+    os_btree_free_node(bt, right);
+}
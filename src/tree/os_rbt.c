@@ -1,7 +1,40 @@
 ﻿#include "os_rbt.h"
+#include "os_mempool.h"
+#include "os_epoch.h"
+#include "os_mapfile.h"
+#include "os_stats.h"
 
 #include <string.h>
-#include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+
+typedef CRITICAL_SECTION os_rbt_mutex_t;
+#else
+#include <sched.h>
+#include <pthread.h>
+
+typedef pthread_mutex_t os_rbt_mutex_t;
+#endif
+
+#define OS_RBT_MAX_DEPTH 64  // 平衡构建时树高不超过64
+
+#define OS_RBT_SNAPSHOT_MAGIC       "OSRBT\0\0\0"
+#define OS_RBT_SNAPSHOT_VERSION     1u
+#define OS_RBT_SNAPSHOT_BYTE_ORDER  0x01020304u           // 按本机字节序写入, 读出不一致说明文件来自字节序不同的机器
+#define OS_RBT_SNAPSHOT_DATA_OFFSET OS_CACHE_LINE_SIZE    // 元素区起始偏移, 映射按页对齐, 元素区因此按缓存行对齐
+
+// 查找接口也要累计统计, 只经由原子的OS_STATS_ADD修改, 多个线程同时查找也没有数据竞争
+#define OS_RBT_STATS(rbt)           (((os_rbt_t *)(rbt))->stats)
+
+// 并发模式下读者读取写者可能同时修改的根和孩子指针, 与OS_RBT_STORE配对
+#define OS_RBT_LOAD(ptr) atomic_load_explicit((_Atomic(os_rbt_node_t *) *)&(ptr), memory_order_acquire)
+// 写者修改读者可能同时读取的根和孩子指针; 新节点接入后还会被旋转移动,
+// 每次写入都用release, 读者无论经由哪条链接读到节点, 都能看到节点初始化的内容
+#define OS_RBT_STORE(ptr, val) atomic_store_explicit((_Atomic(os_rbt_node_t *) *)&(ptr), (val), memory_order_release)
 
 typedef enum _OS_RBT_COLOR_TYPE
 {
@@ -9,53 +42,180 @@ typedef enum _OS_RBT_COLOR_TYPE
 	OS_RBT_COLOR_BLACK
 } OS_RBT_COLOR_TYPE;
 
+typedef enum _OS_RBT_LOOKUP_TYPE
+{
+	OS_RBT_LOOKUP_EQUAL,  // 等于
+	OS_RBT_LOOKUP_LOWER,  // 第一个不小于
+	OS_RBT_LOOKUP_UPPER,  // 第一个大于
+	OS_RBT_LOOKUP_FIRST,  // 最小, 不需要data
+	OS_RBT_LOOKUP_LAST    // 最大, 不需要data
+} OS_RBT_LOOKUP_TYPE;
+
+// 节点至少按指针对齐, 父节点指针的最低位恒为0, 用来存放颜色
+// x86-64上节点头由32字节(颜色4字节+填充4字节+3个指针)缩小为24字节,
+// 8字节键值的节点由40字节缩小为32字节, 节点池按16字节对齐后每个节点占用由48字节降为32字节
 struct _os_rbt_node_t {
-	OS_RBT_COLOR_TYPE color;
-	struct _os_rbt_node_t * parent;
-	struct _os_rbt_node_t * left;
-	struct _os_rbt_node_t * right;
+	uintptr_t parent_color;          // 父节点指针 | 颜色
+	struct _os_rbt_node_t * left;    // 左孩子, NULL表示空
+	struct _os_rbt_node_t * right;   // 右孩子, NULL表示空
 	char data[0];
 };
 
 struct _os_rbt_t {
-	size_t size;
+	atomic_size_t size;     // 元素个数, 并发模式下读者不加锁读取
 	size_t elem_size;
 	size_t node_size;
 	os_rbt_node_t * root;
-	os_rbt_node_t * nil;
+	os_rbt_node_t * first;  // 最小节点, 并发模式下只有写者读取
+	os_rbt_node_t * last;   // 最大节点, 并发模式下只有写者读取
 	os_rbt_compare cmp;
+	os_mempool_t * pool;    // 节点池
+	os_allocator_t allocator; // 分配器, 树本身和节点池经由它申请
+	// 并发模式: 写者之间用互斥锁串行, 修改期间序号为奇数; 读者不加锁, 遍历前后序号不变才采用结果,
+	// 删除的节点交给纪元回收器, 读者离开后才归还节点池
+	bool concurrent;        // 是否为并发模式
+	atomic_uint seq;        // 修改序号
+	os_epoch_t * epoch;     // 节点回收器
+	os_rbt_mutex_t lock;    // 写者互斥锁
+#if defined(OS_ENABLE_STATS)
+	os_stats_t stats;       // 运行统计, 并发模式下只统计写者一侧
+#endif
+};
+
+// 平衡构建时待处理的子区间
+typedef struct _os_rbt_build_frame_t {
+	size_t lo;                  // 区间起始(包含)
+	size_t hi;                  // 区间结束(不包含)
+	size_t depth;               // 子树根的深度
+	os_rbt_node_t * parent;     // 父节点
+	os_rbt_node_t ** slot;      // 父节点中指向子树根的位置
+} os_rbt_build_frame_t;
+
+// 快照文件头, 其后是按键值递增连续存放的元素, 文件中不含任何指针,
+// 映射后直接在元素区上二分查找, 不需要反序列化
+typedef struct _os_rbt_snapshot_header_t {
+	char magic[8];          // 文件标识
+	uint32_t version;       // 格式版本
+	uint32_t byte_order;    // 字节序标记
+	uint64_t elem_size;     // 元素大小
+	uint64_t count;         // 元素个数
+	uint64_t data_offset;   // 元素区相对文件起始的偏移
+} os_rbt_snapshot_header_t;
+
+// 映射的快照, 只读
+struct _os_rbt_view_t {
+	os_mapfile_t * map;     // 文件映射
+	const char * elems;     // 元素区
+	size_t elem_size;       // 元素大小
+	size_t count;           // 元素个数
+	os_rbt_compare cmp;     // 键值比较函数
 };
 
+// 父节点
+static inline os_rbt_node_t * os_rbt_parent(const os_rbt_node_t * node);
+// 节点颜色
+static inline OS_RBT_COLOR_TYPE os_rbt_color(const os_rbt_node_t * node);
+// 是否为红色, 空节点为黑色
+static inline bool os_rbt_is_red(const os_rbt_node_t * node);
+// 设置父节点, 保留颜色
+static inline void os_rbt_set_parent(os_rbt_node_t * node, os_rbt_node_t * parent);
+// 设置颜色, 保留父节点
+static inline void os_rbt_set_color(os_rbt_node_t * node, OS_RBT_COLOR_TYPE color);
 // 创建一个节点
 static os_rbt_node_t * os_rbt_new_node(const os_rbt_t * rbt, void * data);
+// 插入节点, 调用方持有写锁
+static bool os_rbt_insert_node(os_rbt_t * rbt, void * data);
+// 由严格递增的数组构建平衡树, 调用方持有写锁并已预留节点
+static void os_rbt_build(os_rbt_t * rbt, const char * elems, size_t count);
+// 从树中摘除节点, 不释放, 调用方持有写锁
+static void os_rbt_unlink(os_rbt_t * rbt, os_rbt_node_t * node);
+// 查找等于data的节点, 不考虑并发
+static os_rbt_node_t * os_rbt_search(const os_rbt_t * rbt, const void * data);
+// 并发模式下查找, 与写者冲突时重试, 调用方处于读区间内
+static os_rbt_node_t * os_rbt_read_lookup(const os_rbt_t * rbt, const void * data, OS_RBT_LOOKUP_TYPE type);
+// 并发模式下遍历[lo, hi), 每一步在读区间内查找上一个元素的后继, visitor在读区间外调用
+static int os_rbt_read_range(const os_rbt_t * rbt, const void * lo, const void * hi, os_rbt_visitor visitor, void * ctx);
+// 回收器释放节点的回调, ctx为节点池
+static void os_rbt_reclaim_node(void * node, void * ctx);
+static bool os_rbt_sync_init(os_rbt_t * rbt);
+static void os_rbt_sync_destroy(os_rbt_t * rbt);
+// 并发模式下加写锁, 否则什么也不做
+static void os_rbt_lock(const os_rbt_t * rbt);
+static void os_rbt_unlock(const os_rbt_t * rbt);
+// 并发模式下标记修改开始和结束
+static void os_rbt_modify_begin(os_rbt_t * rbt);
+static void os_rbt_modify_end(os_rbt_t * rbt);
+// 让出处理器
+static void os_rbt_yield(void);
 // 左旋转
 static void os_rbt_left_rotate(os_rbt_t * rbt, os_rbt_node_t * node);
 // 右旋转
 static void os_rbt_right_rotate(os_rbt_t * rbt, os_rbt_node_t * node);
 // 插入后修复
 static void os_rbt_insert_fixup(os_rbt_t * rbt, os_rbt_node_t * node);
+// 用子树v替换子树u
+static void os_rbt_transplant(os_rbt_t * rbt, os_rbt_node_t * u, os_rbt_node_t * v);
+// 删除后修复, node可能为空, 因此需要同时传入其父节点
+static void os_rbt_erase_fixup(os_rbt_t * rbt, os_rbt_node_t * node, os_rbt_node_t * parent);
+// 子树最小节点
+static os_rbt_node_t * os_rbt_minimum(os_rbt_node_t * node);
+// 子树最大节点
+static os_rbt_node_t * os_rbt_maximum(os_rbt_node_t * node);
+// 第一个不小于(inclusive为true)或大于data的节点
+static os_rbt_node_t * os_rbt_bound(const os_rbt_t * rbt, const void * data, bool inclusive);
+// 快照中第一个不小于(inclusive为true)或大于data的元素下标, 不存在时返回count
+static size_t os_rbt_view_bound(const os_rbt_view_t * view, const void * data, bool inclusive);
 
 os_rbt_t * os_rbt_create(size_t elem_size, os_rbt_compare cmp)
+{
+	return os_rbt_create_ex(elem_size, cmp, NULL);
+}
+
+os_rbt_t * os_rbt_create_ex(size_t elem_size, os_rbt_compare cmp, const os_allocator_t * allocator)
 {
 	if (0u == elem_size || NULL == cmp)
 		return NULL;
 
-	os_rbt_t * rbt = (os_rbt_t *)calloc(1, sizeof(os_rbt_t));
+	if (NULL == allocator)
+		allocator = os_allocator_default();
+
+	os_rbt_t * rbt = (os_rbt_t *)os_allocator_calloc(allocator, sizeof(os_rbt_t));
 	if (NULL == rbt)
 		return NULL;
 
+	rbt->allocator = *allocator;
 	rbt->elem_size = elem_size;
 	rbt->node_size = sizeof(os_rbt_node_t) + elem_size;
-	rbt->cmp = cmp ? cmp : memcmp;
+	rbt->cmp = cmp;
+	rbt->root = NULL;
+	rbt->first = NULL;
+	rbt->last = NULL;
+	atomic_init(&rbt->size, 0u);
+	atomic_init(&rbt->seq, 0u);
 
-	rbt->nil = (os_rbt_node_t *)calloc(1, sizeof(os_rbt_node_t));
-	if (NULL == rbt->nil) {
-		free(rbt);
+	rbt->pool = os_mempool_create_ex(rbt->node_size, 0u, allocator);
+	if (NULL == rbt->pool) {
+		os_allocator_free(allocator, rbt, sizeof(os_rbt_t));
 		return NULL;
 	}
+	OS_STATS_ALLOC(rbt->stats, 1, sizeof(os_rbt_t));
+
+	return rbt;
+}
+
+os_rbt_t * os_rbt_create_concurrent(size_t elem_size, os_rbt_compare cmp)
+{
+	os_rbt_t * rbt = os_rbt_create(elem_size, cmp);
+	if (NULL == rbt)
+		return NULL;
 
-	rbt->nil->color = OS_RBT_COLOR_BLACK;
-	rbt->root = rbt->nil;
+	rbt->epoch = os_epoch_create(os_rbt_reclaim_node, rbt->pool);
+	if (NULL == rbt->epoch || !os_rbt_sync_init(rbt)) {
+		os_epoch_destroy(&rbt->epoch);
+		os_rbt_destroy(&rbt);
+		return NULL;
+	}
+	rbt->concurrent = true;
 
 	return rbt;
 }
@@ -65,13 +225,35 @@ void os_rbt_destroy(os_rbt_t ** rbt)
 	if (NULL == rbt || NULL == *rbt)
 		return;
 
-	os_rbt_clear(*rbt);
-	free(*rbt);
+	if ((*rbt)->concurrent) {
+		os_rbt_sync_destroy(*rbt);
+		os_epoch_destroy(&(*rbt)->epoch);
+	}
+	os_mempool_destroy(&(*rbt)->pool);
+	os_allocator_t allocator = (*rbt)->allocator;
+	os_allocator_free(&allocator, *rbt, sizeof(os_rbt_t));
 	*rbt = NULL;
 }
 
 void os_rbt_clear(os_rbt_t * rbt)
 {
+	if (NULL == rbt)
+		return;
+
+	os_rbt_lock(rbt);
+	os_rbt_modify_begin(rbt);
+	OS_RBT_STORE(rbt->root, NULL);
+	rbt->first = NULL;
+	rbt->last = NULL;
+	atomic_store_explicit(&rbt->size, 0u, memory_order_relaxed);
+	os_rbt_modify_end(rbt);
+
+	// 节点都在节点池中, 整体释放即可, 不需要遍历树; 并发模式下先等读者离开旧节点
+	if (rbt->concurrent)
+		os_epoch_synchronize(rbt->epoch);
+	os_mempool_clear(rbt->pool);
+	OS_STATS_RELEASE(rbt->stats, sizeof(os_rbt_t), rbt->node_size);
+	os_rbt_unlock(rbt);
 }
 
 bool os_rbt_insert(os_rbt_t * rbt, void * data)
@@ -79,51 +261,585 @@ bool os_rbt_insert(os_rbt_t * rbt, void * data)
 	if (NULL == rbt || NULL == data)
 		return false;
 
-	os_rbt_node_t * tmp = rbt->nil;
+	os_rbt_lock(rbt);
+	bool ret = os_rbt_insert_node(rbt, data);
+	os_rbt_unlock(rbt);
+
+	return ret;
+}
+
+bool os_rbt_build_sorted(os_rbt_t * rbt, const void * array, size_t count)
+{
+	if (NULL == rbt || (NULL == array && 0u != count))
+		return false;
+
+	const char * elems = (const char *)array;
+	OS_STATS_ADD(rbt->stats, compares, count > 1u ? count - 1u : 0u);
+	for (size_t i = 1u; i < count; ++i) {
+		if (rbt->cmp(elems + (i - 1u) * rbt->elem_size, elems + i * rbt->elem_size, rbt->elem_size) >= 0)
+			return false;
+	}
+
+	os_rbt_lock(rbt);
+	bool ret = 0u == atomic_load_explicit(&rbt->size, memory_order_relaxed);
+	if (ret && 0u != count) {
+		// 树为空时池中只有已归还和待回收的节点, 等读者离开后整体释放再一次预留, 全部节点来自同一个内存块
+		if (rbt->concurrent)
+			os_epoch_synchronize(rbt->epoch);
+		os_mempool_clear(rbt->pool);
+		OS_STATS_RELEASE(rbt->stats, sizeof(os_rbt_t), rbt->node_size);
+		ret = os_mempool_reserve(rbt->pool, count);
+	}
+	if (ret && 0u != count) {
+		os_rbt_modify_begin(rbt);
+		os_rbt_build(rbt, elems, count);
+		os_rbt_modify_end(rbt);
+	}
+	os_rbt_unlock(rbt);
+
+	return ret;
+}
+
+bool os_rbt_erase(os_rbt_t * rbt, const void * data)
+{
+	if (NULL == rbt || NULL == data)
+		return false;
+
+	os_rbt_lock(rbt);
+	os_rbt_node_t * node = os_rbt_search(rbt, data);
+	if (NULL != node) {
+		os_rbt_modify_begin(rbt);
+		os_rbt_unlink(rbt, node);
+		os_rbt_modify_end(rbt);
+		OS_STATS_FREE(rbt->stats, 1, rbt->node_size);
+		// 并发模式下读者可能正停留在该节点上, 交给回收器延迟释放
+		if (rbt->concurrent) {
+			os_epoch_retire(rbt->epoch, node);
+			os_epoch_reclaim(rbt->epoch);
+		} else {
+			os_mempool_free(rbt->pool, node);
+		}
+	}
+	os_rbt_unlock(rbt);
+
+	return NULL != node;
+}
+
+os_rbt_node_t * os_rbt_find(const os_rbt_t * rbt, const void * data)
+{
+	if (NULL == rbt || NULL == data)
+		return NULL;
+
+	if (!rbt->concurrent)
+		return os_rbt_search(rbt, data);
+
+	unsigned ticket = os_epoch_enter(rbt->epoch);
+	os_rbt_node_t * node = os_rbt_read_lookup(rbt, data, OS_RBT_LOOKUP_EQUAL);
+	os_epoch_leave(rbt->epoch, ticket);
+
+	return node;
+}
+
+bool os_rbt_find_copy(const os_rbt_t * rbt, const void * data, void * out)
+{
+	if (NULL == rbt || NULL == data || NULL == out)
+		return false;
+
+	unsigned ticket = os_rbt_read_begin(rbt);
+	os_rbt_node_t * node = rbt->concurrent ? os_rbt_read_lookup(rbt, data, OS_RBT_LOOKUP_EQUAL) : os_rbt_search(rbt, data);
+	if (NULL != node)
+		memcpy(out, node->data, rbt->elem_size);
+	os_rbt_read_end(rbt, ticket);
+
+	return NULL != node;
+}
+
+unsigned os_rbt_read_begin(const os_rbt_t * rbt)
+{
+	return NULL != rbt && rbt->concurrent ? os_epoch_enter(rbt->epoch) : 0u;
+}
+
+void os_rbt_read_end(const os_rbt_t * rbt, unsigned ticket)
+{
+	if (NULL != rbt && rbt->concurrent)
+		os_epoch_leave(rbt->epoch, ticket);
+}
+
+os_rbt_node_t * os_rbt_lower_bound(const os_rbt_t * rbt, const void * data)
+{
+	if (NULL == rbt || NULL == data || !rbt->concurrent)
+		return os_rbt_bound(rbt, data, true);
+
+	unsigned ticket = os_epoch_enter(rbt->epoch);
+	os_rbt_node_t * node = os_rbt_read_lookup(rbt, data, OS_RBT_LOOKUP_LOWER);
+	os_epoch_leave(rbt->epoch, ticket);
+
+	return node;
+}
+
+os_rbt_node_t * os_rbt_upper_bound(const os_rbt_t * rbt, const void * data)
+{
+	if (NULL == rbt || NULL == data || !rbt->concurrent)
+		return os_rbt_bound(rbt, data, false);
+
+	unsigned ticket = os_epoch_enter(rbt->epoch);
+	os_rbt_node_t * node = os_rbt_read_lookup(rbt, data, OS_RBT_LOOKUP_UPPER);
+	os_epoch_leave(rbt->epoch, ticket);
+
+	return node;
+}
+
+os_rbt_node_t * os_rbt_first(const os_rbt_t * rbt)
+{
+	if (NULL == rbt || !rbt->concurrent)
+		return rbt ? rbt->first : NULL;
+
+	// 缓存的最小节点可能已被摘除, 并发模式下沿左链查找
+	unsigned ticket = os_epoch_enter(rbt->epoch);
+	os_rbt_node_t * node = os_rbt_read_lookup(rbt, NULL, OS_RBT_LOOKUP_FIRST);
+	os_epoch_leave(rbt->epoch, ticket);
+
+	return node;
+}
+
+os_rbt_node_t * os_rbt_last(const os_rbt_t * rbt)
+{
+	if (NULL == rbt || !rbt->concurrent)
+		return rbt ? rbt->last : NULL;
+
+	unsigned ticket = os_epoch_enter(rbt->epoch);
+	os_rbt_node_t * node = os_rbt_read_lookup(rbt, NULL, OS_RBT_LOOKUP_LAST);
+	os_epoch_leave(rbt->epoch, ticket);
+
+	return node;
+}
+
+os_rbt_node_t * os_rbt_next(const os_rbt_node_t * node)
+{
+	if (NULL == node)
+		return NULL;
+
+	if (NULL != node->right)
+		return os_rbt_minimum(node->right);
+
+	os_rbt_node_t * parent = os_rbt_parent(node);
+	while (NULL != parent && node == parent->right) {
+		node = parent;
+		parent = os_rbt_parent(parent);
+	}
+
+	return parent;
+}
+
+os_rbt_node_t * os_rbt_prev(const os_rbt_node_t * node)
+{
+	if (NULL == node)
+		return NULL;
+
+	if (NULL != node->left)
+		return os_rbt_maximum(node->left);
+
+	os_rbt_node_t * parent = os_rbt_parent(node);
+	while (NULL != parent && node == parent->left) {
+		node = parent;
+		parent = os_rbt_parent(parent);
+	}
+
+	return parent;
+}
+
+void * os_rbt_data(const os_rbt_node_t * node)
+{
+	return node ? (void *)node->data : NULL;
+}
+
+size_t os_rbt_size(const os_rbt_t * rbt)
+{
+	return rbt ? atomic_load_explicit((atomic_size_t *)&rbt->size, memory_order_relaxed) : 0u;
+}
+
+bool os_rbt_empty(const os_rbt_t * rbt)
+{
+	return 0u == os_rbt_size(rbt);
+}
+
+int os_rbt_foreach(const os_rbt_t * rbt, os_rbt_visitor visitor, void * ctx)
+{
+	return os_rbt_range(rbt, NULL, NULL, visitor, ctx);
+}
+
+int os_rbt_range(const os_rbt_t * rbt, const void * lo, const void * hi, os_rbt_visitor visitor, void * ctx)
+{
+	if (NULL == rbt || NULL == visitor)
+		return 0;
+
+	if (rbt->concurrent)
+		return os_rbt_read_range(rbt, lo, hi, visitor, ctx);
+
+	// 中序遍历借助parent回溯, 不使用递归和额外栈, 逐个求后继的均摊代价为O(1)
+	// 访问当前节点前先预取右孩子, 后继在右子树中时可以提前开始加载
+	int ret = 0;
+	os_rbt_node_t * node = NULL == lo ? rbt->first : os_rbt_bound(rbt, lo, true);
+	while (NULL != node) {
+		OS_STATS_ADD(OS_RBT_STATS(rbt), compares, NULL != hi ? 1 : 0);
+		if (NULL != hi && rbt->cmp(node->data, hi, rbt->elem_size) >= 0)
+			break;
+		OS_PREFETCH(node->right);
+		ret = visitor(node->data, ctx);
+		if (0 != ret)
+			break;
+		node = os_rbt_next(node);
+	}
+
+	return ret;
+}
+
+bool os_rbt_stats(const os_rbt_t * rbt, os_stats_t * stats)
+{
+	if (NULL == stats)
+		return false;
+
+	memset(stats, 0, sizeof(os_stats_t));
+#if defined(OS_ENABLE_STATS)
+	if (NULL == rbt)
+		return false;
+
+	os_rbt_lock(rbt);
+	os_stats_load(stats, &rbt->stats);
+	os_rbt_unlock(rbt);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool os_rbt_save(const os_rbt_t * rbt, const char * path)
+{
+	if (NULL == rbt || NULL == path)
+		return false;
+
+	// 不能原地重写: 截断会使映射旧文件的快照访问越界
+	char * tmp_path = NULL;
+	FILE * fp = os_mapfile_create(path, &tmp_path);
+	if (NULL == fp)
+		return false;
+
+	// 并发模式下写入期间持有写锁, 保存的是一致的快照
+	os_rbt_lock(rbt);
+	char head[OS_RBT_SNAPSHOT_DATA_OFFSET];
+	os_rbt_snapshot_header_t header;
+	memset(head, 0, sizeof(head));
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, OS_RBT_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = OS_RBT_SNAPSHOT_VERSION;
+	header.byte_order = OS_RBT_SNAPSHOT_BYTE_ORDER;
+	header.elem_size = (uint64_t)rbt->elem_size;
+	header.count = (uint64_t)atomic_load_explicit((atomic_size_t *)&rbt->size, memory_order_relaxed);
+	header.data_offset = OS_RBT_SNAPSHOT_DATA_OFFSET;
+	memcpy(head, &header, sizeof(header));
+
+	bool ok = 1u == fwrite(head, sizeof(head), 1u, fp);
+	for (os_rbt_node_t * node = rbt->first; ok && NULL != node; node = os_rbt_next(node))
+		ok = 1u == fwrite(node->data, rbt->elem_size, 1u, fp);
+	os_rbt_unlock(rbt);
+
+	return os_mapfile_commit(fp, tmp_path, path, ok);
+}
+
+os_rbt_view_t * os_rbt_map(const char * path, size_t elem_size, os_rbt_compare cmp)
+{
+	if (NULL == path || 0u == elem_size || NULL == cmp)
+		return NULL;
+
+	os_mapfile_t * map = os_mapfile_open(path);
+	if (NULL == map)
+		return NULL;
+
+	// 只检查文件头和长度, 耗时与元素个数无关
+	os_rbt_snapshot_header_t header;
+	const char * base = (const char *)os_mapfile_data(map);
+	size_t size = os_mapfile_size(map);
+	if (size < sizeof(header)) {
+		os_mapfile_close(&map);
+		return NULL;
+	}
+	memcpy(&header, base, sizeof(header));
+	if (0 != memcmp(header.magic, OS_RBT_SNAPSHOT_MAGIC, sizeof(header.magic))
+		|| OS_RBT_SNAPSHOT_VERSION != header.version
+		|| OS_RBT_SNAPSHOT_BYTE_ORDER != header.byte_order
+		|| elem_size != header.elem_size
+		|| OS_RBT_SNAPSHOT_DATA_OFFSET != header.data_offset
+		|| header.data_offset > size
+		|| header.count > (size - header.data_offset) / elem_size) {
+		os_mapfile_close(&map);
+		return NULL;
+	}
+
+	os_rbt_view_t * view = (os_rbt_view_t *)calloc(1, sizeof(os_rbt_view_t));
+	if (NULL == view) {
+		os_mapfile_close(&map);
+		return NULL;
+	}
+
+	view->map = map;
+	view->elems = base + header.data_offset;
+	view->elem_size = elem_size;
+	view->count = (size_t)header.count;
+	view->cmp = cmp;
+
+	return view;
+}
+
+void os_rbt_unmap(os_rbt_view_t ** view)
+{
+	if (NULL == view || NULL == *view)
+		return;
+
+	os_mapfile_close(&(*view)->map);
+	free(*view);
+	*view = NULL;
+}
+
+const void * os_rbt_view_find(const os_rbt_view_t * view, const void * data)
+{
+	if (NULL == view || NULL == data)
+		return NULL;
+
+	size_t index = os_rbt_view_bound(view, data, true);
+	if (index == view->count)
+		return NULL;
+
+	const void * elem = view->elems + index * view->elem_size;
+	return 0 == view->cmp(elem, data, view->elem_size) ? elem : NULL;
+}
+
+const void * os_rbt_view_lower_bound(const os_rbt_view_t * view, const void * data)
+{
+	if (NULL == view || NULL == data)
+		return NULL;
+
+	return os_rbt_view_at(view, os_rbt_view_bound(view, data, true));
+}
+
+const void * os_rbt_view_upper_bound(const os_rbt_view_t * view, const void * data)
+{
+	if (NULL == view || NULL == data)
+		return NULL;
+
+	return os_rbt_view_at(view, os_rbt_view_bound(view, data, false));
+}
+
+const void * os_rbt_view_at(const os_rbt_view_t * view, size_t index)
+{
+	if (NULL == view || index >= view->count)
+		return NULL;
+
+	return view->elems + index * view->elem_size;
+}
+
+size_t os_rbt_view_size(const os_rbt_view_t * view)
+{
+	return view ? view->count : 0u;
+}
+
+int os_rbt_view_range(const os_rbt_view_t * view, const void * lo, const void * hi, os_rbt_visitor visitor, void * ctx)
+{
+	if (NULL == view || NULL == visitor)
+		return 0;
+
+	int ret = 0;
+	size_t index = NULL == lo ? 0u : os_rbt_view_bound(view, lo, true);
+	size_t end = NULL == hi ? view->count : os_rbt_view_bound(view, hi, true);
+	for (const char * elem = view->elems + index * view->elem_size; index < end; ++index, elem += view->elem_size) {
+		ret = visitor(elem, ctx);
+		if (0 != ret)
+			break;
+	}
+
+	return ret;
+}
+
+os_rbt_node_t * os_rbt_parent(const os_rbt_node_t * node)
+{
+	return (os_rbt_node_t *)(node->parent_color & ~(uintptr_t)1u);
+}
+
+OS_RBT_COLOR_TYPE os_rbt_color(const os_rbt_node_t * node)
+{
+	return (OS_RBT_COLOR_TYPE)(node->parent_color & 1u);
+}
+
+bool os_rbt_is_red(const os_rbt_node_t * node)
+{
+	return NULL != node && OS_RBT_COLOR_RED == os_rbt_color(node);
+}
+
+void os_rbt_set_parent(os_rbt_node_t * node, os_rbt_node_t * parent)
+{
+	node->parent_color = (uintptr_t)parent | (node->parent_color & 1u);
+}
+
+void os_rbt_set_color(os_rbt_node_t * node, OS_RBT_COLOR_TYPE color)
+{
+	node->parent_color = (node->parent_color & ~(uintptr_t)1u) | (uintptr_t)color;
+}
+
+os_rbt_node_t * os_rbt_new_node(const os_rbt_t * rbt, void * data)
+{
+	os_rbt_node_t * node = (os_rbt_node_t *)os_mempool_alloc(rbt->pool);
+	if (NULL == node)
+		return NULL;
+	OS_STATS_ALLOC(OS_RBT_STATS(rbt), 1, rbt->node_size);
+
+	memcpy(node->data, data, rbt->elem_size);
+	node->parent_color = (uintptr_t)OS_RBT_COLOR_RED;
+	node->left = NULL;
+	node->right = NULL;
+
+	return node;
+}
+
+bool os_rbt_insert_node(os_rbt_t * rbt, void * data)
+{
+	int ret = 0;
+	bool leftmost = true;   // 一直向左走, 新节点为最小节点
+	bool rightmost = true;  // 一直向右走, 新节点为最大节点
+	os_rbt_node_t * tmp = NULL;
 	os_rbt_node_t * root = rbt->root;
-	while (rbt->nil != root) {
+	while (NULL != root) {
 		tmp = root;
-		int ret = rbt->cmp(root->data, data, rbt->elem_size);
-		if (ret < 0)
+		OS_STATS_ADD(rbt->stats, compares, 1);
+		ret = rbt->cmp(root->data, data, rbt->elem_size);
+		if (ret < 0) {
 			root = root->right;
-		else if (ret > 0)
+			leftmost = false;
+		} else if (ret > 0) {
 			root = root->left;
-		else
+			rightmost = false;
+		} else {
 			return true;
+		}
 	}
 
 	os_rbt_node_t * node = os_rbt_new_node(rbt, data);
 	if (NULL == node)
 		return false;
 
-	node->parent = tmp;
-	int ret = rbt->cmp(tmp->data, data, rbt->elem_size);
-	if (rbt->nil == tmp)
-		rbt->root = node;
+	os_rbt_modify_begin(rbt);
+	os_rbt_set_parent(node, tmp);
+	if (NULL == tmp)
+		OS_RBT_STORE(rbt->root, node);
 	else if (ret < 0)
-		tmp->right = node;
+		OS_RBT_STORE(tmp->right, node);
 	else
-		tmp->left = node;
+		OS_RBT_STORE(tmp->left, node);
+
+	if (leftmost)
+		rbt->first = node;
+	if (rightmost)
+		rbt->last = node;
 
 	os_rbt_insert_fixup(rbt, node);
 
-	++rbt->size;
+	size_t size = atomic_load_explicit(&rbt->size, memory_order_relaxed) + 1u;
+	atomic_store_explicit(&rbt->size, size, memory_order_relaxed);
+	os_rbt_modify_end(rbt);
+	OS_STATS_SIZE(rbt->stats, size);
 
 	return true;
 }
 
-bool os_rbt_erase(os_rbt_t * rbt, const void * data)
+void os_rbt_build(os_rbt_t * rbt, const char * elems, size_t count)
 {
-	return true;
+	// 每个区间取中点为根, 左右子树大小至多差1, 空链接只出现在最后两层;
+	// 树不满时最深一层染红, 其余染黑, 每条路径的黑节点个数相同
+	size_t height = 0u;
+	while (height < OS_RBT_MAX_DEPTH - 1 && ((size_t)2u << height) - 1u < count)
+		++height;
+	bool full = ((size_t)2u << height) - 1u == count;
+
+	// 先在局部构建, 节点全部初始化后再一次接入树中
+	os_rbt_node_t * root = NULL;
+	os_rbt_build_frame_t stack[OS_RBT_MAX_DEPTH + 1];
+	int top = 0;
+	stack[top++] = (os_rbt_build_frame_t){ 0u, count, 0u, NULL, &root };
+	while (top > 0) {
+		os_rbt_build_frame_t frame = stack[--top];
+		size_t mid = frame.lo + (frame.hi - frame.lo) / 2u;
+		os_rbt_node_t * node = (os_rbt_node_t *)os_mempool_alloc(rbt->pool);
+		memcpy(node->data, elems + mid * rbt->elem_size, rbt->elem_size);
+		node->parent_color = (uintptr_t)frame.parent;
+		os_rbt_set_color(node, !full && frame.depth == height ? OS_RBT_COLOR_RED : OS_RBT_COLOR_BLACK);
+		node->left = NULL;
+		node->right = NULL;
+		*frame.slot = node;
+
+		// 先序分配, 靠近根的节点在内存中相邻
+		if (mid + 1u < frame.hi)
+			stack[top++] = (os_rbt_build_frame_t){ mid + 1u, frame.hi, frame.depth + 1u, node, &node->right };
+		if (frame.lo < mid)
+			stack[top++] = (os_rbt_build_frame_t){ frame.lo, mid, frame.depth + 1u, node, &node->left };
+	}
+
+	OS_RBT_STORE(rbt->root, root);
+	rbt->first = os_rbt_minimum(root);
+	rbt->last = os_rbt_maximum(root);
+	atomic_store_explicit(&rbt->size, count, memory_order_relaxed);
+	OS_STATS_ALLOC(rbt->stats, count, count * rbt->node_size);
+	OS_STATS_SIZE(rbt->stats, count);
 }
 
-os_rbt_node_t * os_rbt_find(const os_rbt_t * rbt, const void * data)
+void os_rbt_unlink(os_rbt_t * rbt, os_rbt_node_t * node)
 {
-	if (NULL == rbt || NULL == data)
-		return NULL;
+	// 最小和最大节点至多有一个孩子, 不会被后继节点顶替, 删除前先更新缓存
+	if (rbt->first == node)
+		rbt->first = os_rbt_next(node);
+	if (rbt->last == node)
+		rbt->last = os_rbt_prev(node);
+
+	os_rbt_node_t * child = NULL;
+	os_rbt_node_t * parent = NULL;
+	OS_RBT_COLOR_TYPE color = os_rbt_color(node);
+	if (NULL == node->left) {
+		child = node->right;
+		parent = os_rbt_parent(node);
+		os_rbt_transplant(rbt, node, node->right);
+	} else if (NULL == node->right) {
+		child = node->left;
+		parent = os_rbt_parent(node);
+		os_rbt_transplant(rbt, node, node->left);
+	} else {
+		// 两个孩子时由后继节点顶替
+		os_rbt_node_t * succ = os_rbt_minimum(node->right);
+		color = os_rbt_color(succ);
+		child = succ->right;
+		if (os_rbt_parent(succ) == node) {
+			parent = succ;
+		} else {
+			parent = os_rbt_parent(succ);
+			os_rbt_transplant(rbt, succ, succ->right);
+			OS_RBT_STORE(succ->right, node->right);
+			os_rbt_set_parent(succ->right, succ);
+		}
+		os_rbt_transplant(rbt, node, succ);
+		OS_RBT_STORE(succ->left, node->left);
+		os_rbt_set_parent(succ->left, succ);
+		os_rbt_set_color(succ, os_rbt_color(node));
+	}
 
+	if (OS_RBT_COLOR_BLACK == color)
+		os_rbt_erase_fixup(rbt, child, parent);
+
+	atomic_store_explicit(&rbt->size, atomic_load_explicit(&rbt->size, memory_order_relaxed) - 1u, memory_order_relaxed);
+}
+
+os_rbt_node_t * os_rbt_search(const os_rbt_t * rbt, const void * data)
+{
 	os_rbt_node_t * node = rbt->root;
-	while (rbt->nil != node) {
+	OS_STATS_ADD(OS_RBT_STATS(rbt), searches, 1);
+	while (NULL != node) {
+		OS_STATS_ADD(OS_RBT_STATS(rbt), search_depth, 1);
+		OS_STATS_ADD(OS_RBT_STATS(rbt), compares, 1);
 		int ret = rbt->cmp(node->data, data, rbt->elem_size);
 		if (ret < 0)
 			node = node->right;
@@ -136,78 +852,370 @@ os_rbt_node_t * os_rbt_find(const os_rbt_t * rbt, const void * data)
 	return NULL;
 }
 
-void * os_rbt_data(const os_rbt_node_t * node)
+os_rbt_node_t * os_rbt_read_lookup(const os_rbt_t * rbt, const void * data, OS_RBT_LOOKUP_TYPE type)
 {
-	return node ? (void *)node->data : NULL;
+	for (;;) {
+		unsigned seq = atomic_load_explicit((atomic_uint *)&rbt->seq, memory_order_acquire);
+		if (seq & 1u) {
+			os_rbt_yield();
+			continue;
+		}
+
+		// 旋转过程中可能短暂出现环, 步数超过树高上限说明有写者介入, 序号校验必然失败
+		os_rbt_node_t * found = NULL;
+		os_rbt_node_t * node = OS_RBT_LOAD(rbt->root);
+		for (int steps = 0; NULL != node && steps < 2 * OS_RBT_MAX_DEPTH; ++steps) {
+			int ret = OS_RBT_LOOKUP_FIRST == type ? 1 : (OS_RBT_LOOKUP_LAST == type ? -1 : rbt->cmp(node->data, data, rbt->elem_size));
+			if (OS_RBT_LOOKUP_EQUAL == type && 0 == ret) {
+				found = node;
+				break;
+			}
+			if (ret > 0 || (OS_RBT_LOOKUP_LOWER == type && 0 == ret)) {
+				if (OS_RBT_LOOKUP_EQUAL != type)
+					found = node;
+				node = OS_RBT_LOAD(node->left);
+			} else {
+				if (OS_RBT_LOOKUP_LAST == type)
+					found = node;
+				node = OS_RBT_LOAD(node->right);
+			}
+		}
+
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit((atomic_uint *)&rbt->seq, memory_order_relaxed) == seq)
+			return found;
+	}
 }
 
-size_t os_rbt_size(const os_rbt_t * rbt)
+int os_rbt_read_range(const os_rbt_t * rbt, const void * lo, const void * hi, os_rbt_visitor visitor, void * ctx)
 {
-	return rbt ? rbt->size : 0u;
+	// 元素拷出后离开读区间再调用visitor: visitor可以修改树, 也不会拖住回收;
+	// 每一步重新查找后继, 访问k个元素耗时O(k log n), 访问到的每个元素在被查找到时都在树中
+	char * elem = (char *)malloc(rbt->elem_size);
+	if (NULL == elem)
+		return 0;
+
+	int ret = 0;
+	const void * key = lo;
+	OS_RBT_LOOKUP_TYPE type = NULL == lo ? OS_RBT_LOOKUP_FIRST : OS_RBT_LOOKUP_LOWER;
+	for (;;) {
+		unsigned ticket = os_epoch_enter(rbt->epoch);
+		os_rbt_node_t * node = os_rbt_read_lookup(rbt, key, type);
+		if (NULL != node)
+			memcpy(elem, node->data, rbt->elem_size);
+		os_epoch_leave(rbt->epoch, ticket);
+
+		if (NULL == node || (NULL != hi && rbt->cmp(elem, hi, rbt->elem_size) >= 0))
+			break;
+		ret = visitor(elem, ctx);
+		if (0 != ret)
+			break;
+		key = elem;
+		type = OS_RBT_LOOKUP_UPPER;
+	}
+	free(elem);
+
+	return ret;
 }
 
-bool os_rbt_empty(const os_rbt_t * rbt)
+void os_rbt_reclaim_node(void * node, void * ctx)
 {
-	return rbt ? 0 == rbt->size : true;
+	os_mempool_free((os_mempool_t *)ctx, node);
 }
 
-os_rbt_node_t * os_rbt_new_node(const os_rbt_t * rbt, void * data)
+void os_rbt_modify_begin(os_rbt_t * rbt)
 {
-	os_rbt_node_t * node = (os_rbt_node_t *)malloc(rbt->node_size);
-	if (NULL == node)
-		return NULL;
+	if (rbt->concurrent) {
+		unsigned seq = atomic_load_explicit(&rbt->seq, memory_order_relaxed);
+		atomic_store_explicit(&rbt->seq, seq + 1u, memory_order_relaxed);
+		atomic_thread_fence(memory_order_release);
+	}
+}
 
-	memcpy(node->data, data, rbt->elem_size);
-	node->color = OS_RBT_COLOR_RED;
-	node->parent = rbt->nil;
-	node->left = rbt->nil;
-	node->right = rbt->nil;
+void os_rbt_modify_end(os_rbt_t * rbt)
+{
+	if (rbt->concurrent)
+		atomic_store_explicit(&rbt->seq, atomic_load_explicit(&rbt->seq, memory_order_relaxed) + 1u, memory_order_release);
+}
 
-	return node;
+#if defined(WIN32) || defined(_WIN32)
+
+bool os_rbt_sync_init(os_rbt_t * rbt)
+{
+	InitializeCriticalSection(&rbt->lock);
+	return true;
+}
+
+void os_rbt_sync_destroy(os_rbt_t * rbt)
+{
+	DeleteCriticalSection(&rbt->lock);
+}
+
+void os_rbt_lock(const os_rbt_t * rbt)
+{
+	if (rbt->concurrent)
+		EnterCriticalSection((os_rbt_mutex_t *)&rbt->lock);
+}
+
+void os_rbt_unlock(const os_rbt_t * rbt)
+{
+	if (rbt->concurrent)
+		LeaveCriticalSection((os_rbt_mutex_t *)&rbt->lock);
+}
+
+void os_rbt_yield(void)
+{
+	SwitchToThread();
+}
+
+#else
+
+bool os_rbt_sync_init(os_rbt_t * rbt)
+{
+	return 0 == pthread_mutex_init(&rbt->lock, NULL);
 }
 
+void os_rbt_sync_destroy(os_rbt_t * rbt)
+{
+	pthread_mutex_destroy(&rbt->lock);
+}
+
+void os_rbt_lock(const os_rbt_t * rbt)
+{
+	if (rbt->concurrent)
+		pthread_mutex_lock((os_rbt_mutex_t *)&rbt->lock);
+}
+
+void os_rbt_unlock(const os_rbt_t * rbt)
+{
+	if (rbt->concurrent)
+		pthread_mutex_unlock((os_rbt_mutex_t *)&rbt->lock);
+}
+
+void os_rbt_yield(void)
+{
+	sched_yield();
+}
+
+#endif
+
 void os_rbt_left_rotate(os_rbt_t * rbt, os_rbt_node_t * node)
 {
 	os_rbt_node_t * right = node->right;
-	node->right = right->left;
+	os_rbt_node_t * parent = os_rbt_parent(node);
+	OS_RBT_STORE(node->right, right->left);
+
+	if (NULL != right->left)
+		os_rbt_set_parent(right->left, node);
 
-	if (right->left != rbt->nil)
-		right->left->parent = node;
-	
-	right->parent = node->parent;
+	os_rbt_set_parent(right, parent);
 
-	if (node->parent == rbt->nil) // 无父节点
-		rbt->root = right;
-	else if (node == node->parent->left) // 父节点左孩子
-		node->parent->left = right;
+	if (NULL == parent) // 无父节点
+		OS_RBT_STORE(rbt->root, right);
+	else if (node == parent->left) // 父节点左孩子
+		OS_RBT_STORE(parent->left, right);
 	else
-		node->parent->right = right;  // 父节点右孩子
+		OS_RBT_STORE(parent->right, right);  // 父节点右孩子
 
-	right->left = node;
-	node->parent = right;
+	OS_RBT_STORE(right->left, node);
+	os_rbt_set_parent(node, right);
 }
 
 void os_rbt_right_rotate(os_rbt_t * rbt, os_rbt_node_t * node)
 {
 	os_rbt_node_t * left = node->left;
-	node->left = left->right;
+	os_rbt_node_t * parent = os_rbt_parent(node);
+	OS_RBT_STORE(node->left, left->right);
 
-	if (left->right != rbt->nil)
-		left->right->parent = node;
+	if (NULL != left->right)
+		os_rbt_set_parent(left->right, node);
 
-	left->parent = node->parent;
+	os_rbt_set_parent(left, parent);
 	// 无父节点
-	if (node->parent == rbt->nil)
-		rbt->root = left;
-	else if (node == node->parent->left)
-		node->parent->left = left;
+	if (NULL == parent)
+		OS_RBT_STORE(rbt->root, left);
+	else if (node == parent->left)
+		OS_RBT_STORE(parent->left, left);
 	else
-		node->parent->right = left;
+		OS_RBT_STORE(parent->right, left);
 
-	left->right = node;
-	node->parent = left;
+	OS_RBT_STORE(left->right, node);
+	os_rbt_set_parent(node, left);
 }
 
 void os_rbt_insert_fixup(os_rbt_t * rbt, os_rbt_node_t * node)
 {
+	os_rbt_node_t * parent = NULL;
+	// 父节点为红时必然不是根, 祖父节点一定存在
+	while (os_rbt_is_red(parent = os_rbt_parent(node))) {
+		os_rbt_node_t * grand = os_rbt_parent(parent);
+		if (parent == grand->left) {
+			os_rbt_node_t * uncle = grand->right;
+			if (os_rbt_is_red(uncle)) { // 叔叔为红: 变色后上移
+				os_rbt_set_color(parent, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(uncle, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(grand, OS_RBT_COLOR_RED);
+				node = grand;
+				continue;
+			}
+			if (node == parent->right) { // 转为外侧
+				node = parent;
+				os_rbt_left_rotate(rbt, node);
+				parent = os_rbt_parent(node);
+			}
+			os_rbt_set_color(parent, OS_RBT_COLOR_BLACK);
+			os_rbt_set_color(grand, OS_RBT_COLOR_RED);
+			os_rbt_right_rotate(rbt, grand);
+		} else {
+			os_rbt_node_t * uncle = grand->left;
+			if (os_rbt_is_red(uncle)) {
+				os_rbt_set_color(parent, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(uncle, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(grand, OS_RBT_COLOR_RED);
+				node = grand;
+				continue;
+			}
+			if (node == parent->left) {
+				node = parent;
+				os_rbt_right_rotate(rbt, node);
+				parent = os_rbt_parent(node);
+			}
+			os_rbt_set_color(parent, OS_RBT_COLOR_BLACK);
+			os_rbt_set_color(grand, OS_RBT_COLOR_RED);
+			os_rbt_left_rotate(rbt, grand);
+		}
+	}
+
+	os_rbt_set_color(rbt->root, OS_RBT_COLOR_BLACK);
+}
+
+void os_rbt_transplant(os_rbt_t * rbt, os_rbt_node_t * u, os_rbt_node_t * v)
+{
+	os_rbt_node_t * parent = os_rbt_parent(u);
+	if (NULL == parent)
+		OS_RBT_STORE(rbt->root, v);
+	else if (u == parent->left)
+		OS_RBT_STORE(parent->left, v);
+	else
+		OS_RBT_STORE(parent->right, v);
+
+	if (NULL != v)
+		os_rbt_set_parent(v, parent);
+}
+
+void os_rbt_erase_fixup(os_rbt_t * rbt, os_rbt_node_t * node, os_rbt_node_t * parent)
+{
+	// node比兄弟子树少一个黑节点, 兄弟一定存在
+	while (node != rbt->root && !os_rbt_is_red(node)) {
+		if (node == parent->left) {
+			os_rbt_node_t * sibling = parent->right;
+			if (os_rbt_is_red(sibling)) { // 兄弟为红: 转为兄弟为黑
+				os_rbt_set_color(sibling, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(parent, OS_RBT_COLOR_RED);
+				os_rbt_left_rotate(rbt, parent);
+				sibling = parent->right;
+			}
+			if (!os_rbt_is_red(sibling->left) && !os_rbt_is_red(sibling->right)) {
+				os_rbt_set_color(sibling, OS_RBT_COLOR_RED);
+				node = parent;
+				parent = os_rbt_parent(node);
+				continue;
+			}
+			if (!os_rbt_is_red(sibling->right)) { // 兄弟的红孩子转到外侧
+				os_rbt_set_color(sibling->left, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(sibling, OS_RBT_COLOR_RED);
+				os_rbt_right_rotate(rbt, sibling);
+				sibling = parent->right;
+			}
+			os_rbt_set_color(sibling, os_rbt_color(parent));
+			os_rbt_set_color(parent, OS_RBT_COLOR_BLACK);
+			os_rbt_set_color(sibling->right, OS_RBT_COLOR_BLACK);
+			os_rbt_left_rotate(rbt, parent);
+			node = rbt->root;
+		} else {
+			os_rbt_node_t * sibling = parent->left;
+			if (os_rbt_is_red(sibling)) {
+				os_rbt_set_color(sibling, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(parent, OS_RBT_COLOR_RED);
+				os_rbt_right_rotate(rbt, parent);
+				sibling = parent->left;
+			}
+			if (!os_rbt_is_red(sibling->left) && !os_rbt_is_red(sibling->right)) {
+				os_rbt_set_color(sibling, OS_RBT_COLOR_RED);
+				node = parent;
+				parent = os_rbt_parent(node);
+				continue;
+			}
+			if (!os_rbt_is_red(sibling->left)) {
+				os_rbt_set_color(sibling->right, OS_RBT_COLOR_BLACK);
+				os_rbt_set_color(sibling, OS_RBT_COLOR_RED);
+				os_rbt_left_rotate(rbt, sibling);
+				sibling = parent->left;
+			}
+			os_rbt_set_color(sibling, os_rbt_color(parent));
+			os_rbt_set_color(parent, OS_RBT_COLOR_BLACK);
+			os_rbt_set_color(sibling->left, OS_RBT_COLOR_BLACK);
+			os_rbt_right_rotate(rbt, parent);
+			node = rbt->root;
+		}
+	}
+
+	if (NULL != node)
+		os_rbt_set_color(node, OS_RBT_COLOR_BLACK);
+}
+
+os_rbt_node_t * os_rbt_minimum(os_rbt_node_t * node)
+{
+	while (NULL != node->left)
+		node = node->left;
+
+	return node;
+}
+
+os_rbt_node_t * os_rbt_maximum(os_rbt_node_t * node)
+{
+	while (NULL != node->right)
+		node = node->right;
+
+	return node;
+}
+
+os_rbt_node_t * os_rbt_bound(const os_rbt_t * rbt, const void * data, bool inclusive)
+{
+	if (NULL == rbt || NULL == data)
+		return NULL;
+
+	// 满足条件时记为候选并向左继续找更小的, 否则向右
+	os_rbt_node_t * bound = NULL;
+	os_rbt_node_t * node = rbt->root;
+	OS_STATS_ADD(OS_RBT_STATS(rbt), searches, 1);
+	while (NULL != node) {
+		OS_STATS_ADD(OS_RBT_STATS(rbt), search_depth, 1);
+		OS_STATS_ADD(OS_RBT_STATS(rbt), compares, 1);
+		int ret = rbt->cmp(node->data, data, rbt->elem_size);
+		if (ret > 0 || (inclusive && 0 == ret)) {
+			bound = node;
+			node = node->left;
+		} else {
+			node = node->right;
+		}
+	}
+
+	return bound;
+}
+
+size_t os_rbt_view_bound(const os_rbt_view_t * view, const void * data, bool inclusive)
+{
+	size_t lo = 0u;
+	size_t hi = view->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2u;
+		int ret = view->cmp(view->elems + mid * view->elem_size, data, view->elem_size);
+		if (ret < 0 || (!inclusive && 0 == ret))
+			lo = mid + 1u;
+		else
+			hi = mid;
+	}
+
+	return lo;
 }